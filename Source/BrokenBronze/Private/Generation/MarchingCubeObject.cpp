@@ -3,8 +3,15 @@
 
 #include "MarchingCubeObject.h"
 
+#include "VoxelStats.h"
 #include "NavigationSystem.h"
-#include "Serialization/BufferArchive.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "StaticMeshResources.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
 
 // Sets default values
 AMarchingCubeObject::AMarchingCubeObject()
@@ -28,136 +35,295 @@ void AMarchingCubeObject::PostInitializeComponents()
 
 void AMarchingCubeObject::MakeHole(const FVector& Center, float Radius)
 {
-	for (int X = 0; X <= SizeX; ++X)
+	MakeHoleFromInput(Center, Radius, FPlatformTime::Seconds());
+}
+
+void AMarchingCubeObject::MakeHoleFromInput(const FVector& Center, float Radius, double InputTime)
+{
+	// Radius is already in voxels, MakeHole compares against Radius * VoxelSize in world units
+	FVoxelBrush Brush = FVoxelBrush::MakeSphere(FVector3f(WorldToVoxel(Center)), Radius);
+	Brush.DistanceScale = VoxelSize;
+	Brush.HoleValue = -VoxelSize * 2;
+	QueueEdit(Brush, InputTime);
+}
+
+void AMarchingCubeObject::ApplyBrush(const FVoxelBrush& WorldBrush, double InputTime)
+{
+	FVoxelBrush Brush = WorldBrush;
+	Brush.Start = FVector3f(WorldToVoxel(FVector(WorldBrush.Start)));
+	Brush.End = FVector3f(WorldToVoxel(FVector(WorldBrush.End)));
+	Brush.Radius = WorldBrush.Radius / VoxelSize;
+	Brush.Extent = WorldBrush.Extent / VoxelSize;
+	Brush.Smoothing = WorldBrush.Smoothing / VoxelSize;
+	Brush.Rotation = FQuat4f(GetActorQuat().Inverse()) * WorldBrush.Rotation;
+	Brush.DistanceScale = VoxelSize;
+	Brush.HoleValue = -VoxelSize * 2;
+	QueueEdit(Brush, InputTime);
+}
+
+void AMarchingCubeObject::CarveCapsule(const FVector& Start, const FVector& End, float Radius, float Smoothing)
+{
+	FVoxelBrush Brush = FVoxelBrush::MakeCapsule(FVector3f(Start), FVector3f(End), Radius);
+	Brush.Operation = EVoxelBrushOp::Subtract;
+	Brush.Smoothing = Smoothing;
+	ApplyBrush(Brush, FPlatformTime::Seconds());
+}
+
+void AMarchingCubeObject::CarveBox(const FVector& Center, const FVector& Extent, const FRotator& Rotation, float Smoothing)
+{
+	FVoxelBrush Brush = FVoxelBrush::MakeBox(FVector3f(Center), FVector3f(Extent), FQuat4f(Rotation.Quaternion()));
+	Brush.Operation = EVoxelBrushOp::Subtract;
+	Brush.Smoothing = Smoothing;
+	ApplyBrush(Brush, FPlatformTime::Seconds());
+}
+
+void AMarchingCubeObject::CarveCone(const FVector& Base, const FVector& Tip, float Radius, float Smoothing)
+{
+	FVoxelBrush Brush = FVoxelBrush::MakeCone(FVector3f(Base), FVector3f(Tip), Radius);
+	Brush.Operation = EVoxelBrushOp::Subtract;
+	Brush.Smoothing = Smoothing;
+	ApplyBrush(Brush, FPlatformTime::Seconds());
+}
+
+void AMarchingCubeObject::AddSphere(const FVector& Center, float Radius, float Smoothing)
+{
+	FVoxelBrush Brush = FVoxelBrush::MakeSphere(FVector3f(Center), Radius);
+	Brush.Operation = EVoxelBrushOp::Union;
+	Brush.Smoothing = Smoothing;
+	ApplyBrush(Brush, FPlatformTime::Seconds());
+}
+
+void AMarchingCubeObject::AddBox(const FVector& Center, const FVector& Extent, const FRotator& Rotation, float Smoothing)
+{
+	FVoxelBrush Brush = FVoxelBrush::MakeBox(FVector3f(Center), FVector3f(Extent), FQuat4f(Rotation.Quaternion()));
+	Brush.Operation = EVoxelBrushOp::Union;
+	Brush.Smoothing = Smoothing;
+	ApplyBrush(Brush, FPlatformTime::Seconds());
+}
+
+void AMarchingCubeObject::QueueEdit(const FVoxelBrush& Brush, double InputTime)
+{
+	const FVoxelQueuedEdit Edit{ Brush, InputTime };
+	// The voxels aren't there until the background load finishes, it flushes what piled up meanwhile
+	if (bQueueEdits || LoadTask.IsValid())
 	{
-		for (int Y = 0; Y <= SizeY; ++Y)
+		QueuedEdits.Add(Edit);
+		return;
+	}
+	ApplyEdits(MakeArrayView(&Edit, 1));
+}
+
+void AMarchingCubeObject::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld())
+	{
+		FlushEdits();
+	}
+}
+
+void AMarchingCubeObject::FlushEdits()
+{
+	if (LoadTask.IsValid())
+	{
+		LastFrameEdits = 0;
+		EditQueueDepth = QueuedEdits.Num();
+		return;
+	}
+
+	const int32 NumEdits = MaxEditsPerFrame > 0 ? FMath::Min(MaxEditsPerFrame, QueuedEdits.Num()) : QueuedEdits.Num();
+	LastFrameEdits = NumEdits;
+	if (NumEdits == 0)
+	{
+		EditQueueDepth = 0;
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::FlushEdits);
+	MaxEditQueueDepth = FMath::Max(MaxEditQueueDepth, QueuedEdits.Num());
+	ApplyEdits(MakeArrayView(QueuedEdits.GetData(), NumEdits));
+	QueuedEdits.RemoveAt(0, NumEdits, EAllowShrinking::No);
+	EditQueueDepth = QueuedEdits.Num();
+
+	INC_DWORD_STAT_BY(STAT_VoxelEditsApplied, NumEdits);
+	INC_DWORD_STAT_BY(STAT_VoxelEditQueueDepth, EditQueueDepth);
+	UE_LOG(LogVoxel, VeryVerbose, TEXT("%s: carved %d queued edits, %d left"), *GetName(), NumEdits, EditQueueDepth);
+}
+
+void AMarchingCubeObject::ApplyEdits(TConstArrayView<FVoxelQueuedEdit> Edits)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::MakeHole);
+	// Input times of the edits that changed something
+	TArray<double, TInlineAllocator<16>> InputTimes;
+	for (const FVoxelQueuedEdit& Edit : Edits)
+	{
+		const FVoxelRegion Edited = Voxels.ApplyBrush(Edit.Brush, &VoxelsHitStatus);
+
+		//Nothing the brush reached, the mesh is unchanged
+		if (Edited.IsEmpty())
 		{
-			for (int Z = 0; Z <= SizeZ; ++Z)
-			{
-				//FVector WorldPos = FVector(X, Y, Z) * VoxelSize;
-				//FVector localPos = GetActorTransform().InverseTransformPosition(WorldPos);
-				FVector WorldPos = GetVoxelWorldPosition(X,Y,Z);
-				
-				float dist = FVector::Dist(WorldPos, Center);
-				if (dist < Radius * VoxelSize)
-				{
-					UE_LOG(LogTemp, Display, TEXT("dist: %f"), dist);
-                    int index = GetVoxelIndex(X,Y,Z);
-                    float currentValue = Voxels[index];
-                    Voxels[index] = FMath::Min(currentValue, -VoxelSize * 2);
-					VoxelsHitStatus[index] = true;
-				}
-			}
+			continue;
+		}
+
+		InputTimes.Add(Edit.InputTime);
+		MarkChunksDirty(Edited.Min, Edited.Max);
+		AddEditNavBox(Edited);
+		if (IsPersistingEdits())
+		{
+			RecordEdit(Edit.Brush, Edited);
 		}
 	}
-	
-    Vertices.Reset();
-    Triangles.Reset();
-    Normals.Reset();
-    Colors.Reset();
-    UVs.Reset();
-    VertexCount = 0;
+	if (InputTimes.IsEmpty())
+	{
+		return;
+	}
+
+	if (bAsyncRemesh)
+	{
+		// The navmesh and OnVoxelMeshUpdated follow once the new mesh is applied in Tick.
+		// A coarse LOD on screen goes first, the hidden LOD 0 behind it only feeds collision and navigation.
+		const bool bCoarseInView = CurrentLOD > 0;
+		if (bCoarseInView)
+		{
+			GenerateLODMeshAsync(CurrentLOD, LowLevelTasks::ETaskPriority::Normal);
+		}
+		const uint32 VisibleGeneration = RemeshGeneration;
+		GenerateMeshAsync(bCoarseInView ? LowLevelTasks::ETaskPriority::BackgroundNormal : LowLevelTasks::ETaskPriority::Normal);
+		for (double InputTime : InputTimes)
+		{
+			PendingEditLatency.Emplace(bCoarseInView ? VisibleGeneration : RemeshGeneration, InputTime);
+		}
+		return;
+	}
+
     GenerateMesh();
     ApplyMesh();
+	const double Now = FPlatformTime::Seconds();
+	for (double InputTime : InputTimes)
+	{
+		FVoxelLatencyHistogram::GetEditLatency().Add((Now - InputTime) * 1000.0);
+	}
 
-	UpdateNavmesh();
+	if (!bAsyncCollision)
+	{
+		UpdateNavmesh();
+	}
+	OnVoxelMeshUpdated.Broadcast(this);
+}
+
+FVector AMarchingCubeObject::WorldToVoxel(const FVector& WorldPos) const
+{
+	return GetActorRotation().UnrotateVector(WorldPos - GetActorLocation()) / VoxelSize;
 }
 
-float AMarchingCubeObject::ClosestTriangleDistance(const FVector& P)
+void AMarchingCubeObject::BuildTriangleBVH(const UStaticMesh* StaticMesh)
 {
-	float minDist = FLT_MAX;
-	for (int i = 0; i < OriginalIndices.Num(); i+=3)
+	// Voxelizing the same mesh on several actors only pays for the tree once. A rebuild or reimport replaces the
+	// render data the triangles were read from, so a tree is only reused while that is still the same.
+	struct FSharedTree
 	{
-		const FVector& A = OriginalVertices[OriginalIndices[i]];
-		const FVector& B = OriginalVertices[OriginalIndices[i + 1]];
-		const FVector& C = OriginalVertices[OriginalIndices[i + 2]];
+		const FStaticMeshRenderData* RenderData = nullptr;
+#if WITH_EDITORONLY_DATA
+		FString DerivedDataKey;
+#endif
+		int32 NumVertices = 0;
+		int32 NumIndices = 0;
+		TSharedPtr<const FTriangleBVH> BVH;
+		TSharedPtr<const FMeshPseudoNormals> Normals;
+	};
+	static TMap<TWeakObjectPtr<const UStaticMesh>, FSharedTree> SharedTrees;
 
-		FVector closest = FMath::ClosestPointOnTriangleToPoint(P, A, B, C);
-		float Dist = FVector::Dist(P, closest);
-		minDist = FMath::Min(minDist, Dist);
+	const FStaticMeshRenderData* RenderData = StaticMesh->GetRenderData();
+	if (const FSharedTree* Existing = SharedTrees.Find(StaticMesh))
+	{
+		bool bCurrent = Existing->RenderData == RenderData && Existing->NumVertices == OriginalVertices.Num() && Existing->NumIndices == OriginalIndices.Num();
+#if WITH_EDITORONLY_DATA
+		bCurrent = bCurrent && Existing->DerivedDataKey == RenderData->DerivedDataKey;
+#endif
+		if (bCurrent)
+		{
+			TriangleBVH = Existing->BVH;
+			PseudoNormals = Existing->Normals;
+			BVHBuildMs = 0.f;
+			return;
+		}
 	}
-	return minDist;
-}
 
-bool AMarchingCubeObject::IsInsideMesh(const FVector& P)
-{
-	 // Use more ray directions for better coverage of flat surfaces
-    const TArray<FVector> RayDirections = {
-        FVector(1.0f, 0.0f, 0.0f),
-        FVector(0.0f, 1.0f, 0.0f),
-        FVector(0.0f, 0.0f, 1.0f),
-        FVector(-1.0f, 0.0f, 0.0f),
-        FVector(0.0f, -1.0f, 0.0f),
-        FVector(0.0f, 0.0f, -1.0f),
-        FVector(1.0f, 1.0f, 1.0f).GetSafeNormal(),
-        FVector(-1.0f, 1.0f, 1.0f).GetSafeNormal(),
-        FVector(1.0f, -1.0f, 1.0f).GetSafeNormal(),
-        FVector(1.0f, 1.0f, -1.0f).GetSafeNormal()
-    };
+	for (auto It = SharedTrees.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
 
-    // Count the number of rays indicating the point is inside
-    int insideCount = 0;
-    int totalRays = RayDirections.Num();
+	TSharedPtr<FTriangleBVH> NewTree = MakeShared<FTriangleBVH>();
+	NewTree->Build(OriginalVertices, OriginalIndices);
+	BVHBuildMs = NewTree->BuildSeconds * 1000.0;
+	UE_LOG(LogVoxel, Display, TEXT("Built triangle BVH over %d triangles in %.2f ms"), NewTree->NumTriangles(), BVHBuildMs);
 
-    // Small epsilon to offset ray start position slightly
-    const float Epsilon = 0.0001f;
+	TSharedPtr<FMeshPseudoNormals> NewNormals = MakeShared<FMeshPseudoNormals>();
+	NewNormals->Build(OriginalVertices, OriginalIndices);
 
-    for (const FVector& RayDir : RayDirections)
-    {
-        // Slightly offset ray starting point to avoid numerical precision issues
-        FVector RayStart = P + RayDir * Epsilon;
-        FVector RayEnd = P + RayDir * 10000.0f;
-        
-        int hits = 0;
-        bool hasHit = false;
-
-        for (int i = 0; i < OriginalIndices.Num(); i += 3)
-        {
-            const FVector& A = OriginalVertices[OriginalIndices[i]];
-            const FVector& B = OriginalVertices[OriginalIndices[i + 1]];
-            const FVector& C = OriginalVertices[OriginalIndices[i + 2]];
-
-            FVector hitPoint;
-            FVector normal;
-            
-            if (FMath::SegmentTriangleIntersection(RayStart, RayEnd, A, B, C, hitPoint, normal))
-            {
-                hasHit = true;
-                hits++;
-            }
-        }
-
-        // If no hits detected with this ray, try the opposite direction
-        if (!hasHit)
-        {
-            FVector oppositeRayEnd = P - RayDir * 10000.0f;
-            
-            for (int i = 0; i < OriginalIndices.Num(); i += 3)
-            {
-                const FVector& A = OriginalVertices[OriginalIndices[i]];
-                const FVector& B = OriginalVertices[OriginalIndices[i + 1]];
-                const FVector& C = OriginalVertices[OriginalIndices[i + 2]];
-
-                FVector hitPoint;
-                FVector normal;
-                
-                if (FMath::SegmentTriangleIntersection(RayStart, oppositeRayEnd, A, B, C, hitPoint, normal))
-                {
-                    hits++;
-                }
-            }
-        }
-
-        if ((hits % 2) == 1)
-        {
-            insideCount++;
-        }
-    }
+	TriangleBVH = NewTree;
+	PseudoNormals = NewNormals;
+	FSharedTree& Shared = SharedTrees.Add(StaticMesh);
+	Shared.RenderData = RenderData;
+#if WITH_EDITORONLY_DATA
+	Shared.DerivedDataKey = RenderData->DerivedDataKey;
+#endif
+	Shared.NumVertices = OriginalVertices.Num();
+	Shared.NumIndices = OriginalIndices.Num();
+	Shared.BVH = TriangleBVH;
+	Shared.Normals = PseudoNormals;
+}
 
-    // Use weighted voting - require more than half the rays to agree
-    return insideCount > (totalRays / 2);
+FMeshSignedDistance AMarchingCubeObject::MakeSignedDistance() const
+{
+	FMeshSignedDistance Query;
+	Query.Vertices = OriginalVertices;
+	Query.Indices = OriginalIndices;
+	Query.BVH = bUseTriangleBVH ? TriangleBVH.Get() : nullptr;
+	Query.PseudoNormals = PseudoNormals.Get();
+	return Query;
 }
 
+void AMarchingCubeObject::CompareSignModes(const FVector& StartPos) const
+{
+	if (!PseudoNormals)
+	{
+		return;
+	}
+
+	const FTransform ActorTransform = GetActorTransform();
+	const FMeshSignedDistance Query = MakeSignedDistance();
+	TArray<int32> Mismatches;
+	Mismatches.Init(0, SizeZ + 1);
+	ParallelFor(SizeZ + 1, [&](int32 Z)
+	{
+		for (int Y = 0; Y <= SizeY; ++Y)
+		{
+			for (int X = 0; X <= SizeX; ++X)
+			{
+				const FVector localPos = ActorTransform.InverseTransformPosition(StartPos + FVector(X, Y, Z) * VoxelSize);
+				int32 Triangle = INDEX_NONE;
+				FVector Closest;
+				Query.ClosestDistance(localPos, &Triangle, &Closest);
+				const bool bVoted = Query.IsInsideByRayVoting(localPos);
+				const bool bPseudoNormal = Triangle != INDEX_NONE && PseudoNormals->IsInside(localPos, Triangle, Closest);
+				Mismatches[Z] += bVoted != bPseudoNormal ? 1 : 0;
+			}
+		}
+	});
+
+	int32 TotalMismatches = 0;
+	for (int32 Count : Mismatches)
+	{
+		TotalMismatches += Count;
+	}
+	const int32 Total = (SizeX + 1) * (SizeY + 1) * (SizeZ + 1);
+	UE_LOG(LogVoxel, Display, TEXT("Sign modes disagree on %d of %d voxels (%.3f%%)"),
+		TotalMismatches, Total, Total > 0 ? 100.0 * TotalMismatches / Total : 0.0);
+}
 
 FVector AMarchingCubeObject::GetVoxelWorldPosition(int X, int Y, int Z) const
 {
@@ -168,45 +334,38 @@ FVector AMarchingCubeObject::GetVoxelWorldPosition(int X, int Y, int Z) const
 
 bool AMarchingCubeObject::SaveVoxelsToFile(const FString& Filename)
 {
-    // Create binary archive
-    FBufferArchive BinaryData;
-    
-    // Write metadata
-    int32 SavedSize = SizeX;
-    BinaryData.Serialize(&SavedSize, sizeof(SavedSize));
-    SavedSize = SizeY;
-    BinaryData.Serialize(&SavedSize, sizeof(SavedSize));
-    SavedSize = SizeZ;
-    BinaryData.Serialize(&SavedSize, sizeof(SavedSize));
-    
-    float SavedVoxelSize = VoxelSize;
-    BinaryData.Serialize(&SavedVoxelSize, sizeof(SavedVoxelSize));
-    
-    // Write array size
-    int32 NumVoxels = Voxels.Num();
-    BinaryData.Serialize(&NumVoxels, sizeof(NumVoxels));
-    
-    // Write voxel data
-    if (NumVoxels > 0)
-    {
-        BinaryData.Serialize(Voxels.GetData(), NumVoxels * sizeof(float));
-    }
+    const double StartTime = FPlatformTime::Seconds();
+
+    FVoxelFileData Data;
+    Data.SizeX = SizeX;
+    Data.SizeY = SizeY;
+    Data.SizeZ = SizeZ;
+    Data.VoxelSize = VoxelSize;
+    Voxels.ToDense(Data.Voxels);
+
+    // Only the distances near the surface matter to the mesh, the rest can be clamped
+    const float QuantizeRange = bQuantizeVoxelFile ? QuantizeVoxelRange * VoxelSize : 0.f;
+    TArray<uint8> FileData;
+    FVoxelFile::Write(Data, SurfaceLevel, QuantizeRange, FileData);
     
     // Save to file
     FString FilePath = FPaths::ProjectSavedDir() + Filename;
-    bool bSuccess = FFileHelper::SaveArrayToFile(BinaryData, *FilePath);
-    
-    // Clean up
-    BinaryData.FlushCache();
-    BinaryData.Empty();
+    bool bSuccess = FFileHelper::SaveArrayToFile(FileData, *FilePath);
     
     if (bSuccess)
     {
-        UE_LOG(LogTemp, Display, TEXT("Saved %d voxels to %s"), NumVoxels, *FilePath);
+        // Journaled edits were made against the old voxels
+        FVoxelJournal::Delete(FilePath);
+        ChangedBricks.Reset();
+        SnapshotDirtyBricks.Reset();
+        SavedSnapshot = MakeShared<FVoxelBrickSnapshot>();
+        UE_LOG(LogVoxel, Display, TEXT("Saved %d voxels to %s: %.1f KB (v1 would be %.1f KB, %s) in %.2f ms"),
+            Voxels.Num(), *FilePath, FileData.Num() / 1024.0, FVoxelFile::GetV1Size(Voxels.Num()) / 1024.0,
+            bQuantizeVoxelFile ? TEXT("int16") : TEXT("float"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
     }
     else
     {
-        UE_LOG(LogTemp, Error, TEXT("Failed to save to %s"), *FilePath);
+        UE_LOG(LogVoxel, Error, TEXT("Failed to save to %s"), *FilePath);
     }
     
     return bSuccess;
@@ -215,74 +374,391 @@ bool AMarchingCubeObject::SaveVoxelsToFile(const FString& Filename)
 bool AMarchingCubeObject::LoadVoxelsFromFile(const FString& Filename)
 {
     FString FilePath = FPaths::ProjectSavedDir() + Filename;
+    const double StartTime = FPlatformTime::Seconds();
     
-    // Load file content
-    TArray<uint8> FileData;
-    if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to load file: %s"), *FilePath);
-        return false;
-    }
-    
-    // Create reader
-    FMemoryReader Reader(FileData, true);
-    
-    // Read metadata
-    int32 LoadedSizeX;
-    Reader.Serialize(&LoadedSizeX, sizeof(LoadedSizeX));
-    int32 LoadedSizeY;
-    Reader.Serialize(&LoadedSizeY, sizeof(LoadedSizeY));
-    int32 LoadedSizeZ;
-    Reader.Serialize(&LoadedSizeZ, sizeof(LoadedSizeZ));
-    
-    float LoadedVoxelSize;
-    Reader.Serialize(&LoadedVoxelSize, sizeof(LoadedVoxelSize));
-    
-    // Read array size
-    int32 NumVoxels;
-    Reader.Serialize(&NumVoxels, sizeof(NumVoxels));
-    
-    if (NumVoxels <= 0 || NumVoxels > 10000000) // Sanity check
+    FVoxelFileData Data;
+    uint32 FileVersion = 0;
+    int64 FileSize = 0;
+    if (!FVoxelFile::ReadFile(*FilePath, Data, &FileVersion, &FileSize))
     {
-        UE_LOG(LogTemp, Error, TEXT("Invalid voxel count: %d"), NumVoxels);
+        UE_LOG(LogVoxel, Error, TEXT("Failed to read voxels from %s"), *FilePath);
         return false;
     }
-    
-    // Read voxel data
-    TArray<float> LoadedVoxels;
-    LoadedVoxels.SetNumUninitialized(NumVoxels);
-    Reader.Serialize(LoadedVoxels.GetData(), NumVoxels * sizeof(float));
+    const double ReadTime = FPlatformTime::Seconds() - StartTime;
     
     // Update object state
     //Size = LoadedSize;
-	SizeX = LoadedSizeX;
-	SizeY = LoadedSizeY;
-	SizeZ = LoadedSizeZ;
-    VoxelSize = LoadedVoxelSize;
-    Voxels = MoveTemp(LoadedVoxels);
+	SizeX = Data.SizeX;
+	SizeY = Data.SizeY;
+	SizeZ = Data.SizeZ;
+    VoxelSize = Data.VoxelSize;
+    Voxels.SetQuantum(GetVoxelQuantum(bQuantizeVoxels, VoxelSize));
+    Voxels.FromDense(FIntVector(SizeX + 1, SizeY + 1, SizeZ + 1), Data.Voxels, SurfaceLevel);
+    Data.Voxels.Empty();
+    if (IsPersistingEdits())
+    {
+        EditSequence = FVoxelJournal::Restore(FilePath, Voxels, -VoxelSize * 2, VoxelSize, ChangedBricks, SnapshotSequence);
+        // The first snapshot after a load copies every changed brick, later ones only what changed since
+        SnapshotDirtyBricks = ChangedBricks;
+        SavedSnapshot = MakeShared<FVoxelBrickSnapshot>();
+    }
+    const int32 NumVoxels = Voxels.Num();
     
     // Reset hit status
     VoxelsHitStatus.Init(false, NumVoxels);
+
+    // Sizes may have changed, so every chunk starts dirty
+    BuildChunks();
     
     // Rebuild mesh
     GenerateMesh();
     ApplyMesh();
     
-    UE_LOG(LogTemp, Display, TEXT("Loaded %d voxels from %s"), NumVoxels, *FilePath);
+    UE_LOG(LogVoxel, Display, TEXT("Loaded %d voxels from %s (v%u, %.1f KB): read %.2f ms, total %.2f ms, %.1f KB in memory (%d of %d bricks dense)"),
+        NumVoxels, *FilePath, FileVersion, FileSize / 1024.0, ReadTime * 1000.0, (FPlatformTime::Seconds() - StartTime) * 1000.0,
+        Voxels.GetAllocatedSize() / 1024.0, Voxels.NumDenseBricks(), Voxels.GetUniformMask().Num());
     return true;
 }
 
+void AMarchingCubeObject::LoadVoxelsFromFileAsync(const FString& Filename)
+{
+	// The static mesh stands in until the voxel mesh is uploaded
+	bStandInWasVisible = StaticMeshComponent->IsVisible();
+	StaticMeshComponent->SetVisibility(true);
+	LoadStartTime = FPlatformTime::Seconds();
+
+	FVoxelMeshSettings Settings;
+	const bool bCanMesh = MakeMeshSettings(Settings);
+	LoadTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [FilePath = FPaths::ProjectSavedDir() + Filename, Settings, bCanMesh, ChunkSize = ChunkSize, bParallel = bParallelMeshing, SurfaceLevel = SurfaceLevel,
+		bQuantize = bQuantizeVoxels, bRestoreEdits = IsPersistingEdits()]() mutable
+	{
+		TSharedPtr<FVoxelLoadResult> Result = MakeShared<FVoxelLoadResult>();
+		const double StartTime = FPlatformTime::Seconds();
+		FVoxelFileData Data;
+		Result->bSuccess = FVoxelFile::ReadFile(*FilePath, Data, &Result->Version, &Result->FileSize);
+		Result->ReadSeconds = FPlatformTime::Seconds() - StartTime;
+		if (!Result->bSuccess)
+		{
+			return Result;
+		}
+		Result->SizeX = Data.SizeX;
+		Result->SizeY = Data.SizeY;
+		Result->SizeZ = Data.SizeZ;
+		Result->VoxelSize = Data.VoxelSize;
+		const FIntVector Dims(Data.SizeX + 1, Data.SizeY + 1, Data.SizeZ + 1);
+		Result->Store.SetQuantum(GetVoxelQuantum(bQuantize, Data.VoxelSize));
+		Result->Store.FromDense(Dims, Data.Voxels, SurfaceLevel);
+		Data.Voxels.Empty();
+		if (bRestoreEdits)
+		{
+			Result->EditSequence = FVoxelJournal::Restore(FilePath, Result->Store, -Data.VoxelSize * 2, Data.VoxelSize, Result->ChangedBricks, Result->SnapshotSequence);
+		}
+		if (!bCanMesh)
+		{
+			return Result;
+		}
+
+		// Same layout BuildChunks makes on the game thread, so the meshes drop straight into the chunks.
+		// Marched from the store the way every later remesh is, so rounding in a quantized store or restored
+		// edits can't make the first mesh differ from the next one.
+		LayoutChunks(FIntVector(Data.SizeX, Data.SizeY, Data.SizeZ), ChunkSize, Data.VoxelSize, Result->Chunks, Result->NumChunks);
+		Settings.VoxelSize = Data.VoxelSize;
+		const FVoxelStore& Store = Result->Store;
+		const FIntVector Apron(FVoxelMesher::GetApron(Settings));
+		ParallelFor(Result->Chunks.Num(), [&Result, &Store, &Settings, &Apron](int32 i)
+		{
+			FVoxelChunk& Chunk = Result->Chunks[i];
+			if (!Store.MayContainSurface(Chunk.CellMin, Chunk.CellMax - FIntVector(1)))
+			{
+				return;
+			}
+			const FIntVector VoxelMin = (Chunk.CellMin - Apron).ComponentMax(FIntVector::ZeroValue);
+			FVoxelBoxCopy ChunkVoxels;
+			Store.CopyBox(VoxelMin, Chunk.CellMax, ChunkVoxels);
+			const FVoxelGridView View = MakeGridView(ChunkVoxels, VoxelMin, Chunk.CellMax - VoxelMin + FIntVector(1), Store.GetEmptyMask(), Store.GetNumBricks());
+			const FVoxelMesher::FJob Job = { Chunk.CellMin, Chunk.CellMax, &Chunk.MeshData };
+			FVoxelMesher(Settings, View).MeshJobs(MakeArrayView(&Job, 1), false);
+		}, bParallel ? EParallelForFlags::BackgroundPriority : EParallelForFlags::ForceSingleThread);
+		Result->bMeshed = true;
+		Result->MeshSeconds = FPlatformTime::Seconds() - StartTime - Result->ReadSeconds;
+		return Result;
+	}, LowLevelTasks::ETaskPriority::BackgroundNormal);
+}
+
+void AMarchingCubeObject::FinishAsyncLoad()
+{
+	TSharedPtr<FVoxelLoadResult> Result = LoadTask.GetResult();
+	LoadTask = {};
+	if (!Result->bSuccess)
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to read voxels from %s, keeping the static mesh"), *VoxelDataFilename);
+		if (!QueuedEdits.IsEmpty())
+		{
+			UE_LOG(LogVoxel, Warning, TEXT("Dropping %d edits made while %s was loading"), QueuedEdits.Num(), *VoxelDataFilename);
+			QueuedEdits.Reset();
+		}
+		return;
+	}
+
+	SizeX = Result->SizeX;
+	SizeY = Result->SizeY;
+	SizeZ = Result->SizeZ;
+	VoxelSize = Result->VoxelSize;
+	Voxels = MoveTemp(Result->Store);
+	ChangedBricks = MoveTemp(Result->ChangedBricks);
+	SnapshotDirtyBricks = ChangedBricks;
+	SavedSnapshot = MakeShared<FVoxelBrickSnapshot>();
+	EditSequence = Result->EditSequence;
+	SnapshotSequence = Result->SnapshotSequence;
+	VoxelsHitStatus.Init(false, Voxels.Num());
+
+	BuildChunks();
+	if (Result->bMeshed)
+	{
+		for (int32 i = 0; i < Chunks.Num(); ++i)
+		{
+			Chunks[i].MeshData = MoveTemp(Result->Chunks[i].MeshData);
+			Chunks[i].bDirty = false;
+			Chunks[i].bMeshReady = true;
+		}
+	}
+	const double UploadStart = FPlatformTime::Seconds();
+	ApplyMesh();
+	for (const FVoxelChunk& Chunk : Chunks)
+	{
+		Mesh->SetMaterial(Chunk.SectionIndex, CustomMat);
+	}
+	FlushCollision();
+	UpdateNavmesh();
+	FlushNavigation(MAX_int32);
+
+	StaticMeshComponent->SetVisibility(bStandInWasVisible);
+	OnVoxelMeshUpdated.Broadcast(this);
+
+	UE_LOG(LogVoxel, Display, TEXT("Loaded %d voxels from %s (v%u, %.1f KB) in the background: read %.2f ms, mesh %.2f ms, game thread %.2f ms, ready after %.2f ms, %.1f KB in memory (%d of %d bricks dense)"),
+		Voxels.Num(), *VoxelDataFilename, Result->Version, Result->FileSize / 1024.0, Result->ReadSeconds * 1000.0, Result->MeshSeconds * 1000.0,
+		(FPlatformTime::Seconds() - UploadStart) * 1000.0, (FPlatformTime::Seconds() - LoadStartTime) * 1000.0,
+		Voxels.GetAllocatedSize() / 1024.0, Voxels.NumDenseBricks(), Voxels.GetUniformMask().Num());
+
+	// Edits made while the file was loading were held back until now
+	FlushEdits();
+}
+
+void AMarchingCubeObject::RecordEdit(const FVoxelBrush& Brush, const FVoxelRegion& Edited)
+{
+	FVoxelEdit& Edit = PendingEdits.AddDefaulted_GetRef();
+	Edit.Sequence = ++EditSequence;
+	Edit.Brush = Brush;
+	Voxels.CollectBricks(Edited, ChangedBricks);
+	Voxels.CollectBricks(Edited, SnapshotDirtyBricks);
+}
+
+void AMarchingCubeObject::PersistEdits(bool bForce)
+{
+	const double Now = FPlatformTime::Seconds();
+	const FString BaselinePath = FPaths::ProjectSavedDir() + VoxelDataFilename;
+	const FIntVector Dims = Voxels.GetDims();
+
+	if (EditSequence != SnapshotSequence && (bForce || Now - LastSnapshotTime >= SnapshotInterval))
+	{
+		// Only the bricks changed since the last snapshot are copied here. Merging them into it, compressing and
+		// writing happen on the pipe. Edits not journaled yet are in the snapshot, so they are dropped.
+		FVoxelBrickSnapshot Changes;
+		Changes.Sequence = EditSequence;
+		Changes.Dims = Dims;
+		TArray<float> BrickValues;
+		for (int32 BrickIndex : SnapshotDirtyBricks)
+		{
+			float Value = 0.f;
+			Voxels.GetBrick(BrickIndex, Value, BrickValues);
+			Changes.Bricks.Add(BrickIndex);
+			Changes.bDense.Add(BrickValues.IsEmpty() ? 0 : 1);
+			if (BrickValues.IsEmpty())
+			{
+				Changes.Values.Add(Value);
+			}
+			else
+			{
+				Changes.Values.Append(BrickValues);
+			}
+		}
+		SaveQueue.Launch(UE_SOURCE_LOCATION, [BaselinePath, Snapshot = SavedSnapshot, Changes = MoveTemp(Changes)]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			FVoxelJournal::MergeSnapshot(*Snapshot, Changes);
+			if (FVoxelJournal::WriteSnapshot(BaselinePath, *Snapshot))
+			{
+				UE_LOG(LogVoxel, Display, TEXT("Saved a snapshot of %d bricks (%d changed) at edit %u in %.2f ms"),
+					Snapshot->Bricks.Num(), Changes.Bricks.Num(), Snapshot->Sequence, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			}
+		}, LowLevelTasks::ETaskPriority::BackgroundLow);
+
+		SnapshotDirtyBricks.Reset();
+		PendingEdits.Reset();
+		SnapshotSequence = EditSequence;
+		LastSnapshotTime = Now;
+		LastJournalFlushTime = Now;
+		return;
+	}
+
+	if (!PendingEdits.IsEmpty() && (bForce || Now - LastJournalFlushTime >= JournalFlushInterval))
+	{
+		SaveQueue.Launch(UE_SOURCE_LOCATION, [BaselinePath, Dims, Edits = MoveTemp(PendingEdits)]()
+		{
+			FVoxelJournal::AppendEdits(BaselinePath, Dims, Edits);
+		}, LowLevelTasks::ETaskPriority::BackgroundLow);
+		PendingEdits.Reset();
+		LastJournalFlushTime = Now;
+	}
+}
+
 //Blake added function :)
-void AMarchingCubeObject::UpdateNavmesh()
+void AMarchingCubeObject::UpdateNavmesh(TConstArrayView<int32> CookedChunks)
 {
 	if (NavigationSystem)
 	{
-		UE_LOG(LogTemp, Display, TEXT("UPDATING NAVMESH"));
-		NavigationSystem->UpdateComponentInNavOctree(*Mesh);
-		NavigationSystem->AddDirtyArea(Mesh->Bounds.GetBox(), ENavigationDirtyFlag::All);
+		// Only queued here, FlushNavigation hands them to the navigation system within the per frame budget
+		if (bAsyncCollision)
+		{
+			PendingNavChunks.Append(CookedChunks);
+		}
+		else
+		{
+			PendingNavChunks.Add(INDEX_NONE);
+		}
+		PendingNavBoxes.Append(EditNavBoxes);
+		EditNavBoxes.Reset();
+		MergeNavBoxes(PendingNavBoxes);
+		return;
+	}
+	UE_LOG(LogVoxel, Warning, TEXT("NAVMESH INVALID!"));
+}
+
+void AMarchingCubeObject::AddEditNavBox(const FVoxelRegion& Region)
+{
+	// Triangles reach one voxel past the changed voxels, and the agent radius erodes the navmesh around them
+	const FIntVector Min = Region.Min - FIntVector(1);
+	const FIntVector Max = Region.Max + FIntVector(1);
+	FBox Box(ForceInit);
+	for (int Corner = 0; Corner < 8; ++Corner)
+	{
+		Box += GetVoxelWorldPosition(Corner & 1 ? Max.X : Min.X, Corner & 2 ? Max.Y : Min.Y, Corner & 4 ? Max.Z : Min.Z);
+	}
+	const float AgentRadius = NavigationSystem ? NavigationSystem->GetDefaultSupportedAgentConfig().AgentRadius : 0.f;
+	EditNavBoxes.Add(Box.ExpandBy(AgentRadius));
+}
+
+void AMarchingCubeObject::MergeNavBoxes(TArray<FBox>& Boxes)
+{
+	// One sweep along X, a box can only overlap the merged boxes still reaching past its Min.X. Folding one in
+	// grows it into others, so it keeps absorbing until none overlap. A burst of shots in one spot ends up as one box.
+	Boxes.Sort([](const FBox& A, const FBox& B) { return A.Min.X < B.Min.X; });
+	TArray<FBox> Merged;
+	TArray<FBox> Active;
+	for (FBox Box : Boxes)
+	{
+		for (int i = Active.Num() - 1; i >= 0; --i)
+		{
+			if (Active[i].Max.X < Box.Min.X)
+			{
+				Merged.Add(Active[i]);
+				Active.RemoveAtSwap(i);
+			}
+		}
+		for (int i = Active.Num() - 1; i >= 0; --i)
+		{
+			if (Active[i].Intersect(Box))
+			{
+				Box += Active[i];
+				Active.RemoveAtSwap(i);
+				i = Active.Num();
+			}
+		}
+		Active.Add(Box);
+	}
+	Merged.Append(Active);
+	Boxes = MoveTemp(Merged);
+}
+
+void AMarchingCubeObject::FlushNavigation(int32 Budget)
+{
+	if (!NavigationSystem || (PendingNavChunks.IsEmpty() && PendingNavBoxes.IsEmpty()))
+	{
 		return;
 	}
-	UE_LOG(LogTemp, Warning, TEXT("NAVMESH INVALID!"));
+	SCOPE_CYCLE_COUNTER(STAT_VoxelNavDirty);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::FlushNavigation);
+
+	// Octree refreshes pick up the new collision geometry. Only the edit boxes touching the component are dirtied
+	// with it, so a shot rebuilds the tiles around it rather than every tile under the component's bounds.
+	int32 Refreshed = 0;
+	TBitArray<> SentBoxes(false, PendingNavBoxes.Num());
+	TArray<FBox> Areas;
+	for (auto It = PendingNavChunks.CreateIterator(); It && Refreshed < Budget; ++It, ++Refreshed)
+	{
+		UPrimitiveComponent* Component = *It == INDEX_NONE ? Mesh.Get() : CollisionChunks[*It].Get();
+		if (Component)
+		{
+			const FBox Bounds = Component->Bounds.GetBox();
+			Areas.Reset();
+			for (int i = 0; i < PendingNavBoxes.Num(); ++i)
+			{
+				if (PendingNavBoxes[i].Intersect(Bounds))
+				{
+					Areas.Add(PendingNavBoxes[i]);
+				}
+			}
+			// Without edit boxes the whole component is new (a load or a regenerate), and one not in the octree
+			// yet has to be added, both dirty its full bounds
+			if (!Areas.IsEmpty() && NavigationSystem->UpdateNavOctreeElementBounds(*Component, Bounds, Areas))
+			{
+				for (int i = 0; i < PendingNavBoxes.Num(); ++i)
+				{
+					SentBoxes[i] = SentBoxes[i] || PendingNavBoxes[i].Intersect(Bounds);
+				}
+			}
+			else
+			{
+				NavigationSystem->UpdateComponentInNavOctree(*Component);
+			}
+		}
+		It.RemoveCurrent();
+	}
+
+	// What is left of the edit boxes covers the agent radius spilling over into neighbouring chunks. Boxes a
+	// component still waiting for its refresh will send are held for it.
+	int32 NumBoxes = 0;
+	TArray<FBox> HeldBoxes;
+	for (int i = 0; i < PendingNavBoxes.Num(); ++i)
+	{
+		if (SentBoxes[i])
+		{
+			continue;
+		}
+		const FBox& Box = PendingNavBoxes[i];
+		bool bHeld = NumBoxes >= Budget;
+		for (auto It = PendingNavChunks.CreateConstIterator(); It && !bHeld; ++It)
+		{
+			const UPrimitiveComponent* Component = *It == INDEX_NONE ? Mesh.Get() : CollisionChunks[*It].Get();
+			bHeld = Component && Box.Intersect(Component->Bounds.GetBox());
+		}
+		// Chunks still cooking send their boxes once the new collision is in
+		for (auto It = CookingChunks.CreateConstIterator(); It && !bHeld; ++It)
+		{
+			bHeld = Box.Intersect(CollisionChunks[It->Key]->Bounds.GetBox());
+		}
+		if (bHeld)
+		{
+			HeldBoxes.Add(Box);
+			continue;
+		}
+		NavigationSystem->AddDirtyArea(Box, ENavigationDirtyFlag::All);
+		++NumBoxes;
+	}
+	PendingNavBoxes = MoveTemp(HeldBoxes);
+
+	UE_LOG(LogVoxel, Verbose, TEXT("UPDATING NAVMESH: %d components, %d dirty areas, %d components and %d areas left"),
+		Refreshed, NumBoxes, PendingNavChunks.Num(), PendingNavBoxes.Num());
 }
 
 
@@ -291,6 +767,23 @@ void AMarchingCubeObject::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// Edits queued during the frame are carved once every actor, the shooters included, has ticked
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &AMarchingCubeObject::OnWorldPostActorTick);
+
+	if (bAsyncCollision)
+	{
+		// Collision and navigation come from the per chunk collision components instead
+		CollisionProfile = Mesh->GetCollisionProfileName();
+		Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Mesh->SetCanEverAffectNavigation(false);
+	}
+
+	if (ShouldLoad && bAsyncLoad)
+	{
+		LoadVoxelsFromFileAsync(VoxelDataFilename);
+		return;
+	}
+
 	UStaticMesh* StaticMesh = StaticMeshComponent ? StaticMeshComponent->GetStaticMesh() : nullptr;
 
 	if(StaticMesh)
@@ -305,15 +798,10 @@ void AMarchingCubeObject::BeginPlay()
 		SizeY = NewSizeY;
 		SizeZ = NewSizeZ;
 		
-		Voxels.SetNum((SizeX + 1) * (SizeY + 1) * (SizeZ + 1));
-		VoxelsHitStatus.SetNum((SizeX + 1) * (SizeY + 1) * (SizeZ + 1));
+		VoxelsHitStatus.SetNum((SizeX + 1) * (SizeY + 1) * (SizeZ + 1), false);
 		//Colors.SetNum((Size + 1) * (Size + 1) * (Size + 1));
 		//Voxels = TArray<float>();
-		Colors = TArray<FColor>();
-		Vertices = TArray<FVector>();
-		Triangles = TArray<int>();
-		Normals = TArray<FVector>();
-		UVs = TArray<FVector2D>();
+		BuildChunks();
 	
 		OriginalColors = TArray<FColor>();
 		OriginalVertices = TArray<FVector>();
@@ -326,19 +814,24 @@ void AMarchingCubeObject::BeginPlay()
 	if (ShouldLoad)
 	{
 		LoadVoxelsFromFile(VoxelDataFilename);
-		Mesh->SetMaterial(0, CustomMat);
+		for (const FVoxelChunk& Chunk : Chunks)
+		{
+			Mesh->SetMaterial(Chunk.SectionIndex, CustomMat);
+		}
+		FlushCollision();
 		UpdateNavmesh();
+		FlushNavigation(MAX_int32);
 		return;
 	}
 
 	if (StaticMesh)
 	{
-		UE_LOG(LogTemp, Display, TEXT("Mesh is initialized"));
+		UE_LOG(LogVoxel, Verbose, TEXT("Mesh is initialized"));
 		//UStaticMesh* tempStatic = StaticMesh->GetStaticMesh();
 		FStaticMeshRenderData* renderData = StaticMesh->GetRenderData();
 		if (renderData)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Getting Data"));
+			UE_LOG(LogVoxel, Verbose, TEXT("Getting Data"));
 			const FStaticMeshLODResources& LODResources = renderData->LODResources[0];
 			const FPositionVertexBuffer& PositionBuffer = LODResources.VertexBuffers.PositionVertexBuffer;
 			const FStaticMeshVertexBuffer& VertexBuffer = LODResources.VertexBuffers.StaticMeshVertexBuffer;
@@ -375,6 +868,8 @@ void AMarchingCubeObject::BeginPlay()
 			    }
 			}
 
+			BuildTriangleBVH(StaticMesh);
+
 			//Vertices = OriginalVertices;
 			//Normals = OriginalNormals;
 			//Triangles = OriginalTriangles;
@@ -383,29 +878,64 @@ void AMarchingCubeObject::BeginPlay()
 		}
 		else
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Could not get Data Data"));
+			UE_LOG(LogVoxel, Warning, TEXT("Could not get Data Data"));
 		}
 	}
 	else
 	{
-			UE_LOG(LogTemp, Warning, TEXT("mesh not initialized"));
+			UE_LOG(LogVoxel, Warning, TEXT("mesh not initialized"));
 	}
 	
 
 	//UE_LOG(LogTemp, Warning, TEXT("Starting Data Generation"));
 
 	GenerateData(GetActorLocation());
-	UE_LOG(LogTemp, Warning, TEXT("Generate Data Done"));
+	UE_LOG(LogVoxel, Verbose, TEXT("Generate Data Done"));
 	GenerateMesh();
-	UE_LOG(LogTemp, Warning, TEXT("Generate Mesh Done"));
+	UE_LOG(LogVoxel, Verbose, TEXT("Generate Mesh Done"));
 	ApplyMesh();
-	UE_LOG(LogTemp, Warning, TEXT("Apply Mesh Done"));
+	UE_LOG(LogVoxel, Verbose, TEXT("Apply Mesh Done"));
 	if (ShouldSave)
 	{
 		SaveVoxelsToFile(VoxelDataFilename);
 	}
 
+	// Nothing to throttle at startup, the collision is needed straight away. Async cooked chunks are refreshed
+	// from Tick once their cooks finish.
+	FlushCollision();
 	UpdateNavmesh();
+	FlushNavigation(MAX_int32);
+}
+
+void AMarchingCubeObject::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	// Edits made while the file is still loading need its voxels before they can be carved and journaled
+	if (LoadTask.IsValid() && IsPersistingEdits() && !QueuedEdits.IsEmpty())
+	{
+		LoadTask.Wait();
+		FinishAsyncLoad();
+	}
+
+	// Whatever is still only in memory goes to disk, and the pipe has to be empty before it is destroyed
+	if (IsPersistingEdits())
+	{
+		// Queued edits were never carved, they still belong in the journal
+		for (const FVoxelQueuedEdit& Edit : QueuedEdits)
+		{
+			const FVoxelRegion Edited = Voxels.ApplyBrush(Edit.Brush);
+			if (!Edited.IsEmpty())
+			{
+				RecordEdit(Edit.Brush, Edited);
+			}
+		}
+		PersistEdits(true);
+	}
+	QueuedEdits.Empty();
+	SaveQueue.WaitUntilEmpty();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -413,6 +943,38 @@ void AMarchingCubeObject::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (LoadTask.IsValid() && LoadTask.IsCompleted())
+	{
+		FinishAsyncLoad();
+	}
+	ApplyAsyncResults();
+
+	// Shots landing close together share one cook per chunk
+	if (bAsyncCollision && !PendingCollisionChunks.IsEmpty() && FPlatformTime::Seconds() - LastCollisionFlushTime >= CollisionUpdateInterval)
+	{
+		FlushCollision();
+	}
+	// Recast reads the collision geometry, so the navmesh waits for the cooks rather than starting them
+	if (!CookingChunks.IsEmpty())
+	{
+		const TArray<int32> Cooked = FinishCollisionCooks();
+		if (!Cooked.IsEmpty())
+		{
+			UpdateNavmesh(Cooked);
+		}
+	}
+
+	FlushNavigation(NavUpdatesPerFrame);
+
+	if (!Chunks.IsEmpty() && !Voxels.IsEmpty())
+	{
+		UpdateLOD();
+	}
+
+	if (IsPersistingEdits())
+	{
+		PersistEdits(false);
+	}
 }
 
 void AMarchingCubeObject::GenerateData(const FVector& Position)
@@ -422,170 +984,438 @@ void AMarchingCubeObject::GenerateData(const FVector& Position)
 	{
 		return;
 	}
-	FVector MeshCenter = StaticMesh->GetBoundingBox().GetCenter();
-	FVector offset = Position - MeshCenter;
+	SCOPE_CYCLE_COUNTER(STAT_VoxelVoxelize);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::GenerateData);
     FVector startPos = Position - FVector(SizeX/4 * VoxelSize, SizeY/2 * VoxelSize,0);
-    const float SurfaceProximityThreshold = VoxelSize * 0.1f;
-	
-	for (int X = 0; X <= SizeX; ++X)
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Every voxel is independent, so each Z slice runs as its own task.
+	// The math is the same per voxel either way, so the result doesn't depend on the thread count.
+	// Transform is fetched once. InverseTransformPosition is kept rather than a precomputed inverse matrix so the
+	// values match the old serial bake exactly.
+	const FTransform ActorTransform = GetActorTransform();
+	auto VoxelLocalPosition = [&ActorTransform, startPos, this](int X, int Y, int Z)
 	{
-		for (int Y = 0; Y <= SizeY; ++Y)
+		return ActorTransform.InverseTransformPosition(startPos + FVector(X, Y, Z) * VoxelSize);
+	};
+
+	const FMeshSignedDistance Query = MakeSignedDistance();
+	const bool bPseudoNormalSign = SignMode == EVoxelSignMode::PseudoNormal;
+
+	// Baked dense, then everything away from the surface collapses into single value bricks
+	TArray<float> Dense;
+	BakeDense(FIntVector(SizeX, SizeY, SizeZ), [&](int32 X, int32 Y, int32 Z)
+	{
+		return Query.SignedDistance(VoxelLocalPosition(X, Y, Z), bPseudoNormalSign);
+	}, bParallelVoxelize, Dense);
+	VoxelsHitStatus.Init(false, Dense.Num());
+	Voxels.SetQuantum(GetVoxelQuantum(bQuantizeVoxels, VoxelSize));
+	Voxels.FromDense(FIntVector(SizeX + 1, SizeY + 1, SizeZ + 1), Dense, SurfaceLevel);
+
+	// Debug probes, kept out of the loop above
+	const FIntVector Probes[] = { FIntVector(0, 0, 0), FIntVector(SizeX/2, SizeY/2, SizeZ/2), FIntVector(SizeX, SizeY, SizeZ) };
+	const TCHAR* ProbeNames[] = { TEXT("Start"), TEXT("Center"), TEXT("End") };
+	for (int i = 0; i < UE_ARRAY_COUNT(Probes); ++i)
+	{
+		const FVector localPos = VoxelLocalPosition(Probes[i].X, Probes[i].Y, Probes[i].Z);
+		UE_LOG(LogVoxel, VeryVerbose, TEXT("%s point (%f,%f,%f) - isInside: %s"), ProbeNames[i],
+			localPos.X, localPos.Y, localPos.Z,
+			Query.SignedDistance(localPos, bPseudoNormalSign) > 0.f ? TEXT("true") : TEXT("false"));
+	}
+
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+	VoxelizeMs = Elapsed * 1000.0;
+	AverageVoxelQueryUs = Voxels.Num() > 0 ? Elapsed * 1000000.0 / Voxels.Num() : 0.0;
+	UE_LOG(LogVoxel, Display, TEXT("Voxelized %d voxels in %.2f ms (%.2f us per voxel, BVH %s)"),
+		Voxels.Num(), VoxelizeMs, AverageVoxelQueryUs, bUseTriangleBVH && TriangleBVH ? TEXT("on") : TEXT("off"));
+	UE_LOG(LogVoxel, Display, TEXT("Voxel storage %.1f KB, dense would be %.1f KB (%d of %d bricks dense)"),
+		Voxels.GetAllocatedSize() / 1024.0, Voxels.Num() * sizeof(float) / 1024.0, Voxels.NumDenseBricks(), Voxels.GetUniformMask().Num());
+
+	if (bCompareSignModes)
+	{
+		CompareSignModes(startPos);
+	}
+}
+
+void AMarchingCubeObject::BakeDense(const FIntVector& Cells, TFunctionRef<float(int32 X, int32 Y, int32 Z)> Sample, bool bParallel, TArray<float>& OutDense)
+{
+	const FIntVector Dims = Cells + FIntVector(1);
+	OutDense.SetNumUninitialized(Dims.X * Dims.Y * Dims.Z);
+	ParallelFor(Dims.Z, [&](int32 Z)
+	{
+		float* Row = OutDense.GetData() + Z * Dims.Y * Dims.X;
+		for (int32 Y = 0; Y < Dims.Y; ++Y)
 		{
-			for (int Z = 0; Z <= SizeZ; ++Z)
+			for (int32 X = 0; X < Dims.X; ++X)
 			{
-				FVector pos = startPos + FVector(X, Y, Z) * VoxelSize;
-				FVector localPos = GetActorTransform().InverseTransformPosition(pos);
-				
-				float dist = ClosestTriangleDistance(localPos);
-				bool isInside = IsInsideMesh(localPos);
-
-				if (X == 0 && Y == 0 && Z == 0) {
-                    // Debug center point
-                    UE_LOG(LogTemp, Warning, TEXT("Start point (%f,%f,%f) - isInside: %s"),
-                        localPos.X, localPos.Y, localPos.Z, 
-                        isInside ? TEXT("true") : TEXT("false"));
-                }
-				if (X == SizeX/2 && Y == SizeY/2 && Z == SizeZ/2) {
-                    // Debug center point
-                    UE_LOG(LogTemp, Warning, TEXT("Center point (%f,%f,%f) - isInside: %s"),
-                        localPos.X, localPos.Y, localPos.Z, 
-                        isInside ? TEXT("true") : TEXT("false"));
-                }
-				if (X == SizeX && Y == SizeY && Z == SizeZ) {
-                    // Debug center point
-                    UE_LOG(LogTemp, Warning, TEXT("End point (%f,%f,%f) - isInside: %s"),
-                        localPos.X, localPos.Y, localPos.Z, 
-                        isInside ? TEXT("true") : TEXT("false"));
-                }
-
-				Voxels[GetVoxelIndex(X,Y,Z)] = isInside ? dist : -dist;
-				VoxelsHitStatus[GetVoxelIndex(X,Y,Z)] = false;
+				*Row++ = Sample(X, Y, Z);
 			}
 		}
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+}
+
+void AMarchingCubeObject::BuildChunks()
+{
+	// Drop the old sections, the chunk layout may not match anymore
+	Mesh->ClearAllMeshSections();
+	for (UProceduralMeshComponent* CollisionChunk : CollisionChunks)
+	{
+		if (CollisionChunk)
+		{
+			CollisionChunk->DestroyComponent();
+		}
+	}
+	CollisionChunks.Reset();
+	PendingCollisionChunks.Reset();
+	CookingChunks.Reset();
+	PendingNavChunks.Reset();
+	LayoutChunks(FIntVector(SizeX, SizeY, SizeZ), ChunkSize, VoxelSize, Chunks, NumChunks);
+
+	for (UProceduralMeshComponent* LODMesh : LODMeshes)
+	{
+		if (LODMesh)
+		{
+			LODMesh->ClearAllMeshSections();
+		}
+	}
+	LODChunks.Reset();
+	LODChunks.SetNum(GetNumLODs() - 1);
+	for (FVoxelLODChunks& LOD : LODChunks)
+	{
+		LOD.Dirty.Init(true, Chunks.Num());
+		LOD.Generations.Init(0, Chunks.Num());
 	}
 }
 
-void AMarchingCubeObject::GenerateMesh()
+void AMarchingCubeObject::LayoutChunks(const FIntVector& Cells, int32 ChunkSize, float VoxelSize, TArray<FVoxelChunk>& OutChunks, FIntVector& OutNumChunks)
 {
-	if (SurfaceLevel > 0.0f)
+	const int Size = FMath::Max(ChunkSize, 1);
+	OutNumChunks = FIntVector(
+		FMath::DivideAndRoundUp(Cells.X, Size),
+		FMath::DivideAndRoundUp(Cells.Y, Size),
+		FMath::DivideAndRoundUp(Cells.Z, Size));
+
+	OutChunks.Reset();
+	OutChunks.SetNum(OutNumChunks.X * OutNumChunks.Y * OutNumChunks.Z);
+
+	for (int CZ = 0; CZ < OutNumChunks.Z; ++CZ)
 	{
-		TriangleOrder[0] = 0;
-		TriangleOrder[1] = 1;
-		TriangleOrder[2] = 2;
+		for (int CY = 0; CY < OutNumChunks.Y; ++CY)
+		{
+			for (int CX = 0; CX < OutNumChunks.X; ++CX)
+			{
+				const int Index = CZ * OutNumChunks.X * OutNumChunks.Y + CY * OutNumChunks.X + CX;
+				FVoxelChunk& Chunk = OutChunks[Index];
+				Chunk.CellMin = FIntVector(CX, CY, CZ) * Size;
+				Chunk.CellMax = FIntVector(
+					FMath::Min((CX + 1) * Size, Cells.X),
+					FMath::Min((CY + 1) * Size, Cells.Y),
+					FMath::Min((CZ + 1) * Size, Cells.Z));
+				Chunk.SectionIndex = Index;
+				Chunk.bDirty = true;
+				Chunk.Bounds = FBox(FVector(Chunk.CellMin) * VoxelSize, FVector(Chunk.CellMax) * VoxelSize);
+			}
+		}
 	}
-	else
+}
+
+int AMarchingCubeObject::GetChunkIndex(int X, int Y, int Z) const
+{
+	return Z * NumChunks.X * NumChunks.Y + Y * NumChunks.X + X;
+}
+
+void AMarchingCubeObject::MarkChunksDirty(const FIntVector& VoxelMin, const FIntVector& VoxelMax)
+{
+	if (Chunks.IsEmpty())
 	{
-		TriangleOrder[0] = 2;
-		TriangleOrder[1] = 1;
-		TriangleOrder[2] = 0;
+		return;
 	}
 
-	float Cube[8];
-	for (int X = 0; X < SizeX; ++X)
+	FIntVector First;
+	FIntVector Last;
+	GetChunkRange(VoxelMin, VoxelMax, ChunkSize, NumChunks, First, Last);
+	for (int CZ = First.Z; CZ <= Last.Z; ++CZ)
 	{
-		for (int Y = 0; Y < SizeY; ++Y)
+		for (int CY = First.Y; CY <= Last.Y; ++CY)
 		{
-			for (int Z = 0; Z < SizeZ; ++Z)
+			for (int CX = First.X; CX <= Last.X; ++CX)
 			{
-				for (int i = 0; i < 8; ++i)
+				const int32 ChunkIndex = GetChunkIndex(CX, CY, CZ);
+				Chunks[ChunkIndex].bDirty = true;
+				for (FVoxelLODChunks& LOD : LODChunks)
 				{
-					Cube[i] = Voxels[GetVoxelIndex(X + VertexOffset[i][0], Y + VertexOffset[i][1], Z + VertexOffset[i][2])];
+					LOD.Dirty[ChunkIndex] = true;
 				}
-				March(X,Y,Z,Cube);
 			}
 		}
 	}
 }
 
-void AMarchingCubeObject::March(int X, int Y, int Z, const float Cube[8])
+void AMarchingCubeObject::GetChunkRange(const FIntVector& VoxelMin, const FIntVector& VoxelMax, int32 ChunkSize, const FIntVector& NumChunks, FIntVector& OutFirst, FIntVector& OutLast)
+{
+	// A voxel is a corner of the cells on both sides of it, so one below the min is touched too
+	const int Size = FMath::Max(ChunkSize, 1);
+	OutFirst = FIntVector(
+		FMath::Clamp((VoxelMin.X - 1) / Size, 0, NumChunks.X - 1),
+		FMath::Clamp((VoxelMin.Y - 1) / Size, 0, NumChunks.Y - 1),
+		FMath::Clamp((VoxelMin.Z - 1) / Size, 0, NumChunks.Z - 1));
+	OutLast = FIntVector(
+		FMath::Clamp(VoxelMax.X / Size, 0, NumChunks.X - 1),
+		FMath::Clamp(VoxelMax.Y / Size, 0, NumChunks.Y - 1),
+		FMath::Clamp(VoxelMax.Z / Size, 0, NumChunks.Z - 1));
+}
+
+bool AMarchingCubeObject::MakeMeshSettings(FVoxelMeshSettings& OutSettings) const
 {
 	UStaticMesh* StaticMesh = StaticMeshComponent ? StaticMeshComponent->GetStaticMesh() : nullptr;
 	if(!StaticMesh)
 	{
-		return;
+		return false;
 	}
 	FBox boundingBox = StaticMesh->GetBoundingBox();
-	FVector meshMin = boundingBox.Min;
-	FVector meshMax = boundingBox.Max;
-	const float meshWidth = meshMax.X - meshMin.X;
-	const float meshHeight = meshMax.Y - meshMin.Y;
-	
-	int VertexMask = 0;
-	FVector EdgeVertex[12];
-	for (int i = 0; i < 8; ++i)
+	OutSettings.UVWidth = boundingBox.Max.X - boundingBox.Min.X;
+	OutSettings.UVHeight = boundingBox.Max.Y - boundingBox.Min.Y;
+	OutSettings.SurfaceLevel = SurfaceLevel;
+	OutSettings.bInterpolation = Interpolation;
+	OutSettings.VoxelSize = VoxelSize;
+	OutSettings.bSharedVertices = bSharedVertices;
+	OutSettings.bSurfaceNets = bSurfaceNets;
+	OutSettings.SimplifyError = SimplifyError;
+
+	if (SurfaceLevel > 0.0f)
+	{
+		OutSettings.TriangleOrder[0] = 0;
+		OutSettings.TriangleOrder[1] = 1;
+		OutSettings.TriangleOrder[2] = 2;
+	}
+	else
 	{
-		if (Cube[i] <= SurfaceLevel)
-				VertexMask |= (1 << i);
+		OutSettings.TriangleOrder[0] = 2;
+		OutSettings.TriangleOrder[1] = 1;
+		OutSettings.TriangleOrder[2] = 0;
 	}
-	const int EdgeMask = CubeEdgeFlags[VertexMask];
+	return true;
+}
 
-	if (EdgeMask == 0 ) return;
-	
-	//Makes cubes showing alll the marching cubes in the object. Debugging.
-    /*if (EdgeMask != 0)
-    {
-        FVector CubeMin = FVector(X, Y, Z) * VoxelSize;
-        FVector CubeMax = CubeMin + FVector(VoxelSize, VoxelSize, VoxelSize);
-        FColor BoxColor = FColor::Yellow;
-        FColor BoxHitColor = FColor::Red;
-        
-        // Draw debug box with actor transform applied
-        DrawDebugBox(
-            GetWorld(),
-            GetActorLocation() + GetActorRotation().RotateVector((CubeMin + CubeMax) * 0.5f),
-            (CubeMax - CubeMin) * 0.5f,
-            GetActorRotation().Quaternion(),
-            VoxelsHitStatus[GetVoxelIndex(X,Y,Z)] ? BoxHitColor : BoxColor,
-            false,
-            10000000.0f,  // Lifetime (0 = one frame)
-            0,     // DepthPriority
-            1.0f   // Thickness
-        );
-    }*/
+FVoxelGridView AMarchingCubeObject::MakeGridView(const FVoxelBoxCopy& Snapshot, const FIntVector& Origin, const FIntVector& Dims, const TArray<uint8>& EmptyBricks, const FIntVector& NumBricks)
+{
+	FVoxelGridView View;
+	View.Data = Snapshot.Values.GetData();
+	View.Origin = Origin;
+	View.Dims = Dims;
+	View.EmptyBricks = EmptyBricks.GetData();
+	View.NumBricks = NumBricks;
+	View.BrickSize = FVoxelStore::BrickSize;
+	if (!Snapshot.Steps.IsEmpty())
+	{
+		// The mesher compares the steps directly, nothing is converted back to floats
+		View.QuantizedData = Snapshot.Steps.GetData();
+		View.Quantum = Snapshot.Quantum;
+	}
+	return View;
+}
+
+float AMarchingCubeObject::GetVoxelQuantum(bool bQuantize, float InVoxelSize)
+{
+	return bQuantize ? InVoxelSize / FVoxelStore::StepsPerVoxel : 0.f;
+}
+
+void AMarchingCubeObject::GenerateMesh()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::GenerateMesh);
+	FVoxelMeshSettings Settings;
+	if (!MakeMeshSettings(Settings))
+	{
+		return;
+	}
 
-	//UE_LOG(LogTemp, Warning, TEXT("Making Edges"))
-	for (int i = 0; i < 12; ++i)
+	TArray<FVoxelMesher::FJob> Jobs;
+	FIntVector SnapshotMin(MAX_int32);
+	FIntVector SnapshotMax(MIN_int32);
+	for (FVoxelChunk& Chunk : Chunks)
 	{
-		if ((EdgeMask & (1 << i)) != 0)
+		if (!Chunk.bDirty)
 		{
-			const float Offset = Interpolation ? GetInterpolationOffset(Cube[EdgeConnection[i][0]], Cube[EdgeConnection[i][1]]) : 0.5f;
+			continue;
+		}
+		Chunk.bDirty = false;
+		Chunk.bMeshReady = true;
+		// Anything still running in the background for this chunk is now out of date
+		Chunk.Generation = ++RemeshGeneration;
 
-			EdgeVertex[i].X = X + (VertexOffset[EdgeConnection[i][0]][0] + Offset * EdgeDirection[i][0]);
-			EdgeVertex[i].Y = Y + (VertexOffset[EdgeConnection[i][0]][1] + Offset * EdgeDirection[i][1]);
-			EdgeVertex[i].Z = Z + (VertexOffset[EdgeConnection[i][0]][2] + Offset * EdgeDirection[i][2]);
+		// No brick of the chunk has values on both sides of the surface
+		if (!Voxels.MayContainSurface(Chunk.CellMin, Chunk.CellMax - FIntVector(1)))
+		{
+			Chunk.MeshData.Reset();
+			continue;
 		}
+		Jobs.Add({ Chunk.CellMin, Chunk.CellMax, &Chunk.MeshData });
+		SnapshotMin = FIntVector(FMath::Min(SnapshotMin.X, Chunk.CellMin.X), FMath::Min(SnapshotMin.Y, Chunk.CellMin.Y), FMath::Min(SnapshotMin.Z, Chunk.CellMin.Z));
+		SnapshotMax = FIntVector(FMath::Max(SnapshotMax.X, Chunk.CellMax.X), FMath::Max(SnapshotMax.Y, Chunk.CellMax.Y), FMath::Max(SnapshotMax.Z, Chunk.CellMax.Z));
 	}
 
-	for (int i = 0; i < 5; ++i)
+	if (Jobs.IsEmpty())
 	{
-		if (TriangleConnectionTable[VertexMask][3*i] < 0) break;
-		FVector V1  = EdgeVertex[TriangleConnectionTable[VertexMask][3*i]] * VoxelSize;
-		FVector V2  = EdgeVertex[TriangleConnectionTable[VertexMask][3*i + 1]] * VoxelSize;
-		FVector V3  = EdgeVertex[TriangleConnectionTable[VertexMask][3*i + 2]] * VoxelSize;
+		return;
+	}
 
-		FVector Normal = FVector::CrossProduct(V2 - V1, V3 - V1);
+	// The mesher reads dense voxels, so the box around the dirty chunks is expanded for the march
+	SnapshotMin = (SnapshotMin - FIntVector(FVoxelMesher::GetApron(Settings))).ComponentMax(FIntVector::ZeroValue);
+	FVoxelBoxCopy Snapshot;
+	Voxels.CopyBox(SnapshotMin, SnapshotMax, Snapshot);
+	const FVoxelGridView View = MakeGridView(Snapshot, SnapshotMin, SnapshotMax - SnapshotMin + FIntVector(1), Voxels.GetEmptyMask(), Voxels.GetNumBricks());
+	FVoxelMesher(Settings, View).MeshJobs(Jobs, bParallelMeshing);
+}
 
-		FColor Color = FColor::MakeRandomColor();
+void AMarchingCubeObject::GenerateMeshAsync(LowLevelTasks::ETaskPriority Priority)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::GenerateMeshAsync);
+	FVoxelMeshSettings Settings;
+	if (!MakeMeshSettings(Settings))
+	{
+		return;
+	}
 
-		Normal.Normalize();
+	// Snapshot on the game thread so later edits can't change the voxels under the task
+	TArray<FVoxelRemeshTask> Batch;
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		FVoxelChunk& Chunk = Chunks[ChunkIndex];
+		if (!Chunk.bDirty)
+		{
+			continue;
+		}
+		Chunk.bDirty = false;
+		Chunk.Generation = ++RemeshGeneration;
 
-		Vertices.Append({V1, V2, V3});
+		FVoxelRemeshTask& Task = Batch.AddDefaulted_GetRef();
+		Task.ChunkIndex = ChunkIndex;
+		Task.Generation = Chunk.Generation;
+		Task.CellMin = Chunk.CellMin;
+		Task.CellMax = Chunk.CellMax;
+		Task.VoxelMin = (Chunk.CellMin - FIntVector(FVoxelMesher::GetApron(Settings))).ComponentMax(FIntVector::ZeroValue);
+		// Chunks without a surface are left without voxels and come back with an empty mesh
+		if (Voxels.MayContainSurface(Chunk.CellMin, Chunk.CellMax - FIntVector(1)))
+		{
+			Voxels.CopyBox(Task.VoxelMin, Chunk.CellMax, Task.Voxels);
+		}
+	}
 
-		FVector2D UV1 = FVector2D(V1.X / meshWidth, (V1.Y + V1.Z) / (meshHeight + meshHeight));
-		FVector2D UV2 = FVector2D(V2.X / meshWidth, (V2.Y + V2.Z) / (meshHeight + meshHeight));
-		FVector2D UV3 = FVector2D(V3.X / meshWidth, (V3.Y + V3.Z) / (meshHeight + meshHeight));
-		
-        UVs.Append({ UV1, UV2, UV3 });
-		
-		Triangles.Append({
-			VertexCount + TriangleOrder[0],
-			VertexCount + TriangleOrder[1],
-			VertexCount + TriangleOrder[2]});
+	LaunchRemesh(MoveTemp(Batch), Settings, Voxels.GetEmptyMask(), Voxels.GetNumBricks(), Priority);
+}
 
-		Normals.Append({Normal, Normal, Normal});
-		
-		Colors.Append({Color, Color, Color});
-		VertexCount += 3;		
+void AMarchingCubeObject::LaunchRemesh(TArray<FVoxelRemeshTask>&& Batch, const FVoxelMeshSettings& Settings, const TArray<uint8>& EmptyBricks,
+	const FIntVector& NumBricks, LowLevelTasks::ETaskPriority Priority)
+{
+	if (Batch.IsEmpty())
+	{
+		return;
+	}
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Settings, Batch = MoveTemp(Batch), Results = CompletedRemeshes, bParallel = bParallelMeshing,
+		EmptyBricks = EmptyBricks, NumBricks = NumBricks]() mutable
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(VoxelRemeshTask);
+		ParallelFor(Batch.Num(), [&Batch, &Settings, &EmptyBricks, &NumBricks](int32 i)
+		{
+			FVoxelRemeshTask& Task = Batch[i];
+			if (Task.Voxels.IsEmpty())
+			{
+				return;
+			}
+			const FVoxelGridView View = MakeGridView(Task.Voxels, Task.VoxelMin, Task.CellMax - Task.VoxelMin + FIntVector(1), EmptyBricks, NumBricks);
+
+			const FVoxelMesher::FJob Job = { Task.CellMin, Task.CellMax, &Task.MeshData };
+			FVoxelMesher(Settings, View).MeshJobs(MakeArrayView(&Job, 1), false);
+			Task.Voxels.Empty();
+		}, bParallel ? EParallelForFlags::BackgroundPriority : EParallelForFlags::ForceSingleThread);
+
+		Results->Enqueue(MoveTemp(Batch));
+	}, Priority);
+}
+
+void AMarchingCubeObject::ApplyAsyncResults()
+{
+	bool bApplied = false;
+	bool bAppliedLOD = false;
+	// Newest result for the LOD on screen, edits only count as visible once it has their changes
+	uint32 AppliedGeneration = 0;
+	TArray<FVoxelRemeshTask> Batch;
+	while (CompletedRemeshes->Dequeue(Batch))
+	{
+		for (FVoxelRemeshTask& Task : Batch)
+		{
+			if (Task.LOD > 0)
+			{
+				// Superseded, or the LODs were laid out again since
+				if (!LODChunks.IsValidIndex(Task.LOD - 1) || !LODChunks[Task.LOD - 1].Generations.IsValidIndex(Task.ChunkIndex)
+					|| LODChunks[Task.LOD - 1].Generations[Task.ChunkIndex] != Task.Generation)
+				{
+					continue;
+				}
+				LODChunks[Task.LOD - 1].Generations[Task.ChunkIndex] = 0;
+				UProceduralMeshComponent* LODMesh = GetLODMesh(Task.LOD);
+				const FVoxelMeshBuffers& Data = Task.MeshData;
+				if (Data.Vertices.IsEmpty())
+				{
+					LODMesh->ClearMeshSection(Task.ChunkIndex);
+				}
+				else
+				{
+					SCOPE_CYCLE_COUNTER(STAT_VoxelMeshUpload);
+					LODMesh->CreateMeshSection(Task.ChunkIndex, Data.Vertices, Data.Triangles, Data.Normals, Data.UVs, Data.Colors, TArray<FProcMeshTangent>(), false);
+					if (UMaterialInterface* SectionMaterial = Mesh->GetMaterial(0))
+					{
+						LODMesh->SetMaterial(Task.ChunkIndex, SectionMaterial);
+					}
+				}
+				if (Task.LOD == CurrentLOD)
+				{
+					bAppliedLOD = true;
+					AppliedGeneration = FMath::Max(AppliedGeneration, Task.Generation);
+				}
+				continue;
+			}
+
+			// A newer edit (or a reload) superseded this result
+			if (!Chunks.IsValidIndex(Task.ChunkIndex) || Chunks[Task.ChunkIndex].Generation != Task.Generation)
+			{
+				continue;
+			}
+			FVoxelChunk& Chunk = Chunks[Task.ChunkIndex];
+			Chunk.MeshData = MoveTemp(Task.MeshData);
+			Chunk.bMeshReady = true;
+			bApplied = true;
+			if (CurrentLOD == 0)
+			{
+				AppliedGeneration = FMath::Max(AppliedGeneration, Task.Generation);
+			}
+		}
+	}
+
+	if (bApplied)
+	{
+		ApplyMesh();
+	}
+	if (bApplied || bAppliedLOD)
+	{
+		// An edit is on screen once a batch launched at or after it lands. A superseded result hands its
+		// edits to the newer batch that replaced it.
+		const double Now = FPlatformTime::Seconds();
+		for (auto It = PendingEditLatency.CreateIterator(); It; ++It)
+		{
+			if (It->Key <= AppliedGeneration)
+			{
+				FVoxelLatencyHistogram::GetEditLatency().Add((Now - It->Value) * 1000.0);
+				It.RemoveCurrent();
+			}
+		}
+
+		if (bApplied && !bAsyncCollision)
+		{
+			UpdateNavmesh();
+		}
+		OnVoxelMeshUpdated.Broadcast(this);
 	}
 }
 
@@ -594,18 +1424,333 @@ int AMarchingCubeObject::GetVoxelIndex(int X, int Y, int Z) const
     return Z * (SizeX + 1) * (SizeY + 1) + Y * (SizeX + 1) + X;
 }
 
-float AMarchingCubeObject::GetInterpolationOffset(float V1, float V2) const
+void AMarchingCubeObject::ApplyMesh()
 {
-	const float Delta = V2 - V1;
-	return Delta == 0.0f ? SurfaceLevel : (SurfaceLevel - V1) / Delta;
+	SCOPE_CYCLE_COUNTER(STAT_VoxelMeshUpload);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::ApplyMesh);
+	TArray<FVoxelChunk*> ReadyChunks;
+	for (FVoxelChunk& Chunk : Chunks)
+	{
+		if (Chunk.bMeshReady)
+		{
+			ReadyChunks.Add(&Chunk);
+		}
+	}
+	const double StartTime = FPlatformTime::Seconds();
+	double CookTime = 0.0;
+	int32 VertexTotal = 0;
+	int32 IndexTotal = 0;
+
+	UMaterialInterface* SectionMaterial = Mesh->GetMaterial(0);
+	for (int i = 0; i < ReadyChunks.Num(); ++i)
+	{
+		FVoxelChunk& Chunk = *ReadyChunks[i];
+		const FVoxelMeshBuffers& Data = Chunk.MeshData;
+		VertexTotal += Data.Vertices.Num();
+		IndexTotal += Data.Triangles.Num();
+
+		if (bAsyncCollision)
+		{
+			// Visual only, FlushCollision picks the chunk up later
+			Mesh->CreateMeshSection(Chunk.SectionIndex, Data.Vertices, Data.Triangles, Data.Normals, Data.UVs, Data.Colors, TArray<FProcMeshTangent>(), false);
+			PendingCollisionChunks.Add(Chunk.SectionIndex);
+		}
+		else
+		{
+			// Every CreateMeshSection with collision re-cooks the whole body, so only the last upload cooks.
+			// The earlier sections are flagged so they are part of that cook.
+			if (i == ReadyChunks.Num() - 1)
+			{
+				SCOPE_CYCLE_COUNTER(STAT_VoxelCollisionCook);
+				TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::CookCollision);
+				const double SectionStart = FPlatformTime::Seconds();
+				Mesh->CreateMeshSection(Chunk.SectionIndex, Data.Vertices, Data.Triangles, Data.Normals, Data.UVs, Data.Colors, TArray<FProcMeshTangent>(), true);
+				CookTime = FPlatformTime::Seconds() - SectionStart;
+			}
+			else
+			{
+				Mesh->CreateMeshSection(Chunk.SectionIndex, Data.Vertices, Data.Triangles, Data.Normals, Data.UVs, Data.Colors, TArray<FProcMeshTangent>(), false);
+				Mesh->GetProcMeshSection(Chunk.SectionIndex)->bEnableCollision = true;
+			}
+		}
+		if (Chunk.SectionIndex != 0 && SectionMaterial)
+		{
+			Mesh->SetMaterial(Chunk.SectionIndex, SectionMaterial);
+		}
+		Chunk.bMeshReady = false;
+	}
+
+	// The synchronous cook rides along with the last section, split it out so the numbers match the async mode
+	LastVisualUpdateMs = (FPlatformTime::Seconds() - StartTime - CookTime) * 1000.0;
+	if (!bAsyncCollision)
+	{
+		LastCollisionUpdateMs = CookTime * 1000.0;
+	}
+
+	const int64 MeshBytes = int64(VertexTotal) * (sizeof(FVector) * 2 + sizeof(FColor) + sizeof(FVector2D)) + int64(IndexTotal) * sizeof(int);
+	UE_LOG(LogVoxel, Verbose, TEXT("Uploaded %d of %d chunks: %d vertices, %d triangles, %.1f KB, visual %.2f ms, collision %.2f ms (%s vertices)"),
+		ReadyChunks.Num(), Chunks.Num(), VertexTotal, IndexTotal / 3, MeshBytes / 1024.0,
+		LastVisualUpdateMs, bAsyncCollision ? 0.0 : LastCollisionUpdateMs, bSharedVertices ? TEXT("shared") : TEXT("per triangle"));
 }
 
-void AMarchingCubeObject::ApplyMesh()
+int32 AMarchingCubeObject::GetNumLODs() const
+{
+	// Coarse chunks have to start on a coarse cell so the dirty chunks of an edit are the same at every LOD
+	int32 NumLODs = 1;
+	while (NumLODs <= LODScreenSizes.Num() && ChunkSize % (1 << NumLODs) == 0)
+	{
+		++NumLODs;
+	}
+	return NumLODs;
+}
+
+int32 AMarchingCubeObject::ComputeLOD() const
+{
+	const APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (!PlayerController || !PlayerController->PlayerCameraManager)
+	{
+		return 0;
+	}
+
+	const FBoxSphereBounds Bounds(FBox(FVector::ZeroVector, FVector(SizeX, SizeY, SizeZ) * VoxelSize).TransformBy(Mesh->GetComponentTransform()));
+	const APlayerCameraManager* Camera = PlayerController->PlayerCameraManager;
+	const double Distance = FMath::Max(FVector::Dist(Camera->GetCameraLocation(), Bounds.Origin), 1.0);
+	const double HalfFOV = FMath::DegreesToRadians(Camera->GetFOVAngle() * 0.5);
+	const double ScreenSize = Bounds.SphereRadius / (Distance * FMath::Tan(HalfFOV));
+
+	const int32 NumLODs = GetNumLODs();
+	int32 LOD = 0;
+	while (LOD + 1 < NumLODs && ScreenSize < LODScreenSizes[LOD])
+	{
+		++LOD;
+	}
+	return LOD;
+}
+
+bool FVoxelLODChunks::IsUpToDate() const
+{
+	return Dirty.Find(true) == INDEX_NONE && !Generations.ContainsByPredicate([](uint32 Generation) { return Generation != 0; });
+}
+
+void AMarchingCubeObject::UpdateLOD()
+{
+	const int32 TargetLOD = ComputeLOD();
+	if (TargetLOD > 0)
+	{
+		GenerateLODMeshAsync(TargetLOD, LowLevelTasks::ETaskPriority::Normal);
+	}
+	// The switch waits for the target's remeshes so a stale or half built LOD is never shown. LOD 0 is always
+	// being kept up to date.
+	if (TargetLOD == CurrentLOD || (TargetLOD > 0 && !LODChunks[TargetLOD - 1].IsUpToDate()))
+	{
+		return;
+	}
+
+	// Only the visuals switch, collision stays on LOD 0 or its collision chunks
+	Mesh->SetVisibility(TargetLOD == 0);
+	for (int32 LOD = 1; LOD <= LODMeshes.Num(); ++LOD)
+	{
+		if (LODMeshes[LOD - 1])
+		{
+			LODMeshes[LOD - 1]->SetVisibility(LOD == TargetLOD);
+		}
+	}
+	CurrentLOD = TargetLOD;
+}
+
+UProceduralMeshComponent* AMarchingCubeObject::GetLODMesh(int32 LOD)
 {
-	UE_LOG(LogTemp, Warning, TEXT("%d"), Vertices.Num());
-	UE_LOG(LogTemp, Warning, TEXT("%d"), Triangles.Num());
-	UE_LOG(LogTemp, Warning, TEXT("%d"), Normals.Num());
-	UE_LOG(LogTemp, Warning, TEXT("%d"), Colors.Num());
-	Mesh->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, Colors, TArray<FProcMeshTangent>(), true);
+	if (LODMeshes.Num() < LOD)
+	{
+		LODMeshes.SetNum(LOD);
+	}
+
+	TObjectPtr<UProceduralMeshComponent>& LODMesh = LODMeshes[LOD - 1];
+	if (!LODMesh)
+	{
+		LODMesh = NewObject<UProceduralMeshComponent>(this);
+		LODMesh->SetupAttachment(Mesh);
+		LODMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		LODMesh->SetCanEverAffectNavigation(false);
+		LODMesh->SetVisibility(LOD == CurrentLOD);
+		LODMesh->RegisterComponent();
+	}
+	return LODMesh;
 }
 
+void AMarchingCubeObject::GenerateLODMeshAsync(int32 LOD, LowLevelTasks::ETaskPriority Priority)
+{
+	FVoxelLODChunks& LODState = LODChunks[LOD - 1];
+	if (LODState.Dirty.Find(true) == INDEX_NONE)
+	{
+		return;
+	}
+	FVoxelMeshSettings Settings;
+	if (!MakeMeshSettings(Settings))
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::GenerateLODMeshAsync);
+
+	// A coarse cell spans Stride voxels and its corners are every Stride-th voxel. The last coarse cell can
+	// hang over the grid, its far corners are clamped to the last voxel and the mesher puts them there.
+	const int32 Stride = 1 << LOD;
+	const FIntVector Cells(SizeX, SizeY, SizeZ);
+	const FIntVector CoarseCells(
+		FMath::DivideAndRoundUp(SizeX, Stride),
+		FMath::DivideAndRoundUp(SizeY, Stride),
+		FMath::DivideAndRoundUp(SizeZ, Stride));
+	auto ToCoarse = [&](const FIntVector& Cell)
+	{
+		return FIntVector(
+			Cell.X == Cells.X ? CoarseCells.X : Cell.X / Stride,
+			Cell.Y == Cells.Y ? CoarseCells.Y : Cell.Y / Stride,
+			Cell.Z == Cells.Z ? CoarseCells.Z : Cell.Z / Stride);
+	};
+
+	const FIntVector Apron(FVoxelMesher::GetApron(Settings));
+	TArray<FVoxelRemeshTask> Batch;
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		if (!LODState.Dirty[ChunkIndex])
+		{
+			continue;
+		}
+		LODState.Dirty[ChunkIndex] = false;
+		LODState.Generations[ChunkIndex] = ++RemeshGeneration;
+
+		const FVoxelChunk& Chunk = Chunks[ChunkIndex];
+		FVoxelRemeshTask& Task = Batch.AddDefaulted_GetRef();
+		Task.ChunkIndex = ChunkIndex;
+		Task.Generation = RemeshGeneration;
+		Task.LOD = LOD;
+		Task.CellMin = ToCoarse(Chunk.CellMin);
+		Task.CellMax = ToCoarse(Chunk.CellMax);
+		Task.VoxelMin = (Task.CellMin - Apron).ComponentMax(FIntVector::ZeroValue);
+		// Chunks without a surface are left without voxels and come back with an empty mesh
+		if (Voxels.MayContainSurface(Chunk.CellMin, Chunk.CellMax - FIntVector(1)))
+		{
+			const FIntVector CoarseDims = Task.CellMax - Task.VoxelMin + FIntVector(1);
+			Task.Voxels.Values.SetNumUninitialized(CoarseDims.X * CoarseDims.Y * CoarseDims.Z);
+		}
+	}
+
+	// Every Stride-th voxel is gathered here so later edits can't change them under the task, the chunks are
+	// small enough that this is cheaper than copying their full resolution voxels
+	ParallelFor(Batch.Num(), [this, &Batch, Stride](int32 i)
+	{
+		FVoxelRemeshTask& Task = Batch[i];
+		if (Task.Voxels.IsEmpty())
+		{
+			return;
+		}
+		float* Dest = Task.Voxels.Values.GetData();
+		for (int Z = Task.VoxelMin.Z; Z <= Task.CellMax.Z; ++Z)
+		{
+			const int VoxelZ = FMath::Min(Z * Stride, SizeZ);
+			for (int Y = Task.VoxelMin.Y; Y <= Task.CellMax.Y; ++Y)
+			{
+				const int VoxelY = FMath::Min(Y * Stride, SizeY);
+				for (int X = Task.VoxelMin.X; X <= Task.CellMax.X; ++X)
+				{
+					*Dest++ = Voxels.Get(FMath::Min(X * Stride, SizeX), VoxelY, VoxelZ);
+				}
+			}
+		}
+	}, bParallelMeshing ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	UE_LOG(LogVoxel, Verbose, TEXT("Remeshing %d chunks of LOD %d (stride %d)"), Batch.Num(), LOD, Stride);
+	// The coarse voxels have no empty brick mask, every cell is classified
+	Settings.VoxelSize = VoxelSize * Stride;
+	Settings.CellEnd = FVector(SizeX, SizeY, SizeZ) / Stride;
+	LaunchRemesh(MoveTemp(Batch), Settings, TArray<uint8>(), FIntVector::ZeroValue, Priority);
+}
+
+UProceduralMeshComponent* AMarchingCubeObject::GetCollisionChunk(int32 ChunkIndex)
+{
+	if (CollisionChunks.Num() < Chunks.Num())
+	{
+		CollisionChunks.SetNum(Chunks.Num());
+	}
+
+	TObjectPtr<UProceduralMeshComponent>& CollisionChunk = CollisionChunks[ChunkIndex];
+	if (!CollisionChunk)
+	{
+		CollisionChunk = NewObject<UProceduralMeshComponent>(this);
+		CollisionChunk->SetupAttachment(Mesh);
+		CollisionChunk->bUseAsyncCooking = true;
+		CollisionChunk->SetVisibility(false);
+		CollisionChunk->SetCollisionProfileName(CollisionProfile);
+		CollisionChunk->RegisterComponent();
+	}
+	return CollisionChunk;
+}
+
+void AMarchingCubeObject::FlushCollision()
+{
+	if (!bAsyncCollision)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_VoxelCollisionCook);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMarchingCubeObject::FlushCollision);
+	const double StartTime = FPlatformTime::Seconds();
+	int32 Started = 0;
+	for (auto It = PendingCollisionChunks.CreateIterator(); It; ++It)
+	{
+		// One cook per chunk at a time, so the body setup changing means this cook is done and not an older one
+		const int32 ChunkIndex = *It;
+		if (CookingChunks.Contains(ChunkIndex))
+		{
+			continue;
+		}
+		// The chunk's latest mesh, however many edits landed since the last flush
+		const FVoxelMeshBuffers& Data = Chunks[ChunkIndex].MeshData;
+		UProceduralMeshComponent* CollisionChunk = GetCollisionChunk(ChunkIndex);
+		CookingChunks.Add(ChunkIndex, { CollisionChunk->GetBodySetup(), StartTime });
+		CollisionChunk->CreateMeshSection(0, Data.Vertices, Data.Triangles, TArray<FVector>(), TArray<FVector2D>(), TArray<FColor>(), TArray<FProcMeshTangent>(), true);
+		It.RemoveCurrent();
+		++Started;
+	}
+	LastCollisionFlushTime = FPlatformTime::Seconds();
+	LastCollisionUpdateMs = (LastCollisionFlushTime - StartTime) * 1000.0;
+
+	UE_LOG(LogVoxel, Verbose, TEXT("Started collision cooks for %d chunks in %.2f ms, %d waiting for a cook to finish"),
+		Started, LastCollisionUpdateMs, PendingCollisionChunks.Num());
+}
+
+TArray<int32> AMarchingCubeObject::FinishCollisionCooks()
+{
+	// A failed cook leaves the old body setup in place, so the chunk is refreshed anyway after a while
+	constexpr double CookTimeout = 5.0;
+	const double Now = FPlatformTime::Seconds();
+	TArray<int32> Cooked;
+	for (auto It = CookingChunks.CreateIterator(); It; ++It)
+	{
+		UProceduralMeshComponent* CollisionChunk = CollisionChunks[It->Key];
+		const bool bSwapped = CollisionChunk->GetBodySetup() != It->Value.OldBodySetup.Get();
+		if (!bSwapped && Now - It->Value.StartTime < CookTimeout)
+		{
+			continue;
+		}
+		UE_CLOG(!bSwapped, LogVoxel, Warning, TEXT("Collision cook of chunk %d didn't finish in %.0f s"), It->Key, CookTimeout);
+		Cooked.Add(It->Key);
+		It.RemoveCurrent();
+	}
+	return Cooked;
+}
+
+static FAutoConsoleCommand EditLatencyCommand(
+	TEXT("Voxel.EditLatency"),
+	TEXT("Logs the histogram of time from a destruction input to its mesh being visible. Voxel.EditLatency reset clears it."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FVoxelLatencyHistogram& Histogram = FVoxelLatencyHistogram::GetEditLatency();
+		if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+		{
+			Histogram.Reset();
+			return;
+		}
+		Histogram.Log();
+	}));
@@ -4,10 +4,115 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Containers/Queue.h"
 #include "ProceduralMeshComponent.h"
 #include "NavigationSystem.h"
+#include "TriangleBVH.h"
+#include "MeshPseudoNormals.h"
+#include "MeshSignedDistance.h"
+#include "VoxelMesher.h"
+#include "VoxelFile.h"
+#include "VoxelStore.h"
+#include "VoxelJournal.h"
+#include "Tasks/Pipe.h"
+#include "Tasks/Task.h"
 #include "MarchingCubeObject.generated.h"
 
+//How voxelization decides whether a voxel is inside the source mesh
+UENUM()
+enum class EVoxelSignMode : uint8
+{
+	//Majority vote of ray crossing parity over 10 directions, up to 20 ray casts per voxel
+	RayVoting,
+	//Angle weighted pseudo-normal of the closest triangle, no extra queries
+	PseudoNormal
+};
+
+//A fixed size block of cells with its own mesh section.
+//Chunks read their corners straight from the shared voxel grid, so the values on a face two chunks
+//share are the same voxels and the surfaces line up without cracks.
+struct FVoxelChunk
+{
+	//Cell range covered by the chunk, Max is exclusive
+	FIntVector CellMin = FIntVector::ZeroValue;
+	FIntVector CellMax = FIntVector::ZeroValue;
+	int32 SectionIndex = 0;
+	//Voxels changed since the chunk was last marched
+	bool bDirty = true;
+	//MeshData is newer than the uploaded section
+	bool bMeshReady = false;
+	//Latest remesh requested for this chunk, older async results are thrown away
+	uint32 Generation = 0;
+	//Actor local bounds
+	FBox Bounds = FBox(ForceInit);
+	FVoxelMeshBuffers MeshData;
+};
+
+//Per coarse LOD, the chunks that are out of date and the remeshes still running for them
+struct FVoxelLODChunks
+{
+	//Edited since the LOD was last marched
+	TBitArray<> Dirty;
+	//Latest remesh launched for each chunk, 0 once its result is in
+	TArray<uint32> Generations;
+
+	bool IsUpToDate() const;
+};
+
+//A collision chunk whose async cook is running
+struct FVoxelCollisionCook
+{
+	//The body setup the component had before, it swaps in the cooked one when the cook finishes
+	TWeakObjectPtr<UBodySetup> OldBodySetup;
+	double StartTime = 0.0;
+};
+
+//A MakeHole or brush waiting for the end of the frame, already in voxel space
+struct FVoxelQueuedEdit
+{
+	FVoxelBrush Brush;
+	double InputTime = 0.0;
+};
+
+//Copy of the voxels around one chunk, marched on a background task
+struct FVoxelRemeshTask
+{
+	int32 ChunkIndex = INDEX_NONE;
+	uint32 Generation = 0;
+	//0 for the full mesh, otherwise the cells and voxels are in the LOD's coarse grid
+	int32 LOD = 0;
+	FIntVector CellMin;
+	FIntVector CellMax;
+	//First voxel in Voxels, below CellMin when the mesher needs an apron
+	FIntVector VoxelMin;
+	FVoxelBoxCopy Voxels;
+	FVoxelMeshBuffers MeshData;
+};
+
+//A voxel file read and marched on a background task
+struct FVoxelLoadResult
+{
+	bool bSuccess = false;
+	bool bMeshed = false;
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	int32 SizeZ = 0;
+	float VoxelSize = 0.f;
+	FVoxelStore Store;
+	TArray<FVoxelChunk> Chunks;
+	FIntVector NumChunks = FIntVector::ZeroValue;
+	uint32 Version = 0;
+	int64 FileSize = 0;
+	double ReadSeconds = 0.0;
+	double MeshSeconds = 0.0;
+	//Restored from the edit journal
+	TSet<int32> ChangedBricks;
+	uint32 EditSequence = 0;
+	uint32 SnapshotSequence = 0;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVoxelMeshUpdated, AMarchingCubeObject*, VoxelObject);
+
 UCLASS()
 class AMarchingCubeObject : public AActor
 {
@@ -23,17 +128,133 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
 	float MeshScale = 10.f;
 
+	//Cells per chunk side. Each chunk is marched and uploaded on its own.
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks", meta=(ClampMin="4"))
+	int32 ChunkSize = 16;
+
+	//Marches dirty chunks on worker threads in slabs of FVoxelMesher::SlabDepth cells
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
+	bool bParallelMeshing = true;
+
+	//MakeHole returns straight away and the touched chunks are marched on a background task,
+	//then uploaded on a later tick
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
+	bool bAsyncRemesh = true;
+
+	//MakeHole and the brushes only queue the edit. Once every actor has ticked the queued edits are carved together and each
+	//dirty chunk is remeshed once, so a shotgun blast costs one remesh instead of one per pellet.
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
+	bool bQueueEdits = true;
+	//Most queued edits carved per frame, the rest wait for the next frame. 0 carves them all.
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks", meta=(ClampMin="0"))
+	int32 MaxEditsPerFrame = 0;
+	//Edits carved at the end of the last frame and edits still left in the queue after it
+	UPROPERTY(VisibleInstanceOnly, Category="MarchingChunks")
+	int32 LastFrameEdits = 0;
+	UPROPERTY(VisibleInstanceOnly, Category="MarchingChunks")
+	int32 EditQueueDepth = 0;
+	UPROPERTY(VisibleInstanceOnly, Category="MarchingChunks")
+	int32 MaxEditQueueDepth = 0;
+
+	//Each edge crossing becomes one vertex shared by all triangles using it, with an averaged normal.
+	//Off gives every triangle its own three vertices and a flat normal.
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
+	bool bSharedVertices = false;
+
+	//Meshes with Surface Nets instead of marching cubes, one vertex per surface cell joined by quads.
+	//Roughly half the triangles and no slivers, at the cost of slightly rounder edges. Vertices are always shared.
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
+	bool bSurfaceNets = false;
+
+	//Collapses triangles of each marched chunk as long as no surface moves further than this (world units),
+	//which mostly merges the flat faces of walls and floors. Chunk borders are kept. 0 turns it off.
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks", meta=(ClampMin="0"))
+	float SimplifyError = 0.f;
+
+	//Keeps voxels as 16 bit steps of VoxelSize/256 instead of floats, half the memory for dense bricks and
+	//for the copies the mesher reads. Takes effect the next time the voxels are baked or loaded.
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
+	bool bQuantizeVoxels = false;
+
+	//Visual sections update right away without collision. Collision lives on one hidden component per chunk
+	//and only changed chunks are re-cooked asynchronously, at most once every CollisionUpdateInterval seconds.
+	UPROPERTY(EditDefaultsOnly, Category="Collision")
+	bool bAsyncCollision = true;
+	UPROPERTY(EditDefaultsOnly, Category="Collision", meta=(ClampMin="0"))
+	float CollisionUpdateInterval = 0.1f;
+
+	//Most navigation octree refreshes and dirty areas handed to the navigation system per frame, the rest wait
+	//for the next frame so agents keep pathing while a lot is being destroyed
+	UPROPERTY(EditDefaultsOnly, Category="Navigation", meta=(ClampMin="1"))
+	int32 NavUpdatesPerFrame = 4;
+
+	//Coarser meshes marched from every 2nd, 4th, ... voxel. Entry i is the screen size below which LOD i + 1 is
+	//shown instead of the full mesh. The whole object switches at once so chunks never meet at different
+	//resolutions. Only LODs whose stride divides ChunkSize are used.
+	UPROPERTY(EditDefaultsOnly, Category="LOD")
+	TArray<float> LODScreenSizes = { 0.25f, 0.1f };
+	UPROPERTY(VisibleInstanceOnly, Category="LOD")
+	int32 CurrentLOD = 0;
+
 	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
 	bool ShouldSave = false;
 	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
 	bool ShouldLoad = true;
 
 
+	//Reads and marches the voxel file on a background task. The static mesh is shown until the voxel mesh is ready.
+	UPROPERTY(EditDefaultsOnly, Category="MarchingChunks")
+	bool bAsyncLoad = true;
+
 	UPROPERTY(EditdefaultsOnly, Category="SavingObj")
 	FString VoxelDataFilename = TEXT("Test.voxel");
+	//Saves distances as int16 clamped to QuantizeVoxelRange voxels around the surface instead of full floats
+	UPROPERTY(EditdefaultsOnly, Category="SavingObj")
+	bool bQuantizeVoxelFile = false;
+	UPROPERTY(EditdefaultsOnly, Category="SavingObj", meta=(ClampMin="1"))
+	float QuantizeVoxelRange = 4.f;
+	//Journals every MakeHole next to the voxel file and snapshots the changed bricks, written on a background
+	//task. Loading the voxel file brings the destruction back. Needs ShouldLoad or ShouldSave.
+	UPROPERTY(EditdefaultsOnly, Category="SavingObj")
+	bool bPersistEdits = false;
+	UPROPERTY(EditdefaultsOnly, Category="SavingObj", meta=(ClampMin="0"))
+	float JournalFlushInterval = 1.f;
+	UPROPERTY(EditdefaultsOnly, Category="SavingObj", meta=(ClampMin="1"))
+	float SnapshotInterval = 30.f;
 	
 	UFUNCTION(BlueprintCallable)
 	void MakeHole(const FVector& Center, float Radius);
+	//MakeHole for an edit caused by input that arrived at InputTime (FPlatformTime::Seconds), timed until its mesh is visible
+	void MakeHoleFromInput(const FVector& Center, float Radius, double InputTime);
+	//Combines a brush into the voxels the way MakeHole does. Its positions are in world space and its sizes and
+	//Smoothing in world units, DistanceScale and HoleValue come from VoxelSize.
+	void ApplyBrush(const FVoxelBrush& WorldBrush, double InputTime);
+
+	//Removes a capsule, e.g. along a bullet's path. Unlike MakeHole every size is in world units, Smoothing
+	//rounds off the edge of the cut.
+	UFUNCTION(BlueprintCallable, Category="MarchingChunks|Brushes")
+	void CarveCapsule(const FVector& Start, const FVector& End, float Radius, float Smoothing = 0.f);
+	UFUNCTION(BlueprintCallable, Category="MarchingChunks|Brushes")
+	void CarveBox(const FVector& Center, const FVector& Extent, const FRotator& Rotation, float Smoothing = 0.f);
+	UFUNCTION(BlueprintCallable, Category="MarchingChunks|Brushes")
+	void CarveCone(const FVector& Base, const FVector& Tip, float Radius, float Smoothing = 0.f);
+	//Adds material, Smoothing blends it into what is already there
+	UFUNCTION(BlueprintCallable, Category="MarchingChunks|Brushes")
+	void AddSphere(const FVector& Center, float Radius, float Smoothing = 0.f);
+	UFUNCTION(BlueprintCallable, Category="MarchingChunks|Brushes")
+	void AddBox(const FVector& Center, const FVector& Extent, const FRotator& Rotation, float Smoothing = 0.f);
+
+	//Fires once the mesh for an edit is visible
+	UPROPERTY(BlueprintAssignable, Category="MarchingChunks")
+	FOnVoxelMeshUpdated OnVoxelMeshUpdated;
+
+	//Steps of the pipeline that don't need an actor, shared with the Voxel.Bench benchmark so it times the same code
+	//Samples the (Cells + 1)^3 voxels into OutDense, X rows first, one task per Z slice when bParallel
+	static void BakeDense(const FIntVector& Cells, TFunctionRef<float(int32 X, int32 Y, int32 Z)> Sample, bool bParallel, TArray<float>& OutDense);
+	//Splits a grid of Cells into chunks of ChunkSize cells, all dirty
+	static void LayoutChunks(const FIntVector& Cells, int32 ChunkSize, float VoxelSize, TArray<FVoxelChunk>& OutChunks, FIntVector& OutNumChunks);
+	//First and last chunk with a cell that uses a voxel in the inclusive voxel range
+	static void GetChunkRange(const FIntVector& VoxelMin, const FIntVector& VoxelMax, int32 ChunkSize, const FIntVector& NumChunks, FIntVector& OutFirst, FIntVector& OutLast);
 
 
 	
@@ -41,44 +262,126 @@ public:
 private:
 	void GenerateData(const FVector& Position);
 	void GenerateMesh();
-	void March(int X, int Y, int Z, const float Cube[8]);
+	//Snapshots the dirty chunks and marches them on a background task, Tick picks up the results
+	void GenerateMeshAsync(LowLevelTasks::ETaskPriority Priority = LowLevelTasks::ETaskPriority::Normal);
+	//Marches the snapshots on a background task and queues them for ApplyAsyncResults
+	void LaunchRemesh(TArray<FVoxelRemeshTask>&& Batch, const FVoxelMeshSettings& Settings, const TArray<uint8>& EmptyBricks,
+		const FIntVector& NumBricks, LowLevelTasks::ETaskPriority Priority);
+	//Applies finished background remeshes that are still the newest for their chunk
+	void ApplyAsyncResults();
+	//False when there is no static mesh to take the UVs from
+	bool MakeMeshSettings(FVoxelMeshSettings& OutSettings) const;
+	//View over a dense copy of the voxels starting at Origin, skipping the bricks flagged in EmptyBricks
+	static FVoxelGridView MakeGridView(const FVoxelBoxCopy& Snapshot, const FIntVector& Origin, const FIntVector& Dims, const TArray<uint8>& EmptyBricks, const FIntVector& NumBricks);
+	//Store quantum for VoxelSize, 0 keeps floats
+	static float GetVoxelQuantum(bool bQuantize, float VoxelSize);
 	int GetVoxelIndex(int X, int Y, int Z) const;
-	float GetInterpolationOffset(float V1, float V2) const;
 	
+	//Uploads every chunk with a fresh mesh
 	void ApplyMesh();
+	//Starts cooking collision for the chunks changed since the last flush. A chunk still cooking waits for the next flush.
+	void FlushCollision();
+	//The chunks whose cook finished since the last call, their new collision is in the physics scene
+	TArray<int32> FinishCollisionCooks();
+	UProceduralMeshComponent* GetCollisionChunk(int32 ChunkIndex);
+
+	//Actor space position in voxel units, the inverse of GetVoxelWorldPosition
+	FVector WorldToVoxel(const FVector& WorldPos) const;
+
+	void BuildChunks();
+	//Flags every chunk with a cell that uses a voxel in the inclusive voxel range
+	void MarkChunksDirty(const FIntVector& VoxelMin, const FIntVector& VoxelMax);
+	int GetChunkIndex(int X, int Y, int Z) const;
 
 	//Blake added this :)
 	UPROPERTY()
 	UNavigationSystemV1* NavigationSystem = UNavigationSystemV1::GetCurrent(GetWorld());
 
-	void UpdateNavmesh();
+	//CookedChunks are the collision chunks whose cook finished, only used with bAsyncCollision
+	void UpdateNavmesh(TConstArrayView<int32> CookedChunks = TConstArrayView<int32>());
+	//World box of an edit padded by the agent radius, held until the edit's geometry is in
+	void AddEditNavBox(const FVoxelRegion& Region);
+	static void MergeNavBoxes(TArray<FBox>& Boxes);
+	//Sends up to Budget component refreshes and Budget dirty areas to the navigation system
+	void FlushNavigation(int32 Budget);
+
+	//Edits still being meshed or cooked
+	TArray<FBox> EditNavBoxes;
+	//Merged dirty areas and components (INDEX_NONE is Mesh) waiting for their navigation update
+	TArray<FBox> PendingNavBoxes;
+	TSet<int32> PendingNavChunks;
 	//End of Blake section :)
 
 	UPROPERTY()
 	TObjectPtr<UProceduralMeshComponent> Mesh;
 
+	int32 GetNumLODs() const;
+	//From the bounds of the grid and the player camera, the same measure as the engine's ComputeBoundsScreenSize
+	int32 ComputeLOD() const;
+	//Switches to the LOD for the current screen size once its out of date chunks are remeshed
+	void UpdateLOD();
+	//Snapshots the dirty chunks of a coarse LOD and marches them on the background task LOD 0 uses. LOD 0 is never
+	//hidden from edits since collision is cooked from it, the others only catch up while they are wanted on screen.
+	void GenerateLODMeshAsync(int32 LOD, LowLevelTasks::ETaskPriority Priority);
+	UProceduralMeshComponent* GetLODMesh(int32 LOD);
+
+	//LOD 1 and up, created the first time they are shown
+	UPROPERTY()
+	TArray<TObjectPtr<UProceduralMeshComponent>> LODMeshes;
+	//Per LOD from 1
+	TArray<FVoxelLODChunks> LODChunks;
+
+	//Collision only components, one per chunk, created when a chunk is first cooked
+	UPROPERTY()
+	TArray<TObjectPtr<UProceduralMeshComponent>> CollisionChunks;
+	TSet<int32> PendingCollisionChunks;
+	TMap<int32, FVoxelCollisionCook> CookingChunks;
+	double LastCollisionFlushTime = 0.0;
+	FName CollisionProfile;
+
+	UPROPERTY(VisibleInstanceOnly, Category="Collision")
+	float LastVisualUpdateMs = 0.f;
+	UPROPERTY(VisibleInstanceOnly, Category="Collision")
+	float LastCollisionUpdateMs = 0.f;
+
 	UPROPERTY(EditDefaultsOnly, Category="Static Mesh")
 	UStaticMeshComponent* StaticMeshComponent;
 
 	UPROPERTY(EditDefaultsOnly, category="Marching Chunks")
 	UMaterialInterface* CustomMat;
 
-	TArray<float> Voxels;
-	TArray<bool> VoxelsHitStatus;
-	int TriangleOrder[3] = {0,1,2};
+	//Sparse, bricks away from the surface are a single value
+	FVoxelStore Voxels;
+	TBitArray<> VoxelsHitStatus;
 	//int Size = 1000;
 	int SizeX = 64;
 	int SizeY = 64;
 	int SizeZ = 64;
 	UPROPERTY(EditDefaultsOnly, Category="Static Mesh")
 	float VoxelSize = 20.f;
-	int VertexCount = 0;
 
-	TArray<FVector> Vertices;
-	TArray<int> Triangles;
-	TArray<FVector> Normals;
-	TArray<FColor> Colors;
-	TArray<FVector2D> UVs;
+	TArray<FVoxelChunk> Chunks;
+	FIntVector NumChunks = FIntVector::ZeroValue;
+
+	//Bumped for every remesh, never reset so results from before a reload can't match
+	uint32 RemeshGeneration = 0;
+	//Filled by background remesh tasks, drained in Tick. Shared so tasks can outlive the actor.
+	TSharedRef<TQueue<TArray<FVoxelRemeshTask>, EQueueMode::Mpsc>, ESPMode::ThreadSafe> CompletedRemeshes =
+		MakeShared<TQueue<TArray<FVoxelRemeshTask>, EQueueMode::Mpsc>, ESPMode::ThreadSafe>();
+	//Input time of every edit still being remeshed, keyed by the last generation launched for it
+	TArray<TPair<uint32, double>> PendingEditLatency;
+
+	//Edits from MakeHole and the brushes with bQueueEdits, carved in FlushEdits
+	TArray<FVoxelQueuedEdit> QueuedEdits;
+	//Queues the voxel space brush, or applies it straight away without bQueueEdits
+	void QueueEdit(const FVoxelBrush& Brush, double InputTime);
+	FDelegateHandle PostActorTickHandle;
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	//Carves up to MaxEditsPerFrame queued edits and remeshes what they touched. Holds them all while a background
+	//load is running, FinishAsyncLoad flushes them.
+	void FlushEdits();
+	//Carves every edit, then remeshes the chunks they dirtied once
+	void ApplyEdits(TConstArrayView<FVoxelQueuedEdit> Edits);
 
 	//Original Stuff
 	TArray<FVector> OriginalVertices;
@@ -89,320 +392,75 @@ private:
 	TArray<int> OriginalIndices;
 
 
-	float ClosestTriangleDistance(const FVector& P);
-	bool IsInsideMesh(const FVector& P);
+	//Speeds up the signed distance queries. Shared by every actor using the same static mesh, until its render data
+	//is rebuilt.
+	TSharedPtr<const FTriangleBVH> TriangleBVH;
+	TSharedPtr<const FMeshPseudoNormals> PseudoNormals;
+
+	UPROPERTY(EditAnywhere, Category="Voxelization")
+	EVoxelSignMode SignMode = EVoxelSignMode::RayVoting;
+
+	//Classifies every voxel with both sign modes after the bake and logs how often they disagree
+	UPROPERTY(EditAnywhere, Category="Voxelization|Debug")
+	bool bCompareSignModes = false;
+
+	UPROPERTY(EditDefaultsOnly, Category="Voxelization")
+	bool bUseTriangleBVH = true;
+
+	//Bakes the voxels on worker threads, one Z slice per task. Off runs the same code on the game thread.
+	UPROPERTY(EditDefaultsOnly, Category="Voxelization")
+	bool bParallelVoxelize = true;
+
+	//Timings of the last bake, to compare the BVH against brute force
+	UPROPERTY(VisibleInstanceOnly, Category="Voxelization")
+	float BVHBuildMs = 0.f;
+	UPROPERTY(VisibleInstanceOnly, Category="Voxelization")
+	float VoxelizeMs = 0.f;
+	UPROPERTY(VisibleInstanceOnly, Category="Voxelization")
+	float AverageVoxelQueryUs = 0.f;
+
+	void BuildTriangleBVH(const UStaticMesh* StaticMesh);
+
+	//Queries over the source mesh triangles, with the BVH when bUseTriangleBVH
+	FMeshSignedDistance MakeSignedDistance() const;
+	void CompareSignModes(const FVector& StartPos) const;
 
 	//FVector GetVoxelWorldPosition(int ArrayIndex) const;
 	FVector GetVoxelWorldPosition(int X, int Y, int Z) const;
 
 	bool SaveVoxelsToFile(const FString& Filename);
 	bool LoadVoxelsFromFile(const FString& Filename);
+	//Starts reading and marching the file on a background task, Tick finishes it
+	void LoadVoxelsFromFileAsync(const FString& Filename);
+
+	bool IsPersistingEdits() const { return bPersistEdits && (ShouldLoad || ShouldSave); }
+	void RecordEdit(const FVoxelBrush& Brush, const FVoxelRegion& Edited);
+	//Queues the journal and snapshot writes whose interval is up, or all of them with bForce
+	void PersistEdits(bool bForce);
+
+	//Runs the journal and snapshot writes one after the other off the game thread
+	UE::Tasks::FPipe SaveQueue{ TEXT("VoxelSave") };
+	TArray<FVoxelEdit> PendingEdits;
+	//Every brick that differs from the voxel file
+	TSet<int32> ChangedBricks;
+	//The bricks changed since the last snapshot, the only ones copied for the next one
+	TSet<int32> SnapshotDirtyBricks;
+	//The last snapshot queued, only touched by tasks on SaveQueue, which merge the dirty bricks into it
+	TSharedRef<FVoxelBrickSnapshot> SavedSnapshot = MakeShared<FVoxelBrickSnapshot>();
+	uint32 EditSequence = 0;
+	uint32 SnapshotSequence = 0;
+	double LastJournalFlushTime = 0.0;
+	double LastSnapshotTime = 0.0;
+	void FinishAsyncLoad();
+
+	UE::Tasks::TTask<TSharedPtr<FVoxelLoadResult>> LoadTask;
+	double LoadStartTime = 0.0;
+	bool bStandInWasVisible = false;
 	
-	//the marching cube technique that we're trying to mimic requires a lot of data. We could remake it.
-	//We could also reinvent the wheel, but I think we have better things to do.
-	//information was pulled from
-	//https://gist.github.com/BLaZeKiLL/48de66d6d667f6062e30b38c4cb97536
-	//great walkthrough of the marching cube technique too!
-	
-#pragma region MarchingCubeData
-	const int VertexOffset[8][3] = {
-		{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
-		{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}
-	};
-
-	const int EdgeConnection[12][2] = {
-		{0, 1}, {1, 2}, {2, 3}, {3, 0},
-		{4, 5}, {5, 6}, {6, 7}, {7, 4},
-		{0, 4}, {1, 5}, {2, 6}, {3, 7}
-	};         
-
-	const float EdgeDirection[12][3] = {
-		{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
-		{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
-		{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}
-	};
-
-	const int CubeEdgeFlags[256] = {
-		0x000, 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c, 0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
-		0x190, 0x099, 0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c, 0x99c, 0x895, 0xb9f, 0xa96, 0xd9a, 0xc93, 0xf99, 0xe90,
-		0x230, 0x339, 0x033, 0x13a, 0x636, 0x73f, 0x435, 0x53c, 0xa3c, 0xb35, 0x83f, 0x936, 0xe3a, 0xf33, 0xc39, 0xd30,
-		0x3a0, 0x2a9, 0x1a3, 0x0aa, 0x7a6, 0x6af, 0x5a5, 0x4ac, 0xbac, 0xaa5, 0x9af, 0x8a6, 0xfaa, 0xea3, 0xda9, 0xca0,
-		0x460, 0x569, 0x663, 0x76a, 0x066, 0x16f, 0x265, 0x36c, 0xc6c, 0xd65, 0xe6f, 0xf66, 0x86a, 0x963, 0xa69, 0xb60,
-		0x5f0, 0x4f9, 0x7f3, 0x6fa, 0x1f6, 0x0ff, 0x3f5, 0x2fc, 0xdfc, 0xcf5, 0xfff, 0xef6, 0x9fa, 0x8f3, 0xbf9, 0xaf0,
-		0x650, 0x759, 0x453, 0x55a, 0x256, 0x35f, 0x055, 0x15c, 0xe5c, 0xf55, 0xc5f, 0xd56, 0xa5a, 0xb53, 0x859, 0x950,
-		0x7c0, 0x6c9, 0x5c3, 0x4ca, 0x3c6, 0x2cf, 0x1c5, 0x0cc, 0xfcc, 0xec5, 0xdcf, 0xcc6, 0xbca, 0xac3, 0x9c9, 0x8c0,
-		0x8c0, 0x9c9, 0xac3, 0xbca, 0xcc6, 0xdcf, 0xec5, 0xfcc, 0x0cc, 0x1c5, 0x2cf, 0x3c6, 0x4ca, 0x5c3, 0x6c9, 0x7c0,
-		0x950, 0x859, 0xb53, 0xa5a, 0xd56, 0xc5f, 0xf55, 0xe5c, 0x15c, 0x055, 0x35f, 0x256, 0x55a, 0x453, 0x759, 0x650,
-		0xaf0, 0xbf9, 0x8f3, 0x9fa, 0xef6, 0xfff, 0xcf5, 0xdfc, 0x2fc, 0x3f5, 0x0ff, 0x1f6, 0x6fa, 0x7f3, 0x4f9, 0x5f0,
-		0xb60, 0xa69, 0x963, 0x86a, 0xf66, 0xe6f, 0xd65, 0xc6c, 0x36c, 0x265, 0x16f, 0x066, 0x76a, 0x663, 0x569, 0x460,
-		0xca0, 0xda9, 0xea3, 0xfaa, 0x8a6, 0x9af, 0xaa5, 0xbac, 0x4ac, 0x5a5, 0x6af, 0x7a6, 0x0aa, 0x1a3, 0x2a9, 0x3a0,
-		0xd30, 0xc39, 0xf33, 0xe3a, 0x936, 0x83f, 0xb35, 0xa3c, 0x53c, 0x435, 0x73f, 0x636, 0x13a, 0x033, 0x339, 0x230,
-		0xe90, 0xf99, 0xc93, 0xd9a, 0xa96, 0xb9f, 0x895, 0x99c, 0x69c, 0x795, 0x49f, 0x596, 0x29a, 0x393, 0x099, 0x190,
-		0xf00, 0xe09, 0xd03, 0xc0a, 0xb06, 0xa0f, 0x905, 0x80c, 0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x000
-	};
-
-	const int TriangleConnectionTable[256][16] = {
-		{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 8, 3, 9, 8, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 3, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{9, 2, 10, 0, 2, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{2, 8, 3, 2, 10, 8, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1},
-		{3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 11, 2, 8, 11, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 9, 0, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 11, 2, 1, 9, 11, 9, 8, 11, -1, -1, -1, -1, -1, -1, -1},
-		{3, 10, 1, 11, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 10, 1, 0, 8, 10, 8, 11, 10, -1, -1, -1, -1, -1, -1, -1},
-		{3, 9, 0, 3, 11, 9, 11, 10, 9, -1, -1, -1, -1, -1, -1, -1},
-		{9, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 3, 0, 7, 3, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 1, 9, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 1, 9, 4, 7, 1, 7, 3, 1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 10, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{3, 4, 7, 3, 0, 4, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1},
-		{9, 2, 10, 9, 0, 2, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
-		{2, 10, 9, 2, 9, 7, 2, 7, 3, 7, 9, 4, -1, -1, -1, -1},
-		{8, 4, 7, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{11, 4, 7, 11, 2, 4, 2, 0, 4, -1, -1, -1, -1, -1, -1, -1},
-		{9, 0, 1, 8, 4, 7, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
-		{4, 7, 11, 9, 4, 11, 9, 11, 2, 9, 2, 1, -1, -1, -1, -1},
-		{3, 10, 1, 3, 11, 10, 7, 8, 4, -1, -1, -1, -1, -1, -1, -1},
-		{1, 11, 10, 1, 4, 11, 1, 0, 4, 7, 11, 4, -1, -1, -1, -1},
-		{4, 7, 8, 9, 0, 11, 9, 11, 10, 11, 0, 3, -1, -1, -1, -1},
-		{4, 7, 11, 4, 11, 9, 9, 11, 10, -1, -1, -1, -1, -1, -1, -1},
-		{9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{9, 5, 4, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 5, 4, 1, 5, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{8, 5, 4, 8, 3, 5, 3, 1, 5, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 10, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{3, 0, 8, 1, 2, 10, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
-		{5, 2, 10, 5, 4, 2, 4, 0, 2, -1, -1, -1, -1, -1, -1, -1},
-		{2, 10, 5, 3, 2, 5, 3, 5, 4, 3, 4, 8, -1, -1, -1, -1},
-		{9, 5, 4, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 11, 2, 0, 8, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
-		{0, 5, 4, 0, 1, 5, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
-		{2, 1, 5, 2, 5, 8, 2, 8, 11, 4, 8, 5, -1, -1, -1, -1},
-		{10, 3, 11, 10, 1, 3, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1},
-		{4, 9, 5, 0, 8, 1, 8, 10, 1, 8, 11, 10, -1, -1, -1, -1},
-		{5, 4, 0, 5, 0, 11, 5, 11, 10, 11, 0, 3, -1, -1, -1, -1},
-		{5, 4, 8, 5, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1},
-		{9, 7, 8, 5, 7, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{9, 3, 0, 9, 5, 3, 5, 7, 3, -1, -1, -1, -1, -1, -1, -1},
-		{0, 7, 8, 0, 1, 7, 1, 5, 7, -1, -1, -1, -1, -1, -1, -1},
-		{1, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{9, 7, 8, 9, 5, 7, 10, 1, 2, -1, -1, -1, -1, -1, -1, -1},
-		{10, 1, 2, 9, 5, 0, 5, 3, 0, 5, 7, 3, -1, -1, -1, -1},
-		{8, 0, 2, 8, 2, 5, 8, 5, 7, 10, 5, 2, -1, -1, -1, -1},
-		{2, 10, 5, 2, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1},
-		{7, 9, 5, 7, 8, 9, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1},
-		{9, 5, 7, 9, 7, 2, 9, 2, 0, 2, 7, 11, -1, -1, -1, -1},
-		{2, 3, 11, 0, 1, 8, 1, 7, 8, 1, 5, 7, -1, -1, -1, -1},
-		{11, 2, 1, 11, 1, 7, 7, 1, 5, -1, -1, -1, -1, -1, -1, -1},
-		{9, 5, 8, 8, 5, 7, 10, 1, 3, 10, 3, 11, -1, -1, -1, -1},
-		{5, 7, 0, 5, 0, 9, 7, 11, 0, 1, 0, 10, 11, 10, 0, -1},
-		{11, 10, 0, 11, 0, 3, 10, 5, 0, 8, 0, 7, 5, 7, 0, -1},
-		{11, 10, 5, 7, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{9, 0, 1, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 8, 3, 1, 9, 8, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
-		{1, 6, 5, 2, 6, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 6, 5, 1, 2, 6, 3, 0, 8, -1, -1, -1, -1, -1, -1, -1},
-		{9, 6, 5, 9, 0, 6, 0, 2, 6, -1, -1, -1, -1, -1, -1, -1},
-		{5, 9, 8, 5, 8, 2, 5, 2, 6, 3, 2, 8, -1, -1, -1, -1},
-		{2, 3, 11, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{11, 0, 8, 11, 2, 0, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
-		{0, 1, 9, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
-		{5, 10, 6, 1, 9, 2, 9, 11, 2, 9, 8, 11, -1, -1, -1, -1},
-		{6, 3, 11, 6, 5, 3, 5, 1, 3, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 11, 0, 11, 5, 0, 5, 1, 5, 11, 6, -1, -1, -1, -1},
-		{3, 11, 6, 0, 3, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1},
-		{6, 5, 9, 6, 9, 11, 11, 9, 8, -1, -1, -1, -1, -1, -1, -1},
-		{5, 10, 6, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 3, 0, 4, 7, 3, 6, 5, 10, -1, -1, -1, -1, -1, -1, -1},
-		{1, 9, 0, 5, 10, 6, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
-		{10, 6, 5, 1, 9, 7, 1, 7, 3, 7, 9, 4, -1, -1, -1, -1},
-		{6, 1, 2, 6, 5, 1, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 5, 5, 2, 6, 3, 0, 4, 3, 4, 7, -1, -1, -1, -1},
-		{8, 4, 7, 9, 0, 5, 0, 6, 5, 0, 2, 6, -1, -1, -1, -1},
-		{7, 3, 9, 7, 9, 4, 3, 2, 9, 5, 9, 6, 2, 6, 9, -1},
-		{3, 11, 2, 7, 8, 4, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
-		{5, 10, 6, 4, 7, 2, 4, 2, 0, 2, 7, 11, -1, -1, -1, -1},
-		{0, 1, 9, 4, 7, 8, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1},
-		{9, 2, 1, 9, 11, 2, 9, 4, 11, 7, 11, 4, 5, 10, 6, -1},
-		{8, 4, 7, 3, 11, 5, 3, 5, 1, 5, 11, 6, -1, -1, -1, -1},
-		{5, 1, 11, 5, 11, 6, 1, 0, 11, 7, 11, 4, 0, 4, 11, -1},
-		{0, 5, 9, 0, 6, 5, 0, 3, 6, 11, 6, 3, 8, 4, 7, -1},
-		{6, 5, 9, 6, 9, 11, 4, 7, 9, 7, 11, 9, -1, -1, -1, -1},
-		{10, 4, 9, 6, 4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 10, 6, 4, 9, 10, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1},
-		{10, 0, 1, 10, 6, 0, 6, 4, 0, -1, -1, -1, -1, -1, -1, -1},
-		{8, 3, 1, 8, 1, 6, 8, 6, 4, 6, 1, 10, -1, -1, -1, -1},
-		{1, 4, 9, 1, 2, 4, 2, 6, 4, -1, -1, -1, -1, -1, -1, -1},
-		{3, 0, 8, 1, 2, 9, 2, 4, 9, 2, 6, 4, -1, -1, -1, -1},
-		{0, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{8, 3, 2, 8, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1},
-		{10, 4, 9, 10, 6, 4, 11, 2, 3, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 2, 2, 8, 11, 4, 9, 10, 4, 10, 6, -1, -1, -1, -1},
-		{3, 11, 2, 0, 1, 6, 0, 6, 4, 6, 1, 10, -1, -1, -1, -1},
-		{6, 4, 1, 6, 1, 10, 4, 8, 1, 2, 1, 11, 8, 11, 1, -1},
-		{9, 6, 4, 9, 3, 6, 9, 1, 3, 11, 6, 3, -1, -1, -1, -1},
-		{8, 11, 1, 8, 1, 0, 11, 6, 1, 9, 1, 4, 6, 4, 1, -1},
-		{3, 11, 6, 3, 6, 0, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1},
-		{6, 4, 8, 11, 6, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{7, 10, 6, 7, 8, 10, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1},
-		{0, 7, 3, 0, 10, 7, 0, 9, 10, 6, 7, 10, -1, -1, -1, -1},
-		{10, 6, 7, 1, 10, 7, 1, 7, 8, 1, 8, 0, -1, -1, -1, -1},
-		{10, 6, 7, 10, 7, 1, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 6, 1, 6, 8, 1, 8, 9, 8, 6, 7, -1, -1, -1, -1},
-		{2, 6, 9, 2, 9, 1, 6, 7, 9, 0, 9, 3, 7, 3, 9, -1},
-		{7, 8, 0, 7, 0, 6, 6, 0, 2, -1, -1, -1, -1, -1, -1, -1},
-		{7, 3, 2, 6, 7, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{2, 3, 11, 10, 6, 8, 10, 8, 9, 8, 6, 7, -1, -1, -1, -1},
-		{2, 0, 7, 2, 7, 11, 0, 9, 7, 6, 7, 10, 9, 10, 7, -1},
-		{1, 8, 0, 1, 7, 8, 1, 10, 7, 6, 7, 10, 2, 3, 11, -1},
-		{11, 2, 1, 11, 1, 7, 10, 6, 1, 6, 7, 1, -1, -1, -1, -1},
-		{8, 9, 6, 8, 6, 7, 9, 1, 6, 11, 6, 3, 1, 3, 6, -1},
-		{0, 9, 1, 11, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{7, 8, 0, 7, 0, 6, 3, 11, 0, 11, 6, 0, -1, -1, -1, -1},
-		{7, 11, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{3, 0, 8, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 1, 9, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{8, 1, 9, 8, 3, 1, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
-		{10, 1, 2, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 10, 3, 0, 8, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
-		{2, 9, 0, 2, 10, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
-		{6, 11, 7, 2, 10, 3, 10, 8, 3, 10, 9, 8, -1, -1, -1, -1},
-		{7, 2, 3, 6, 2, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{7, 0, 8, 7, 6, 0, 6, 2, 0, -1, -1, -1, -1, -1, -1, -1},
-		{2, 7, 6, 2, 3, 7, 0, 1, 9, -1, -1, -1, -1, -1, -1, -1},
-		{1, 6, 2, 1, 8, 6, 1, 9, 8, 8, 7, 6, -1, -1, -1, -1},
-		{10, 7, 6, 10, 1, 7, 1, 3, 7, -1, -1, -1, -1, -1, -1, -1},
-		{10, 7, 6, 1, 7, 10, 1, 8, 7, 1, 0, 8, -1, -1, -1, -1},
-		{0, 3, 7, 0, 7, 10, 0, 10, 9, 6, 10, 7, -1, -1, -1, -1},
-		{7, 6, 10, 7, 10, 8, 8, 10, 9, -1, -1, -1, -1, -1, -1, -1},
-		{6, 8, 4, 11, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{3, 6, 11, 3, 0, 6, 0, 4, 6, -1, -1, -1, -1, -1, -1, -1},
-		{8, 6, 11, 8, 4, 6, 9, 0, 1, -1, -1, -1, -1, -1, -1, -1},
-		{9, 4, 6, 9, 6, 3, 9, 3, 1, 11, 3, 6, -1, -1, -1, -1},
-		{6, 8, 4, 6, 11, 8, 2, 10, 1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 10, 3, 0, 11, 0, 6, 11, 0, 4, 6, -1, -1, -1, -1},
-		{4, 11, 8, 4, 6, 11, 0, 2, 9, 2, 10, 9, -1, -1, -1, -1},
-		{10, 9, 3, 10, 3, 2, 9, 4, 3, 11, 3, 6, 4, 6, 3, -1},
-		{8, 2, 3, 8, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1},
-		{0, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 9, 0, 2, 3, 4, 2, 4, 6, 4, 3, 8, -1, -1, -1, -1},
-		{1, 9, 4, 1, 4, 2, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1},
-		{8, 1, 3, 8, 6, 1, 8, 4, 6, 6, 10, 1, -1, -1, -1, -1},
-		{10, 1, 0, 10, 0, 6, 6, 0, 4, -1, -1, -1, -1, -1, -1, -1},
-		{4, 6, 3, 4, 3, 8, 6, 10, 3, 0, 3, 9, 10, 9, 3, -1},
-		{10, 9, 4, 6, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 9, 5, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 3, 4, 9, 5, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
-		{5, 0, 1, 5, 4, 0, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
-		{11, 7, 6, 8, 3, 4, 3, 5, 4, 3, 1, 5, -1, -1, -1, -1},
-		{9, 5, 4, 10, 1, 2, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
-		{6, 11, 7, 1, 2, 10, 0, 8, 3, 4, 9, 5, -1, -1, -1, -1},
-		{7, 6, 11, 5, 4, 10, 4, 2, 10, 4, 0, 2, -1, -1, -1, -1},
-		{3, 4, 8, 3, 5, 4, 3, 2, 5, 10, 5, 2, 11, 7, 6, -1},
-		{7, 2, 3, 7, 6, 2, 5, 4, 9, -1, -1, -1, -1, -1, -1, -1},
-		{9, 5, 4, 0, 8, 6, 0, 6, 2, 6, 8, 7, -1, -1, -1, -1},
-		{3, 6, 2, 3, 7, 6, 1, 5, 0, 5, 4, 0, -1, -1, -1, -1},
-		{6, 2, 8, 6, 8, 7, 2, 1, 8, 4, 8, 5, 1, 5, 8, -1},
-		{9, 5, 4, 10, 1, 6, 1, 7, 6, 1, 3, 7, -1, -1, -1, -1},
-		{1, 6, 10, 1, 7, 6, 1, 0, 7, 8, 7, 0, 9, 5, 4, -1},
-		{4, 0, 10, 4, 10, 5, 0, 3, 10, 6, 10, 7, 3, 7, 10, -1},
-		{7, 6, 10, 7, 10, 8, 5, 4, 10, 4, 8, 10, -1, -1, -1, -1},
-		{6, 9, 5, 6, 11, 9, 11, 8, 9, -1, -1, -1, -1, -1, -1, -1},
-		{3, 6, 11, 0, 6, 3, 0, 5, 6, 0, 9, 5, -1, -1, -1, -1},
-		{0, 11, 8, 0, 5, 11, 0, 1, 5, 5, 6, 11, -1, -1, -1, -1},
-		{6, 11, 3, 6, 3, 5, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 10, 9, 5, 11, 9, 11, 8, 11, 5, 6, -1, -1, -1, -1},
-		{0, 11, 3, 0, 6, 11, 0, 9, 6, 5, 6, 9, 1, 2, 10, -1},
-		{11, 8, 5, 11, 5, 6, 8, 0, 5, 10, 5, 2, 0, 2, 5, -1},
-		{6, 11, 3, 6, 3, 5, 2, 10, 3, 10, 5, 3, -1, -1, -1, -1},
-		{5, 8, 9, 5, 2, 8, 5, 6, 2, 3, 8, 2, -1, -1, -1, -1},
-		{9, 5, 6, 9, 6, 0, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1},
-		{1, 5, 8, 1, 8, 0, 5, 6, 8, 3, 8, 2, 6, 2, 8, -1},
-		{1, 5, 6, 2, 1, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 3, 6, 1, 6, 10, 3, 8, 6, 5, 6, 9, 8, 9, 6, -1},
-		{10, 1, 0, 10, 0, 6, 9, 5, 0, 5, 6, 0, -1, -1, -1, -1},
-		{0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{10, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{11, 5, 10, 7, 5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{11, 5, 10, 11, 7, 5, 8, 3, 0, -1, -1, -1, -1, -1, -1, -1},
-		{5, 11, 7, 5, 10, 11, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1},
-		{10, 7, 5, 10, 11, 7, 9, 8, 1, 8, 3, 1, -1, -1, -1, -1},
-		{11, 1, 2, 11, 7, 1, 7, 5, 1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 3, 1, 2, 7, 1, 7, 5, 7, 2, 11, -1, -1, -1, -1},
-		{9, 7, 5, 9, 2, 7, 9, 0, 2, 2, 11, 7, -1, -1, -1, -1},
-		{7, 5, 2, 7, 2, 11, 5, 9, 2, 3, 2, 8, 9, 8, 2, -1},
-		{2, 5, 10, 2, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1},
-		{8, 2, 0, 8, 5, 2, 8, 7, 5, 10, 2, 5, -1, -1, -1, -1},
-		{9, 0, 1, 5, 10, 3, 5, 3, 7, 3, 10, 2, -1, -1, -1, -1},
-		{9, 8, 2, 9, 2, 1, 8, 7, 2, 10, 2, 5, 7, 5, 2, -1},
-		{1, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 7, 0, 7, 1, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1},
-		{9, 0, 3, 9, 3, 5, 5, 3, 7, -1, -1, -1, -1, -1, -1, -1},
-		{9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{5, 8, 4, 5, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1},
-		{5, 0, 4, 5, 11, 0, 5, 10, 11, 11, 3, 0, -1, -1, -1, -1},
-		{0, 1, 9, 8, 4, 10, 8, 10, 11, 10, 4, 5, -1, -1, -1, -1},
-		{10, 11, 4, 10, 4, 5, 11, 3, 4, 9, 4, 1, 3, 1, 4, -1},
-		{2, 5, 1, 2, 8, 5, 2, 11, 8, 4, 5, 8, -1, -1, -1, -1},
-		{0, 4, 11, 0, 11, 3, 4, 5, 11, 2, 11, 1, 5, 1, 11, -1},
-		{0, 2, 5, 0, 5, 9, 2, 11, 5, 4, 5, 8, 11, 8, 5, -1},
-		{9, 4, 5, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{2, 5, 10, 3, 5, 2, 3, 4, 5, 3, 8, 4, -1, -1, -1, -1},
-		{5, 10, 2, 5, 2, 4, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
-		{3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, -1},
-		{5, 10, 2, 5, 2, 4, 1, 9, 2, 9, 4, 2, -1, -1, -1, -1},
-		{8, 4, 5, 8, 5, 3, 3, 5, 1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 4, 5, 1, 0, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{8, 4, 5, 8, 5, 3, 9, 0, 5, 0, 3, 5, -1, -1, -1, -1},
-		{9, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 11, 7, 4, 9, 11, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1},
-		{0, 8, 3, 4, 9, 7, 9, 11, 7, 9, 10, 11, -1, -1, -1, -1},
-		{1, 10, 11, 1, 11, 4, 1, 4, 0, 7, 4, 11, -1, -1, -1, -1},
-		{3, 1, 4, 3, 4, 8, 1, 10, 4, 7, 4, 11, 10, 11, 4, -1},
-		{4, 11, 7, 9, 11, 4, 9, 2, 11, 9, 1, 2, -1, -1, -1, -1},
-		{9, 7, 4, 9, 11, 7, 9, 1, 11, 2, 11, 1, 0, 8, 3, -1},
-		{11, 7, 4, 11, 4, 2, 2, 4, 0, -1, -1, -1, -1, -1, -1, -1},
-		{11, 7, 4, 11, 4, 2, 8, 3, 4, 3, 2, 4, -1, -1, -1, -1},
-		{2, 9, 10, 2, 7, 9, 2, 3, 7, 7, 4, 9, -1, -1, -1, -1},
-		{9, 10, 7, 9, 7, 4, 10, 2, 7, 8, 7, 0, 2, 0, 7, -1},
-		{3, 7, 10, 3, 10, 2, 7, 4, 10, 1, 10, 0, 4, 0, 10, -1},
-		{1, 10, 2, 8, 7, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 9, 1, 4, 1, 7, 7, 1, 3, -1, -1, -1, -1, -1, -1, -1},
-		{4, 9, 1, 4, 1, 7, 0, 8, 1, 8, 7, 1, -1, -1, -1, -1},
-		{4, 0, 3, 7, 4, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{9, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{3, 0, 9, 3, 9, 11, 11, 9, 10, -1, -1, -1, -1, -1, -1, -1},
-		{0, 1, 10, 0, 10, 8, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1},
-		{3, 1, 10, 11, 3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 2, 11, 1, 11, 9, 9, 11, 8, -1, -1, -1, -1, -1, -1, -1},
-		{3, 0, 9, 3, 9, 11, 1, 2, 9, 2, 11, 9, -1, -1, -1, -1},
-		{0, 2, 11, 8, 0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{3, 2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{2, 3, 8, 2, 8, 10, 10, 8, 9, -1, -1, -1, -1, -1, -1, -1},
-		{9, 10, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{2, 3, 8, 2, 8, 10, 0, 1, 8, 1, 10, 8, -1, -1, -1, -1},
-		{1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{1, 3, 8, 9, 1, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-		{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}
-	};
-#pragma endregion
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	//Called before begin play
 	virtual void PostInitializeComponents() override;
@@ -0,0 +1,386 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Headless benchmark of the voxel pipeline: bake, mesh, upload, holes, save and load on synthetic shapes.
+//Run with -nullrhi -unattended -ExecCmds="Automation RunTests BrokenBronze.Voxel.Bench; Quit", one case per shape and
+//grid size, each writing its results to Saved/Benchmarks as JSON.
+
+#include "MarchingCubeObject.h"
+#include "VoxelFile.h"
+#include "VoxelMesher.h"
+#include "VoxelStats.h"
+#include "VoxelStore.h"
+#include "VoxelTestShapes.h"
+#include "ProceduralMeshComponent.h"
+#include "Dom/JsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace
+{
+	constexpr int32 BenchIterations = 5;
+	constexpr int32 BenchHolesPerCase = 50;
+
+	//Dense voxels of the shape on a Size^3 grid, X rows first, sampled the way GenerateData samples the mesh
+	void BakeShape(EVoxelTestShape Shape, int32 Size, TArray<float>& Out)
+	{
+		AMarchingCubeObject::BakeDense(FIntVector(Size), [Shape, Size](int32 X, int32 Y, int32 Z)
+		{
+			return SampleTestShape(Shape, FVector(X, Y, Z), Size);
+		}, true, Out);
+	}
+
+	int64 GetAllocatedSize(const TArray<FVoxelMeshBuffers>& Buffers)
+	{
+		int64 Bytes = Buffers.GetAllocatedSize();
+		for (const FVoxelMeshBuffers& Buffer : Buffers)
+		{
+			Bytes += Buffer.Vertices.GetAllocatedSize() + Buffer.Triangles.GetAllocatedSize() + Buffer.Normals.GetAllocatedSize()
+				+ Buffer.Colors.GetAllocatedSize() + Buffer.UVs.GetAllocatedSize();
+		}
+		return Bytes;
+	}
+
+	struct FBenchStage
+	{
+		FString Name;
+		TArray<double> Ms;
+		//The process peak only grows, so a stage's peak is how far it pushed it past where it stood when the stage
+		//started. A stage staying under an earlier stage's peak reports 0, AllocatedBytes still says what it built.
+		uint64 PeakAtStart = 0;
+		int64 PeakBytes = 0;
+		//Held by the stage's output (store, mesh buffers, sections or file), set once it has run
+		int64 AllocatedBytes = 0;
+
+		explicit FBenchStage(const TCHAR* InName)
+			: Name(InName)
+			, PeakAtStart(FPlatformMemory::GetStats().PeakUsedPhysical)
+		{
+		}
+
+		void Add(double Seconds)
+		{
+			Ms.Add(Seconds * 1000.0);
+			PeakBytes = FMath::Max<int64>(PeakBytes, int64(FPlatformMemory::GetStats().PeakUsedPhysical - PeakAtStart));
+		}
+
+		static double Percentile(const TArray<double>& Sorted, double Fraction)
+		{
+			const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+			return Sorted[Index];
+		}
+
+		TSharedRef<FJsonObject> ToJson() const
+		{
+			TArray<double> Sorted = Ms;
+			Sorted.Sort();
+			TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetStringField(TEXT("Stage"), Name);
+			Json->SetNumberField(TEXT("Samples"), Sorted.Num());
+			Json->SetNumberField(TEXT("MedianMs"), Sorted.IsEmpty() ? 0.0 : Percentile(Sorted, 0.5));
+			Json->SetNumberField(TEXT("P99Ms"), Sorted.IsEmpty() ? 0.0 : Percentile(Sorted, 0.99));
+			Json->SetNumberField(TEXT("PeakMemoryDeltaMB"), PeakBytes / (1024.0 * 1024.0));
+			Json->SetNumberField(TEXT("AllocatedMB"), AllocatedBytes / (1024.0 * 1024.0));
+			return Json;
+		}
+	};
+
+	TSharedRef<FJsonObject> RunCase(EVoxelTestShape Shape, int32 Size, int32 Iterations, int32 NumHoles)
+	{
+		const int32 Dim = Size + 1;
+		const FIntVector Dims(Dim);
+		FVoxelMeshSettings Settings;
+		Settings.SurfaceLevel = TestSurfaceLevel;
+		Settings.VoxelSize = TestVoxelSize;
+
+		FVoxelStore Store;
+		TArray<float> Dense;
+		TArray<FVoxelMeshBuffers> Buffers;
+		TArray<FVoxelMesher::FJob> Jobs;
+		int32 Triangles = 0;
+		int64 FileBytes = 0;
+
+		// GenerateData's bake and brick conversion, sampling the shape instead of the mesh's BVH
+		FBenchStage Bake(TEXT("Bake"));
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			BakeShape(Shape, Size, Dense);
+			Store.FromDense(Dims, Dense, TestSurfaceLevel);
+			Bake.Add(FPlatformTime::Seconds() - StartTime);
+		}
+		Bake.AllocatedBytes = Store.GetAllocatedSize() + Dense.GetAllocatedSize();
+
+		FBenchStage Mesh(TEXT("GenerateMesh"));
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			MakeTestChunkJobs(Size, TestChunkSize, Buffers, Jobs);
+			Store.ToDense(Dense);
+			FVoxelMesher(Settings, MakeTestView(Dense, FIntVector::ZeroValue, Dims, Store)).MeshJobs(Jobs, true);
+			Mesh.Add(FPlatformTime::Seconds() - StartTime);
+		}
+		Mesh.AllocatedBytes = GetAllocatedSize(Buffers) + Dense.GetAllocatedSize();
+		for (const FVoxelMeshBuffers& Buffer : Buffers)
+		{
+			Triangles += Buffer.Triangles.Num() / 3;
+		}
+
+		// Not registered, so this is the section copy ApplyMesh pays without the render thread upload
+		FBenchStage Upload(TEXT("ApplyMesh"));
+		TStrongObjectPtr<UProceduralMeshComponent> Component(NewObject<UProceduralMeshComponent>(GetTransientPackage()));
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Section = 0; Section < Buffers.Num(); ++Section)
+			{
+				const FVoxelMeshBuffers& Data = Buffers[Section];
+				Component->CreateMeshSection(Section, Data.Vertices, Data.Triangles, Data.Normals, Data.UVs, Data.Colors, TArray<FProcMeshTangent>(), false);
+			}
+			Upload.Add(FPlatformTime::Seconds() - StartTime);
+			Upload.AllocatedBytes = 0;
+			for (int32 Section = 0; Section < Component->GetNumSections(); ++Section)
+			{
+				const FProcMeshSection* MeshSection = Component->GetProcMeshSection(Section);
+				Upload.AllocatedBytes += MeshSection->ProcVertexBuffer.GetAllocatedSize() + MeshSection->ProcIndexBuffer.GetAllocatedSize();
+			}
+			Component->ClearAllMeshSections();
+		}
+
+		// Scripted shots along the surface with a fixed seed, each carving and remeshing its chunks like MakeHole
+		FBenchStage Holes(TEXT("MakeHole"));
+		FRandomStream Random(Size * 31 + int32(Shape));
+		for (int32 i = 0; i < NumHoles; ++i)
+		{
+			const FVector Direction = Random.GetUnitVector();
+			const FVector Center = FVector(Size * 0.5) + Direction * Size * Random.FRandRange(0.25f, 0.4f);
+			const float Radius = FMath::Max(Size / 16.f, 2.f);
+
+			const double StartTime = FPlatformTime::Seconds();
+			const FVoxelRegion Edited = Store.CarveSphere(Center, Radius, -TestVoxelSize * 2);
+			if (!Edited.IsEmpty())
+			{
+				// The chunks MarkChunksDirty flags for the edit
+				FIntVector ChunkMin;
+				FIntVector ChunkMax;
+				AMarchingCubeObject::GetChunkRange(Edited.Min, Edited.Max, TestChunkSize, FIntVector(FMath::DivideAndRoundUp(Size, TestChunkSize)), ChunkMin, ChunkMax);
+				const FIntVector SnapshotMin = ChunkMin * TestChunkSize;
+				const FIntVector SnapshotMax = ((ChunkMax + FIntVector(1)) * TestChunkSize).ComponentMin(FIntVector(Size));
+
+				TArray<FVoxelMeshBuffers> HoleBuffers;
+				HoleBuffers.SetNum((ChunkMax.X - ChunkMin.X + 1) * (ChunkMax.Y - ChunkMin.Y + 1) * (ChunkMax.Z - ChunkMin.Z + 1));
+				TArray<FVoxelMesher::FJob> HoleJobs;
+				for (int32 CZ = ChunkMin.Z; CZ <= ChunkMax.Z; ++CZ)
+				{
+					for (int32 CY = ChunkMin.Y; CY <= ChunkMax.Y; ++CY)
+					{
+						for (int32 CX = ChunkMin.X; CX <= ChunkMax.X; ++CX)
+						{
+							const FIntVector CellMin = FIntVector(CX, CY, CZ) * TestChunkSize;
+							const FIntVector CellMax = (CellMin + FIntVector(TestChunkSize)).ComponentMin(FIntVector(Size));
+							if (Store.MayContainSurface(CellMin, CellMax - FIntVector(1)))
+							{
+								HoleJobs.Add({ CellMin, CellMax, &HoleBuffers[HoleJobs.Num()] });
+							}
+						}
+					}
+				}
+				TArray<float> Snapshot;
+				Store.CopyBox(SnapshotMin, SnapshotMax, Snapshot);
+				FVoxelMesher(Settings, MakeTestView(Snapshot, SnapshotMin, SnapshotMax - SnapshotMin + FIntVector(1), Store)).MeshJobs(HoleJobs, true);
+			}
+			Holes.Add(FPlatformTime::Seconds() - StartTime);
+		}
+		Holes.AllocatedBytes = Store.GetAllocatedSize();
+
+		const FString FilePath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("Bench_%s_%d.voxel"), GetTestShapeName(Shape), Size);
+		FBenchStage Save(TEXT("SaveVoxelsToFile"));
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			FVoxelFileData Data;
+			Data.SizeX = Data.SizeY = Data.SizeZ = Size;
+			Data.VoxelSize = TestVoxelSize;
+			Store.ToDense(Data.Voxels);
+			TArray<uint8> FileData;
+			FVoxelFile::Write(Data, TestSurfaceLevel, 0.f, FileData);
+			FFileHelper::SaveArrayToFile(FileData, *FilePath);
+			FileBytes = FileData.Num();
+			Save.Add(FPlatformTime::Seconds() - StartTime);
+			Save.AllocatedBytes = Data.Voxels.GetAllocatedSize() + FileData.GetAllocatedSize();
+		}
+
+		FBenchStage Load(TEXT("LoadVoxelsFromFile"));
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			FVoxelFileData Data;
+			if (FVoxelFile::ReadFile(*FilePath, Data))
+			{
+				FVoxelStore Loaded;
+				Loaded.FromDense(FIntVector(Data.SizeX + 1, Data.SizeY + 1, Data.SizeZ + 1), Data.Voxels, TestSurfaceLevel);
+				Load.AllocatedBytes = Loaded.GetAllocatedSize();
+			}
+			Load.Add(FPlatformTime::Seconds() - StartTime);
+		}
+		IFileManager::Get().Delete(*FilePath);
+
+		TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetStringField(TEXT("Shape"), GetTestShapeName(Shape));
+		Json->SetNumberField(TEXT("GridSize"), Size);
+		Json->SetNumberField(TEXT("Triangles"), Triangles);
+		Json->SetNumberField(TEXT("StoreKB"), Store.GetAllocatedSize() / 1024.0);
+		Json->SetNumberField(TEXT("DenseBricks"), Store.NumDenseBricks());
+		Json->SetNumberField(TEXT("FileKB"), FileBytes / 1024.0);
+		TArray<TSharedPtr<FJsonValue>> Stages;
+		for (const FBenchStage* Stage : { &Bake, &Mesh, &Upload, &Holes, &Save, &Load })
+		{
+			const TSharedRef<FJsonObject> StageJson = Stage->ToJson();
+			Stages.Add(MakeShared<FJsonValueObject>(StageJson));
+			UE_LOG(LogVoxel, Display, TEXT("Voxel.Bench %s %d^3 %s: median %.2f ms, p99 %.2f ms"), GetTestShapeName(Shape), Size, *Stage->Name,
+				StageJson->GetNumberField(TEXT("MedianMs")), StageJson->GetNumberField(TEXT("P99Ms")));
+		}
+		Json->SetArrayField(TEXT("Stages"), Stages);
+		return Json;
+	}
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FVoxelBenchTest, "BrokenBronze.Voxel.Bench", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FVoxelBenchTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (int32 Size = 32; Size <= 256; Size *= 2)
+	{
+		for (EVoxelTestShape Shape : { EVoxelTestShape::Sphere, EVoxelTestShape::Box, EVoxelTestShape::Wall })
+		{
+			OutBeautifiedNames.Add(FString::Printf(TEXT("%s %d"), GetTestShapeName(Shape), Size));
+			OutTestCommands.Add(FString::Printf(TEXT("%d %d"), int32(Shape), Size));
+		}
+	}
+}
+
+bool FVoxelBenchTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Args;
+	Parameters.ParseIntoArrayWS(Args);
+	if (!TestEqual(TEXT("Test command arguments"), Args.Num(), 2))
+	{
+		return false;
+	}
+	const EVoxelTestShape Shape = EVoxelTestShape(FCString::Atoi(*Args[0]));
+	const int32 Size = FCString::Atoi(*Args[1]);
+
+	const TSharedRef<FJsonObject> Case = RunCase(Shape, Size, BenchIterations, BenchHolesPerCase);
+	TestTrue(TEXT("Shape meshed to triangles"), Case->GetNumberField(TEXT("Triangles")) > 0);
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Report->SetStringField(TEXT("Platform"), FString(FPlatformProperties::IniPlatformName()));
+	Report->SetStringField(TEXT("CPU"), FPlatformMisc::GetCPUBrand());
+	Report->SetNumberField(TEXT("Cores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	Report->SetNumberField(TEXT("Iterations"), BenchIterations);
+	Report->SetNumberField(TEXT("HolesPerCase"), BenchHolesPerCase);
+	Report->SetArrayField(TEXT("Cases"), { MakeShared<FJsonValueObject>(Case) });
+
+	FString Output;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	FJsonSerializer::Serialize(Report, Writer);
+	const FString ReportPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks")
+		/ FString::Printf(TEXT("VoxelBench-%s-%d-%s.json"), GetTestShapeName(Shape), Size, *FDateTime::UtcNow().ToString());
+	if (!TestTrue(FString::Printf(TEXT("Wrote %s"), *ReportPath), FFileHelper::SaveStringToFile(Output, *ReportPath)))
+	{
+		return false;
+	}
+	UE_LOG(LogVoxel, Display, TEXT("Voxel.Bench wrote %s"), *ReportPath);
+	return true;
+}
+
+#endif
+
+//Marching cubes against Surface Nets on the same voxels, run with -nullrhi -ExecCmds="Voxel.BenchMeshers 128"
+static FAutoConsoleCommand BenchMeshersCommand(
+	TEXT("Voxel.BenchMeshers"),
+	TEXT("Meshes the synthetic shapes on a Size^3 grid (default 128) with marching cubes and Surface Nets, with and without simplification, ")
+	TEXT("logs triangles, vertices, extraction time and collision cook time of each."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 16, 256) : 128;
+		const int32 Dim = Size + 1;
+		struct FMesherCase
+		{
+			const TCHAR* Name;
+			bool bSharedVertices;
+			bool bSurfaceNets;
+			float SimplifyError;
+		};
+		// Simplified within a twentieth of a voxel
+		const FMesherCase MesherCases[] = {
+			{ TEXT("MarchingCubes"), false, false, 0.f },
+			{ TEXT("MarchingCubesShared"), true, false, 0.f },
+			{ TEXT("MarchingCubesSimplified"), true, false, TestVoxelSize * 0.05f },
+			{ TEXT("SurfaceNets"), false, true, 0.f },
+			{ TEXT("SurfaceNetsSimplified"), false, true, TestVoxelSize * 0.05f }
+		};
+
+		for (EVoxelTestShape Shape : { EVoxelTestShape::Sphere, EVoxelTestShape::Box, EVoxelTestShape::Wall })
+		{
+			TArray<float> Dense;
+			BakeShape(Shape, Size, Dense);
+			FVoxelStore Store;
+			Store.FromDense(FIntVector(Dim), Dense, TestSurfaceLevel);
+			Store.ToDense(Dense);
+
+			for (const FMesherCase& Case : MesherCases)
+			{
+				FVoxelMeshSettings Settings;
+				Settings.SurfaceLevel = TestSurfaceLevel;
+				Settings.VoxelSize = TestVoxelSize;
+				Settings.bSharedVertices = Case.bSharedVertices;
+				Settings.bSurfaceNets = Case.bSurfaceNets;
+				Settings.SimplifyError = Case.SimplifyError;
+				Settings.TriangleOrder[0] = 2;
+				Settings.TriangleOrder[2] = 0;
+
+				TArray<FVoxelMeshBuffers> Buffers;
+				TArray<FVoxelMesher::FJob> Jobs;
+				double BestExtract = MAX_dbl;
+				for (int32 Run = 0; Run < 5; ++Run)
+				{
+					const double StartTime = FPlatformTime::Seconds();
+					MakeTestChunkJobs(Size, TestChunkSize, Buffers, Jobs);
+					FVoxelMesher(Settings, MakeTestView(Dense, FIntVector::ZeroValue, FIntVector(Dim), Store)).MeshJobs(Jobs, true);
+					BestExtract = FMath::Min(BestExtract, FPlatformTime::Seconds() - StartTime);
+				}
+
+				int32 Triangles = 0;
+				int32 Vertices = 0;
+				for (const FVoxelMeshBuffers& Buffer : Buffers)
+				{
+					Triangles += Buffer.Triangles.Num() / 3;
+					Vertices += Buffer.Vertices.Num();
+				}
+
+				// One body cooked over every section, the way the synchronous ApplyMesh path does it
+				TStrongObjectPtr<UProceduralMeshComponent> Component(NewObject<UProceduralMeshComponent>(GetTransientPackage()));
+				for (int32 Section = 0; Section < Buffers.Num() - 1; ++Section)
+				{
+					const FVoxelMeshBuffers& Data = Buffers[Section];
+					Component->CreateMeshSection(Section, Data.Vertices, Data.Triangles, Data.Normals, Data.UVs, Data.Colors, TArray<FProcMeshTangent>(), false);
+					Component->GetProcMeshSection(Section)->bEnableCollision = true;
+				}
+				const FVoxelMeshBuffers& Last = Buffers.Last();
+				const double CookStart = FPlatformTime::Seconds();
+				Component->CreateMeshSection(Buffers.Num() - 1, Last.Vertices, Last.Triangles, Last.Normals, Last.UVs, Last.Colors, TArray<FProcMeshTangent>(), true);
+				const double CookSeconds = FPlatformTime::Seconds() - CookStart;
+
+				UE_LOG(LogVoxel, Display, TEXT("Voxel.BenchMeshers %s %d^3 %s: %d triangles, %d vertices, extract %.2f ms, collision cook %.2f ms"),
+					GetTestShapeName(Shape), Size, Case.Name, Triangles, Vertices, BestExtract * 1000.0, CookSeconds * 1000.0);
+			}
+		}
+	}));
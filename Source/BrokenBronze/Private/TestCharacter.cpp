@@ -11,6 +11,7 @@
 #include "NavigationSystem.h"
 #include "Camera/CameraComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 
 ATestCharacter::ATestCharacter()
@@ -144,6 +145,9 @@ void ATestCharacter::ResetScopeCooldown()
 }
 void ATestCharacter::ShootDestructionBall()
 {
+    TRACE_CPUPROFILER_EVENT_SCOPE(ATestCharacter::ShootDestructionBall);
+    // The edit latency stats start here, the trace is part of what the player waits on
+    const double InputTime = FPlatformTime::Seconds();
       UWorld* World = GetWorld();
     if (!World) return;
     
@@ -182,7 +186,7 @@ void ATestCharacter::ShootDestructionBall()
         if (MarchingCube)
         {
             // Call MakeHole with the impact position
-            MarchingCube->MakeHole(HitResult.ImpactPoint, Radius);
+            MarchingCube->MakeHoleFromInput(HitResult.ImpactPoint, Radius, InputTime);
         }
     }
 }
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MeshPseudoNormals.h"
+
+void FMeshPseudoNormals::Build(const TArray<FVector>& Vertices, const TArray<int>& Indices)
+{
+	const int32 TriangleCount = Indices.Num() / 3;
+	WeldedCorners.SetNumUninitialized(TriangleCount * 3);
+	Corners.SetNumUninitialized(TriangleCount * 3);
+	FaceNormals.SetNumUninitialized(TriangleCount);
+	VertexNormals.Reset();
+	EdgeNormals.Reset();
+
+	TMap<FVector, int32> WeldedIds;
+	for (int32 i = 0; i < TriangleCount * 3; ++i)
+	{
+		const FVector& Position = Vertices[Indices[i]];
+		Corners[i] = Position;
+		int32& Id = WeldedIds.FindOrAdd(Position, WeldedIds.Num());
+		WeldedCorners[i] = Id;
+	}
+	VertexNormals.Init(FVector::ZeroVector, WeldedIds.Num());
+
+	// The winding convention of the source mesh is not known up front, so use the sign of the enclosed volume
+	// to make the normals face outwards
+	double SignedVolume = 0.0;
+	for (int32 t = 0; t < TriangleCount; ++t)
+	{
+		SignedVolume += FVector::DotProduct(Corners[t * 3], FVector::CrossProduct(Corners[t * 3 + 1], Corners[t * 3 + 2]));
+	}
+	const double Orientation = SignedVolume < 0.0 ? -1.0 : 1.0;
+
+	for (int32 t = 0; t < TriangleCount; ++t)
+	{
+		const FVector& A = Corners[t * 3];
+		const FVector& B = Corners[t * 3 + 1];
+		const FVector& C = Corners[t * 3 + 2];
+		const FVector Normal = FVector::CrossProduct(B - A, C - A).GetSafeNormal() * Orientation;
+		FaceNormals[t] = Normal;
+
+		for (int32 k = 0; k < 3; ++k)
+		{
+			const FVector& Corner = Corners[t * 3 + k];
+			const FVector& Next = Corners[t * 3 + (k + 1) % 3];
+			const FVector& Prev = Corners[t * 3 + (k + 2) % 3];
+			const double Angle = FMath::Acos(FMath::Clamp(FVector::DotProduct((Next - Corner).GetSafeNormal(), (Prev - Corner).GetSafeNormal()), -1.0, 1.0));
+			VertexNormals[WeldedCorners[t * 3 + k]] += Normal * Angle;
+
+			EdgeNormals.FindOrAdd(EdgeKey(WeldedCorners[t * 3 + k], WeldedCorners[t * 3 + (k + 1) % 3]), FVector::ZeroVector) += Normal;
+		}
+	}
+}
+
+FVector FMeshPseudoNormals::GetNormal(int32 FirstIndex, const FVector& ClosestPoint) const
+{
+	const int32 Triangle = FirstIndex / 3;
+	const FVector Weights = FMath::ComputeBaryCentric2D(ClosestPoint, Corners[FirstIndex], Corners[FirstIndex + 1], Corners[FirstIndex + 2]);
+
+	constexpr double Epsilon = 1e-5;
+	int32 ZeroCount = 0;
+	int32 NonZeroCorner = 0;
+	int32 ZeroCorner = 0;
+	for (int32 k = 0; k < 3; ++k)
+	{
+		if (Weights[k] <= Epsilon)
+		{
+			++ZeroCount;
+			ZeroCorner = k;
+		}
+		else
+		{
+			NonZeroCorner = k;
+		}
+	}
+
+	if (ZeroCount >= 2)
+	{
+		// On a corner
+		return VertexNormals[WeldedCorners[FirstIndex + NonZeroCorner]];
+	}
+	if (ZeroCount == 1)
+	{
+		// On the edge opposite the corner with no weight
+		const uint64 Key = EdgeKey(WeldedCorners[FirstIndex + (ZeroCorner + 1) % 3], WeldedCorners[FirstIndex + (ZeroCorner + 2) % 3]);
+		if (const FVector* EdgeNormal = EdgeNormals.Find(Key))
+		{
+			return *EdgeNormal;
+		}
+	}
+	return FaceNormals[Triangle];
+}
+
+bool FMeshPseudoNormals::IsInside(const FVector& P, int32 FirstIndex, const FVector& ClosestPoint) const
+{
+	return FVector::DotProduct(P - ClosestPoint, GetNormal(FirstIndex, ClosestPoint)) < 0.0;
+}
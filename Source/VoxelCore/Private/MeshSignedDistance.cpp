@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MeshSignedDistance.h"
+
+#include "MeshPseudoNormals.h"
+#include "TriangleBVH.h"
+
+float FMeshSignedDistance::ClosestDistance(const FVector& P, int32* OutTriangle, FVector* OutClosestPoint) const
+{
+	if (BVH)
+	{
+		return BVH->ClosestDistance(P, OutTriangle, OutClosestPoint);
+	}
+
+	float minDist = FLT_MAX;
+	for (int i = 0; i + 2 < Indices.Num(); i+=3)
+	{
+		const FVector& A = Vertices[Indices[i]];
+		const FVector& B = Vertices[Indices[i + 1]];
+		const FVector& C = Vertices[Indices[i + 2]];
+
+		FVector closest = FMath::ClosestPointOnTriangleToPoint(P, A, B, C);
+		float Dist = FVector::Dist(P, closest);
+		if (Dist < minDist)
+		{
+			minDist = Dist;
+			if (OutTriangle)
+			{
+				*OutTriangle = i;
+			}
+			if (OutClosestPoint)
+			{
+				*OutClosestPoint = closest;
+			}
+		}
+	}
+	return minDist;
+}
+
+int32 FMeshSignedDistance::CountSegmentHits(const FVector& Start, const FVector& End) const
+{
+	if (BVH)
+	{
+		return BVH->CountSegmentHits(Start, End);
+	}
+
+	int hits = 0;
+	for (int i = 0; i + 2 < Indices.Num(); i += 3)
+	{
+		const FVector& A = Vertices[Indices[i]];
+		const FVector& B = Vertices[Indices[i + 1]];
+		const FVector& C = Vertices[Indices[i + 2]];
+
+		FVector hitPoint;
+		FVector normal;
+
+		if (FMath::SegmentTriangleIntersection(Start, End, A, B, C, hitPoint, normal))
+		{
+			hits++;
+		}
+	}
+	return hits;
+}
+
+bool FMeshSignedDistance::IsInsideByRayVoting(const FVector& P) const
+{
+	// Use more ray directions for better coverage of flat surfaces
+	static const FVector RayDirections[] = {
+		FVector(1.0f, 0.0f, 0.0f),
+		FVector(0.0f, 1.0f, 0.0f),
+		FVector(0.0f, 0.0f, 1.0f),
+		FVector(-1.0f, 0.0f, 0.0f),
+		FVector(0.0f, -1.0f, 0.0f),
+		FVector(0.0f, 0.0f, -1.0f),
+		FVector(1.0f, 1.0f, 1.0f).GetSafeNormal(),
+		FVector(-1.0f, 1.0f, 1.0f).GetSafeNormal(),
+		FVector(1.0f, -1.0f, 1.0f).GetSafeNormal(),
+		FVector(1.0f, 1.0f, -1.0f).GetSafeNormal()
+	};
+
+	// Count the number of rays indicating the point is inside
+	int insideCount = 0;
+	int totalRays = UE_ARRAY_COUNT(RayDirections);
+
+	// Small epsilon to offset ray start position slightly
+	const float Epsilon = 0.0001f;
+
+	for (const FVector& RayDir : RayDirections)
+	{
+		// Slightly offset ray starting point to avoid numerical precision issues
+		FVector RayStart = P + RayDir * Epsilon;
+		FVector RayEnd = P + RayDir * 10000.0f;
+
+		int hits = CountSegmentHits(RayStart, RayEnd);
+
+		// If no hits detected with this ray, try the opposite direction
+		if (hits == 0)
+		{
+			FVector oppositeRayEnd = P - RayDir * 10000.0f;
+			hits = CountSegmentHits(RayStart, oppositeRayEnd);
+		}
+
+		if ((hits % 2) == 1)
+		{
+			insideCount++;
+		}
+	}
+
+	// Use weighted voting - require more than half the rays to agree
+	return insideCount > (totalRays / 2);
+}
+
+float FMeshSignedDistance::SignedDistance(const FVector& P, bool bPseudoNormalSign) const
+{
+	int32 Triangle = INDEX_NONE;
+	FVector Closest;
+	const float dist = ClosestDistance(P, &Triangle, &Closest);
+
+	bool isInside;
+	if (bPseudoNormalSign && PseudoNormals && Triangle != INDEX_NONE)
+	{
+		isInside = PseudoNormals->IsInside(P, Triangle, Closest);
+	}
+	else
+	{
+		isInside = IsInsideByRayVoting(P);
+	}
+	return isInside ? dist : -dist;
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MeshSignedDistance.h"
+#include "MeshPseudoNormals.h"
+#include "TriangleBVH.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	//Axis aligned box around the origin, each face its own 4 vertices like render data split on UV seams
+	void MakeBoxSoup(const FVector& Extent, TArray<FVector>& OutVertices, TArray<int32>& OutIndices)
+	{
+		for (int Axis = 0; Axis < 3; ++Axis)
+		{
+			for (const double Side : { -1.0, 1.0 })
+			{
+				FVector Normal = FVector::ZeroVector;
+				Normal[Axis] = Side;
+				FVector U = FVector::ZeroVector;
+				U[(Axis + 1) % 3] = 1.0;
+				const FVector V = FVector::CrossProduct(Normal, U);
+
+				const int32 First = OutVertices.Num();
+				for (const FVector& Corner : { -U - V, U - V, U + V, -U + V })
+				{
+					OutVertices.Add((Normal + Corner) * Extent);
+				}
+				OutIndices.Append({ First, First + 1, First + 2, First, First + 2, First + 3 });
+			}
+		}
+	}
+
+	//Latitude and longitude sphere around the origin, with a vertex at each pole
+	void MakeSphereSoup(double Radius, int32 Rings, int32 Segments, TArray<FVector>& OutVertices, TArray<int32>& OutIndices)
+	{
+		OutVertices.Add(FVector(0, 0, Radius));
+		for (int32 Ring = 1; Ring < Rings; ++Ring)
+		{
+			const double Theta = PI * Ring / Rings;
+			for (int32 Segment = 0; Segment < Segments; ++Segment)
+			{
+				const double Phi = 2.0 * PI * Segment / Segments;
+				OutVertices.Add(Radius * FVector(FMath::Sin(Theta) * FMath::Cos(Phi), FMath::Sin(Theta) * FMath::Sin(Phi), FMath::Cos(Theta)));
+			}
+		}
+		const int32 South = OutVertices.Add(FVector(0, 0, -Radius));
+
+		auto RingVertex = [Segments](int32 Ring, int32 Segment) { return 1 + (Ring - 1) * Segments + Segment % Segments; };
+		for (int32 Segment = 0; Segment < Segments; ++Segment)
+		{
+			OutIndices.Append({ 0, RingVertex(1, Segment), RingVertex(1, Segment + 1) });
+			OutIndices.Append({ South, RingVertex(Rings - 1, Segment + 1), RingVertex(Rings - 1, Segment) });
+			for (int32 Ring = 1; Ring < Rings - 1; ++Ring)
+			{
+				OutIndices.Append({ RingVertex(Ring, Segment), RingVertex(Ring + 1, Segment), RingVertex(Ring + 1, Segment + 1) });
+				OutIndices.Append({ RingVertex(Ring, Segment), RingVertex(Ring + 1, Segment + 1), RingVertex(Ring, Segment + 1) });
+			}
+		}
+	}
+
+	//Both sign modes over a grid of points around the soup, skipping the points too close to the surface for ray
+	//voting to be reliable. Returns the number of points the two disagree on.
+	int32 CountSignDisagreements(const FMeshSignedDistance& Distance, const FBox& Bounds, int32 Steps, double SurfaceMargin, int32& OutTested)
+	{
+		int32 Disagreements = 0;
+		OutTested = 0;
+		const FBox Grid = Bounds.ExpandBy(Bounds.GetExtent() * 0.25);
+		for (int32 Z = 0; Z <= Steps; ++Z)
+		{
+			for (int32 Y = 0; Y <= Steps; ++Y)
+			{
+				for (int32 X = 0; X <= Steps; ++X)
+				{
+					const FVector P = Grid.Min + Grid.GetSize() * FVector(X, Y, Z) / Steps;
+					if (Distance.ClosestDistance(P) < SurfaceMargin)
+					{
+						continue;
+					}
+					++OutTested;
+					const bool bPseudoNormalInside = Distance.SignedDistance(P, true) > 0.f;
+					const bool bRayVotingInside = Distance.SignedDistance(P, false) > 0.f;
+					Disagreements += bPseudoNormalInside != bRayVotingInside;
+				}
+			}
+		}
+		return Disagreements;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMeshSignedDistanceSignModesTest, "VoxelCore.MeshSignedDistance.SignModes",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMeshSignedDistanceSignModesTest::RunTest(const FString& Parameters)
+{
+	struct FSoup
+	{
+		const TCHAR* Name;
+		TArray<FVector> Vertices;
+		TArray<int32> Indices;
+		//Point known to be inside and how far it is from the surface
+		FVector Inside;
+		double InsideDistance;
+		FVector Outside;
+	};
+	FSoup Soups[2];
+	Soups[0].Name = TEXT("Box");
+	MakeBoxSoup(FVector(50.0, 80.0, 30.0), Soups[0].Vertices, Soups[0].Indices);
+	Soups[0].Inside = FVector(0.0, 10.0, 0.0);
+	Soups[0].InsideDistance = 30.0;
+	Soups[0].Outside = FVector(60.0, 0.0, 0.0);
+
+	Soups[1].Name = TEXT("Sphere");
+	MakeSphereSoup(100.0, 16, 32, Soups[1].Vertices, Soups[1].Indices);
+	Soups[1].Inside = FVector(0.0, 0.0, 40.0);
+	// Closest to the facets around the north pole, tilted half a ring from the pole
+	Soups[1].InsideDistance = 60.0 * FMath::Cos(PI / 32);
+	Soups[1].Outside = FVector(0.0, 0.0, 120.0);
+
+	for (FSoup& Soup : Soups)
+	{
+		FTriangleBVH BVH;
+		BVH.Build(Soup.Vertices, Soup.Indices);
+		FMeshPseudoNormals PseudoNormals;
+		PseudoNormals.Build(Soup.Vertices, Soup.Indices);
+
+		FMeshSignedDistance Distance;
+		Distance.Vertices = Soup.Vertices;
+		Distance.Indices = Soup.Indices;
+		Distance.BVH = &BVH;
+		Distance.PseudoNormals = &PseudoNormals;
+
+		FBox Bounds(Soup.Vertices);
+		int32 Tested = 0;
+		const int32 Disagreements = CountSignDisagreements(Distance, Bounds, 24, Bounds.GetSize().GetMin() * 0.01, Tested);
+		TestTrue(FString::Printf(TEXT("%s: grid points tested"), Soup.Name), Tested > 0);
+		TestEqual(FString::Printf(TEXT("%s: pseudo-normal and ray voting disagree on %d of %d points"), Soup.Name, Disagreements, Tested), Disagreements, 0);
+
+		for (const bool bPseudoNormalSign : { true, false })
+		{
+			const TCHAR* Mode = bPseudoNormalSign ? TEXT("pseudo-normal") : TEXT("ray voting");
+			TestNearlyEqual(FString::Printf(TEXT("%s: %s distance of the inside point"), Soup.Name, Mode),
+				Distance.SignedDistance(Soup.Inside, bPseudoNormalSign), float(Soup.InsideDistance), 1.f);
+			TestTrue(FString::Printf(TEXT("%s: %s puts the outside point outside"), Soup.Name, Mode),
+				Distance.SignedDistance(Soup.Outside, bPseudoNormalSign) < 0.f);
+		}
+	}
+	return true;
+}
+
+#endif
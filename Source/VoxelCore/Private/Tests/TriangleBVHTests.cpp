@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TriangleBVH.h"
+#include "MeshSignedDistance.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTriangleBVHBruteForceTest, "VoxelCore.TriangleBVH.MatchesBruteForce",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTriangleBVHBruteForceTest::RunTest(const FString& Parameters)
+{
+	// Small random triangles scattered through a box, with a fixed seed so a failure can be reproduced
+	FRandomStream Random(1234);
+	const FBox Box(FVector(-500.0), FVector(500.0));
+	TArray<FVector> Vertices;
+	TArray<int32> Indices;
+	for (int32 t = 0; t < 500; ++t)
+	{
+		const FVector Center = Random.RandPointInBox(Box);
+		for (int32 k = 0; k < 3; ++k)
+		{
+			Indices.Add(Vertices.Add(Center + Random.GetUnitVector() * Random.FRandRange(5.0, 60.0)));
+		}
+	}
+
+	FTriangleBVH BVH;
+	BVH.Build(Vertices, Indices);
+	TestEqual(TEXT("Every triangle is in the tree"), BVH.NumTriangles(), Indices.Num() / 3);
+
+	// Without a BVH every query tests every triangle
+	FMeshSignedDistance BruteForce;
+	BruteForce.Vertices = Vertices;
+	BruteForce.Indices = Indices;
+
+	const FBox QueryBox = Box.ExpandBy(200.0);
+	int32 DistanceMismatches = 0;
+	int32 HitMismatches = 0;
+	for (int32 i = 0; i < 1000; ++i)
+	{
+		const FVector P = Random.RandPointInBox(QueryBox);
+		const float Expected = BruteForce.ClosestDistance(P);
+		DistanceMismatches += !FMath::IsNearlyEqual(BVH.ClosestDistance(P), Expected, 1e-2f);
+
+		const FVector End = Random.RandPointInBox(QueryBox);
+		HitMismatches += BVH.CountSegmentHits(P, End) != BruteForce.CountSegmentHits(P, End);
+	}
+	TestEqual(TEXT("Closest distances that differ from brute force"), DistanceMismatches, 0);
+	TestEqual(TEXT("Segment hit counts that differ from brute force"), HitMismatches, 0);
+
+	TestTrue(TEXT("Empty tree"), FTriangleBVH().IsEmpty());
+	TestEqual(TEXT("Empty tree distance"), FTriangleBVH().ClosestDistance(FVector::ZeroVector), FLT_MAX);
+	return true;
+}
+
+#endif
@@ -0,0 +1,289 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Microbenchmarks of the Core-only voxel code, one case per grid size. They only log, run them with
+//-nullrhi -unattended -ExecCmds="Automation RunTests VoxelCore.Bench; Quit". The whole pipeline with uploads and
+//collision is BrokenBronze.Voxel.Bench in the game module.
+
+#include "VoxelBrush.h"
+#include "VoxelMesher.h"
+#include "VoxelStats.h"
+#include "VoxelStore.h"
+#include "VoxelTestShapes.h"
+#include "Async/ParallelFor.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	void GetBenchSizes(std::initializer_list<int32> Sizes, TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands)
+	{
+		for (int32 Size : Sizes)
+		{
+			OutBeautifiedNames.Add(FString::Printf(TEXT("%d"), Size));
+			OutTestCommands.Add(FString::Printf(TEXT("%d"), Size));
+		}
+	}
+}
+
+//Marches a sphere per cell and with row classification, logs cells per second
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FVoxelBenchClassifyTest, "VoxelCore.Bench.Classify", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FVoxelBenchClassifyTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	GetBenchSizes({ 64, 128, 256 }, OutBeautifiedNames, OutTestCommands);
+}
+
+bool FVoxelBenchClassifyTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = FCString::Atoi(*Parameters);
+	const int32 Dim = Size + 1;
+	// The benchmark sphere is in world units of 20 per voxel, what the default settings below expect
+	TArray<float> Values;
+	MakeTestShapeVoxels(EVoxelTestShape::Sphere, Size, Values);
+
+	FVoxelGridView View;
+	View.Data = Values.GetData();
+	View.Dims = FIntVector(Dim);
+	const double NumCells = double(Size) * Size * Size;
+	for (bool bRows : { false, true })
+	{
+		FVoxelMeshSettings Settings;
+		Settings.bRowClassification = bRows;
+		const FVoxelMesher Mesher(Settings, View);
+		FVoxelMeshBuffers MeshData;
+		double Best = MAX_dbl;
+		for (int32 Run = 0; Run < 5; ++Run)
+		{
+			MeshData.Reset();
+			const double StartTime = FPlatformTime::Seconds();
+			Mesher.MarchCells(FIntVector::ZeroValue, FIntVector(Size), MeshData);
+			Best = FMath::Min(Best, FPlatformTime::Seconds() - StartTime);
+		}
+		UE_LOG(LogVoxel, Display, TEXT("VoxelCore.Bench.Classify %s: %d^3 cells in %.2f ms, %.1f M cells/s, %d triangles"),
+			bRows ? TEXT("rows") : TEXT("per cell"), Size, Best * 1000.0, NumCells / Best / 1e6, MeshData.Triangles.Num() / 3);
+	}
+	return true;
+}
+
+//Evaluates every brush shape over its bounds, then applies every operation to a sphere with brushes along its
+//surface, logs voxels per second of each
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FVoxelBenchBrushesTest, "VoxelCore.Bench.Brushes", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FVoxelBenchBrushesTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	GetBenchSizes({ 64, 128 }, OutBeautifiedNames, OutTestCommands);
+}
+
+bool FVoxelBenchBrushesTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = FCString::Atoi(*Parameters);
+	const int32 Dim = Size + 1;
+	const int32 NumBrushes = 64;
+	const float BrushSize = FMath::Max(Size / 12.f, 2.f);
+
+	const EVoxelBrushShape Shapes[] = { EVoxelBrushShape::Sphere, EVoxelBrushShape::Capsule, EVoxelBrushShape::Box, EVoxelBrushShape::Cone };
+	const TCHAR* ShapeNames[] = { TEXT("Sphere"), TEXT("Capsule"), TEXT("Box"), TEXT("Cone") };
+	struct FOperationCase
+	{
+		const TCHAR* Name;
+		EVoxelBrushOp Operation;
+		float Smoothing;
+	};
+	const FOperationCase OperationCases[] = {
+		{ TEXT("Carve"), EVoxelBrushOp::Carve, 0.f },
+		{ TEXT("Subtract"), EVoxelBrushOp::Subtract, 0.f },
+		{ TEXT("SmoothSubtract"), EVoxelBrushOp::Subtract, 2.f },
+		{ TEXT("Union"), EVoxelBrushOp::Union, 0.f },
+		{ TEXT("SmoothUnion"), EVoxelBrushOp::Union, 2.f }
+	};
+
+	// Brushes along the surface of the sphere with a fixed seed, the same ones for every operation
+	auto MakeBrushes = [&](EVoxelBrushShape Shape, TArray<FVoxelBrush>& OutBrushes)
+	{
+		FRandomStream Random(Size * 31 + int32(Shape));
+		OutBrushes.Reset();
+		for (int32 i = 0; i < NumBrushes; ++i)
+		{
+			const FVector3f Center = FVector3f(Size * 0.5f) + FVector3f(Random.GetUnitVector()) * Size * 0.35f;
+			const FVector3f Direction = FVector3f(Random.GetUnitVector());
+			switch (Shape)
+			{
+			case EVoxelBrushShape::Sphere:
+				OutBrushes.Add(FVoxelBrush::MakeSphere(Center, BrushSize));
+				break;
+			case EVoxelBrushShape::Capsule:
+				OutBrushes.Add(FVoxelBrush::MakeCapsule(Center - Direction * BrushSize * 2.f, Center + Direction * BrushSize * 2.f, BrushSize * 0.5f));
+				break;
+			case EVoxelBrushShape::Box:
+				OutBrushes.Add(FVoxelBrush::MakeBox(Center, FVector3f(BrushSize, BrushSize * 0.5f, BrushSize * 0.75f), FQuat4f(Direction, 0.6f)));
+				break;
+			default:
+				OutBrushes.Add(FVoxelBrush::MakeCone(Center - Direction * BrushSize, Center + Direction * BrushSize, BrushSize));
+				break;
+			}
+			OutBrushes.Last().DistanceScale = TestVoxelSize;
+			OutBrushes.Last().HoleValue = -TestVoxelSize * 2;
+		}
+	};
+
+	TArray<float> Dense;
+	MakeTestShapeVoxels(EVoxelTestShape::Sphere, Size, Dense);
+	FVoxelStore Baked;
+	Baked.FromDense(FIntVector(Dim), Dense, TestSurfaceLevel);
+
+	TArray<FVoxelBrush> Brushes;
+	TArray<float> Row;
+	for (int32 ShapeIndex = 0; ShapeIndex < UE_ARRAY_COUNT(Shapes); ++ShapeIndex)
+	{
+		MakeBrushes(Shapes[ShapeIndex], Brushes);
+
+		// The distance kernel alone, every row of every brush's bounds
+		int64 KernelVoxels = 0;
+		float Checksum = 0.f;
+		const double KernelStart = FPlatformTime::Seconds();
+		for (const FVoxelBrush& Brush : Brushes)
+		{
+			FIntVector Min;
+			FIntVector Max;
+			Brush.GetBounds(Min, Max);
+			const int32 Count = Max.X - Min.X + 1;
+			Row.SetNumUninitialized(Align(Count, 4));
+			for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+			{
+				for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+				{
+					Brush.GetRowDistances(FVector3f(Min.X, Y, Z), Count, Row.GetData());
+					Checksum += Row[0];
+					KernelVoxels += Count;
+				}
+			}
+		}
+		const double KernelSeconds = FPlatformTime::Seconds() - KernelStart;
+		UE_LOG(LogVoxel, Display, TEXT("VoxelCore.Bench.Brushes %s distance: %.1f M voxels/s over %lld voxels (checksum %.1f)"),
+			ShapeNames[ShapeIndex], KernelVoxels / FMath::Max(KernelSeconds, 1e-9) / 1e6, KernelVoxels, Checksum);
+
+		// Whole edits on the store, brick culling, writes and compaction included. Throughput is over the
+		// clamped bounds, the voxels the brush is responsible for.
+		for (const FOperationCase& Case : OperationCases)
+		{
+			FVoxelStore Store = Baked;
+			int64 BoundsVoxels = 0;
+			int64 Changed = 0;
+			const double StartTime = FPlatformTime::Seconds();
+			for (FVoxelBrush& Brush : Brushes)
+			{
+				Brush.Operation = Case.Operation;
+				Brush.Smoothing = Case.Smoothing;
+				FIntVector Min;
+				FIntVector Max;
+				Brush.GetBounds(Min, Max);
+				const FIntVector Extent = Max.ComponentMin(FIntVector(Size)) - Min.ComponentMax(FIntVector::ZeroValue) + FIntVector(1);
+				BoundsVoxels += int64(FMath::Max(Extent.X, 0)) * FMath::Max(Extent.Y, 0) * FMath::Max(Extent.Z, 0);
+
+				const FVoxelRegion Edited = Store.ApplyBrush(Brush);
+				if (!Edited.IsEmpty())
+				{
+					const FIntVector EditedSize = Edited.Max - Edited.Min + FIntVector(1);
+					Changed += int64(EditedSize.X) * EditedSize.Y * EditedSize.Z;
+				}
+			}
+			const double Seconds = FPlatformTime::Seconds() - StartTime;
+			UE_LOG(LogVoxel, Display, TEXT("VoxelCore.Bench.Brushes %s %s: %.1f M voxels/s, %.3f ms per edit, changed region %lld voxels"),
+				ShapeNames[ShapeIndex], Case.Name, BoundsVoxels / FMath::Max(Seconds, 1e-9) / 1e6, Seconds * 1000.0 / NumBrushes, Changed);
+		}
+	}
+	return true;
+}
+
+//Stores the synthetic shapes as floats and as 16 bit steps, then copies and meshes every chunk the way the async
+//remesh does. Logs store memory, bytes copied for the mesher, copy and mesh time, triangles and the largest rounding
+//error side by side. Bytes copied stand in for cache misses, run it under perf or VTune for the real counters.
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FVoxelBenchQuantizedTest, "VoxelCore.Bench.Quantized", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FVoxelBenchQuantizedTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	GetBenchSizes({ 64, 128, 256 }, OutBeautifiedNames, OutTestCommands);
+}
+
+bool FVoxelBenchQuantizedTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = FCString::Atoi(*Parameters);
+	const int32 Dim = Size + 1;
+	const double NumVoxels = double(Dim) * Dim * Dim;
+
+	FVoxelMeshSettings Settings;
+	Settings.SurfaceLevel = TestSurfaceLevel;
+	Settings.VoxelSize = TestVoxelSize;
+	const FIntVector Apron(FVoxelMesher::GetApron(Settings));
+
+	for (EVoxelTestShape Shape : { EVoxelTestShape::Sphere, EVoxelTestShape::Box, EVoxelTestShape::Wall })
+	{
+		TArray<float> Dense;
+		MakeTestShapeVoxels(Shape, Size, Dense);
+
+		for (bool bQuantize : { false, true })
+		{
+			FVoxelStore Store;
+			Store.SetQuantum(bQuantize ? TestVoxelSize / FVoxelStore::StepsPerVoxel : 0.f);
+			Store.FromDense(FIntVector(Dim), Dense, TestSurfaceLevel);
+
+			// Against the baked values, only dense bricks count, uniform ones are an average either way
+			float MaxError = 0.f;
+			for (int32 Z = 0; Z < Dim; ++Z)
+			{
+				for (int32 Y = 0; Y < Dim; ++Y)
+				{
+					for (int32 X = 0; X < Dim; ++X)
+					{
+						const int32 BrickIndex = Store.GetBrickIndex(X / FVoxelStore::BrickSize, Y / FVoxelStore::BrickSize, Z / FVoxelStore::BrickSize);
+						if (!Store.GetUniformMask()[BrickIndex])
+						{
+							MaxError = FMath::Max(MaxError, FMath::Abs(Store.Get(X, Y, Z) - Dense[(Z * Dim + Y) * Dim + X]));
+						}
+					}
+				}
+			}
+
+			TArray<FVoxelMeshBuffers> Buffers;
+			TArray<FVoxelMesher::FJob> Jobs;
+			TArray<FVoxelBoxCopy> Copies;
+			double BestCopy = MAX_dbl;
+			double BestMesh = MAX_dbl;
+			int64 CopiedBytes = 0;
+			for (int32 Run = 0; Run < 5; ++Run)
+			{
+				MakeTestChunkJobs(Size, TestChunkSize, Buffers, Jobs);
+				Copies.SetNum(Jobs.Num());
+				CopiedBytes = 0;
+				const double CopyStart = FPlatformTime::Seconds();
+				for (int32 i = 0; i < Jobs.Num(); ++i)
+				{
+					Store.CopyBox((Jobs[i].CellMin - Apron).ComponentMax(FIntVector::ZeroValue), Jobs[i].CellMax, Copies[i]);
+					CopiedBytes += Copies[i].Values.Num() * sizeof(float) + Copies[i].Steps.Num() * sizeof(int16);
+				}
+				const double MeshStart = FPlatformTime::Seconds();
+				ParallelFor(Jobs.Num(), [&](int32 i)
+				{
+					const FIntVector Origin = (Jobs[i].CellMin - Apron).ComponentMax(FIntVector::ZeroValue);
+					FVoxelMesher(Settings, MakeTestView(Copies[i], Origin, Jobs[i].CellMax - Origin + FIntVector(1), Store)).MeshJobs(MakeArrayView(&Jobs[i], 1), false);
+				});
+				BestCopy = FMath::Min(BestCopy, MeshStart - CopyStart);
+				BestMesh = FMath::Min(BestMesh, FPlatformTime::Seconds() - MeshStart);
+			}
+
+			int32 Triangles = 0;
+			for (const FVoxelMeshBuffers& Buffer : Buffers)
+			{
+				Triangles += Buffer.Triangles.Num() / 3;
+			}
+
+			UE_LOG(LogVoxel, Display, TEXT("VoxelCore.Bench.Quantized %s %d^3 %s: store %.1f KB (%.2f bytes/voxel, %d of %d bricks dense), copied %.1f KB, copy %.2f ms, mesh %.2f ms, %d triangles, max error %.4f"),
+				GetTestShapeName(Shape), Size, bQuantize ? TEXT("Int16") : TEXT("Float"), Store.GetAllocatedSize() / 1024.0, Store.GetAllocatedSize() / NumVoxels,
+				Store.NumDenseBricks(), Store.GetUniformMask().Num(), CopiedBytes / 1024.0, BestCopy * 1000.0, BestMesh * 1000.0, Triangles, MaxError);
+		}
+	}
+	return true;
+}
+
+#endif
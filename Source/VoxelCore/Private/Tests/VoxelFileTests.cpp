@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelFile.h"
+#include "VoxelTestShapes.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	//A sphere on enough voxels to span several v2 blocks
+	FVoxelFileData MakeTestFileData()
+	{
+		FVoxelFileData Data;
+		Data.SizeX = 70;
+		Data.SizeY = 52;
+		Data.SizeZ = 36;
+		Data.VoxelSize = TestVoxelSize;
+		MakeSphereVoxels(FIntVector(Data.SizeX, Data.SizeY, Data.SizeZ), 15.0, Data.Voxels);
+		return Data;
+	}
+
+	//The v1 layout, which nothing writes anymore
+	void WriteV1(const FVoxelFileData& Data, TArray<uint8>& Out)
+	{
+		FMemoryWriter Writer(Out);
+		int32 SizeX = Data.SizeX;
+		int32 SizeY = Data.SizeY;
+		int32 SizeZ = Data.SizeZ;
+		float VoxelSize = Data.VoxelSize;
+		int32 NumVoxels = Data.Voxels.Num();
+		Writer << SizeX << SizeY << SizeZ << VoxelSize << NumVoxels;
+		Writer.Serialize(const_cast<float*>(Data.Voxels.GetData()), Data.Voxels.Num() * sizeof(float));
+	}
+
+	bool SameHeader(const FVoxelFileData& A, const FVoxelFileData& B)
+	{
+		return A.SizeX == B.SizeX && A.SizeY == B.SizeY && A.SizeZ == B.SizeZ && A.VoxelSize == B.VoxelSize && A.Voxels.Num() == B.Voxels.Num();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelFileRoundTripTest, "VoxelCore.File.RoundTrip",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelFileRoundTripTest::RunTest(const FString& Parameters)
+{
+	const FVoxelFileData Data = MakeTestFileData();
+	for (const uint32 WrittenVersion : { 1u, 2u })
+	{
+		TArray<uint8> File;
+		if (WrittenVersion == 1)
+		{
+			WriteV1(Data, File);
+			TestEqual(TEXT("v1 size"), int64(File.Num()), FVoxelFile::GetV1Size(Data.Voxels.Num()));
+		}
+		else
+		{
+			FVoxelFile::Write(Data, 0.f, 0.f, File);
+		}
+
+		FVoxelFileData Read;
+		uint32 ReadVersion = 0;
+		if (!TestTrue(FString::Printf(TEXT("v%u reads back"), WrittenVersion), FVoxelFile::Read(File, Read, &ReadVersion)))
+		{
+			continue;
+		}
+		TestEqual(FString::Printf(TEXT("v%u version"), WrittenVersion), ReadVersion, WrittenVersion);
+		if (TestTrue(FString::Printf(TEXT("v%u sizes"), WrittenVersion), SameHeader(Data, Read)))
+		{
+			TestTrue(FString::Printf(TEXT("v%u voxels are bit exact"), WrittenVersion),
+				FMemory::Memcmp(Data.Voxels.GetData(), Read.Voxels.GetData(), Data.Voxels.Num() * sizeof(float)) == 0);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelFileInt16Test, "VoxelCore.File.Int16",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelFileInt16Test::RunTest(const FString& Parameters)
+{
+	const FVoxelFileData Data = MakeTestFileData();
+	// Eight voxels either side of the surface level, the voxels further out are clamped to the ends
+	const float Center = TestSurfaceLevel;
+	const float Range = Data.VoxelSize * 8.f;
+	TArray<uint8> File;
+	FVoxelFile::Write(Data, Center, Range, File);
+	TestTrue(TEXT("Int16 file is smaller than v1"), File.Num() < FVoxelFile::GetV1Size(Data.Voxels.Num()));
+
+	FVoxelFileData Read;
+	uint32 ReadVersion = 0;
+	if (!TestTrue(TEXT("Int16 file reads back"), FVoxelFile::Read(File, Read, &ReadVersion)) || !TestTrue(TEXT("Int16 sizes"), SameHeader(Data, Read)))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Int16 version"), ReadVersion, FVoxelFile::Version);
+
+	// Half a step either way inside the range, plus float rounding
+	const float Tolerance = Range / MAX_int16 * 0.5f + 1e-3f;
+	int32 Mismatches = 0;
+	for (int32 i = 0; i < Data.Voxels.Num(); ++i)
+	{
+		const float Expected = FMath::Clamp(Data.Voxels[i], Center - Range, Center + Range);
+		Mismatches += !FMath::IsNearlyEqual(Read.Voxels[i], Expected, Tolerance);
+	}
+	TestEqual(TEXT("Voxels off by more than half a step"), Mismatches, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelFileCorruptionTest, "VoxelCore.File.RejectsCorruption",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelFileCorruptionTest::RunTest(const FString& Parameters)
+{
+	const FVoxelFileData Data = MakeTestFileData();
+	TArray<uint8> File;
+	FVoxelFile::Write(Data, 0.f, 0.f, File);
+
+	// The CRC covers everything after the magic, flip one bit in the last block and one in the voxel size
+	TArray<uint8> Corrupt = File;
+	Corrupt.Last() ^= 0x10;
+	FVoxelFileData Read;
+	AddExpectedError(TEXT("failed its checksum"), EAutomationExpectedErrorFlags::Contains, 2);
+	TestFalse(TEXT("Flipped bit is rejected"), FVoxelFile::Read(Corrupt, Read));
+	TArray<uint8> CorruptHeader = File;
+	CorruptHeader[5 * sizeof(uint32)] ^= 0x01;
+	TestFalse(TEXT("Flipped bit in the header is rejected"), FVoxelFile::Read(CorruptHeader, Read));
+
+	// Only the version this build writes is read after the magic, older ones included
+	for (const uint32 OtherVersion : { 1u, FVoxelFile::Version + 1 })
+	{
+		TArray<uint8> Other = File;
+		FMemory::Memcpy(Other.GetData() + sizeof(uint32), &OtherVersion, sizeof(OtherVersion));
+		AddExpectedError(FString::Printf(TEXT("Unsupported voxel file version %u"), OtherVersion), EAutomationExpectedErrorFlags::Contains, 1);
+		TestFalse(FString::Printf(TEXT("Version %u after the magic is rejected"), OtherVersion), FVoxelFile::Read(Other, Read));
+	}
+
+	TArray<uint8> Truncated = File;
+	Truncated.SetNum(File.Num() / 2);
+	AddExpectedError(TEXT("is truncated"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestFalse(TEXT("Truncated file is rejected"), FVoxelFile::Read(Truncated, Read));
+
+	TestTrue(TEXT("Untouched file still reads"), FVoxelFile::Read(File, Read));
+	return true;
+}
+
+#endif
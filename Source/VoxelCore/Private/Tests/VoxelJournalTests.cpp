@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelJournal.h"
+#include "VoxelStore.h"
+#include "VoxelTestShapes.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr float TestHoleValue = -TestVoxelSize * 2;
+
+	//Carves, subtracts and unions around the surface of a sphere filling the grid, with a fixed seed
+	void MakeTestEdits(int32 Size, int32 NumEdits, TArray<FVoxelEdit>& Out)
+	{
+		FRandomStream Random(Size);
+		const EVoxelBrushOp Operations[] = { EVoxelBrushOp::Carve, EVoxelBrushOp::Subtract, EVoxelBrushOp::Union };
+		for (int32 i = 0; i < NumEdits; ++i)
+		{
+			const FVector3f Center = FVector3f(Size * 0.5f) + FVector3f(Random.GetUnitVector()) * Size * 0.35f;
+			FVoxelEdit& Edit = Out.AddDefaulted_GetRef();
+			Edit.Sequence = i + 1;
+			Edit.Brush = i % 2 ? FVoxelBrush::MakeSphere(Center, Random.FRandRange(2.f, 5.f))
+				: FVoxelBrush::MakeCapsule(Center, Center + FVector3f(Random.GetUnitVector()) * 4.f, 1.5f);
+			Edit.Brush.Operation = Operations[i % UE_ARRAY_COUNT(Operations)];
+			Edit.Brush.Smoothing = i % 4 == 3 ? 1.f : 0.f;
+		}
+	}
+
+	//The edit the way the actor applies it, with what the journal leaves out filled in
+	FVoxelRegion ApplyEdit(FVoxelStore& Store, const FVoxelEdit& Edit)
+	{
+		FVoxelBrush Brush = Edit.Brush;
+		Brush.HoleValue = TestHoleValue;
+		Brush.DistanceScale = TestVoxelSize;
+		return Store.ApplyBrush(Brush);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelJournalRestoreTest, "VoxelCore.Journal.RestoreMatchesReplay",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelJournalRestoreTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = 40;
+	const FIntVector Dims(Size + 1);
+	TArray<float> Dense;
+	MakeTestShapeVoxels(EVoxelTestShape::Sphere, Size, Dense);
+	FVoxelStore Baseline;
+	Baseline.FromDense(Dims, Dense, TestSurfaceLevel);
+
+	const int32 NumEdits = 24;
+	const int32 SnapshotAt = 14;
+	TArray<FVoxelEdit> Edits;
+	MakeTestEdits(Size, NumEdits, Edits);
+
+	// What every restore has to end up with
+	FVoxelStore Replayed = Baseline;
+	for (const FVoxelEdit& Edit : Edits)
+	{
+		ApplyEdit(Replayed, Edit);
+	}
+	TArray<float> Expected;
+	Replayed.ToDense(Expected);
+
+	const FString BaselinePath = FPaths::AutomationTransientDir() / TEXT("VoxelJournalTest.voxel");
+	const TCHAR* Modes[] = { TEXT("journal only"), TEXT("snapshot and journal"), TEXT("snapshot left as .tmp by a crash") };
+	for (int32 ModeIndex = 0; ModeIndex < UE_ARRAY_COUNT(Modes); ++ModeIndex)
+	{
+		const TCHAR* Mode = Modes[ModeIndex];
+		const bool bSnapshot = ModeIndex > 0;
+		FVoxelJournal::Delete(BaselinePath);
+
+		// Played the way the actor persists: a journal, a snapshot of the changed bricks replacing it, more journal
+		// The snapshot is kept up to date by merging in the bricks changed since it was last taken
+		FVoxelStore Live = Baseline;
+		TSet<int32> ChangedBricks;
+		TSet<int32> DirtyBricks;
+		FVoxelBrickSnapshot Snapshot;
+		for (int32 i = 0; i < NumEdits; ++i)
+		{
+			const FVoxelRegion Edited = ApplyEdit(Live, Edits[i]);
+			Live.CollectBricks(Edited, ChangedBricks);
+			Live.CollectBricks(Edited, DirtyBricks);
+			if (!bSnapshot || (Edits[i].Sequence != SnapshotAt / 2 && Edits[i].Sequence != SnapshotAt))
+			{
+				continue;
+			}
+
+			FVoxelBrickSnapshot Changes;
+			Changes.Sequence = Edits[i].Sequence;
+			Changes.Dims = Dims;
+			TArray<float> BrickValues;
+			for (int32 BrickIndex : DirtyBricks)
+			{
+				float Value = 0.f;
+				Live.GetBrick(BrickIndex, Value, BrickValues);
+				Changes.Bricks.Add(BrickIndex);
+				Changes.bDense.Add(BrickValues.IsEmpty() ? 0 : 1);
+				if (BrickValues.IsEmpty())
+				{
+					Changes.Values.Add(Value);
+				}
+				else
+				{
+					Changes.Values.Append(BrickValues);
+				}
+			}
+			FVoxelJournal::MergeSnapshot(Snapshot, Changes);
+			DirtyBricks.Reset();
+			if (Edits[i].Sequence != SnapshotAt)
+			{
+				continue;
+			}
+			TestEqual(TEXT("Merged snapshot holds every changed brick once"), Snapshot.Bricks.Num(), ChangedBricks.Num());
+			TestTrue(TEXT("Journal before the snapshot is written"), FVoxelJournal::AppendEdits(BaselinePath, Dims, MakeArrayView(Edits.GetData(), SnapshotAt / 2)));
+			TestTrue(TEXT("Snapshot is written"), FVoxelJournal::WriteSnapshot(BaselinePath, Snapshot));
+			if (ModeIndex == 2)
+			{
+				// As if the save died between deleting the old snapshot and moving the new one into place
+				TestTrue(TEXT("Snapshot is moved back to .tmp"),
+					IFileManager::Get().Move(*FVoxelJournal::GetSnapshotTempPath(BaselinePath), *FVoxelJournal::GetSnapshotPath(BaselinePath)));
+			}
+		}
+		const int32 FirstJournaled = bSnapshot ? SnapshotAt : 0;
+		TestTrue(FString::Printf(TEXT("%s: journal is written"), Mode),
+			FVoxelJournal::AppendEdits(BaselinePath, Dims, MakeArrayView(Edits.GetData() + FirstJournaled, NumEdits - FirstJournaled)));
+
+		FVoxelStore Restored = Baseline;
+		TSet<int32> RestoredBricks;
+		uint32 SnapshotSequence = 0;
+		const uint32 Sequence = FVoxelJournal::Restore(BaselinePath, Restored, TestHoleValue, TestVoxelSize, RestoredBricks, SnapshotSequence);
+		TestEqual(FString::Printf(TEXT("%s: last sequence restored"), Mode), Sequence, uint32(NumEdits));
+		TestEqual(FString::Printf(TEXT("%s: snapshot sequence"), Mode), SnapshotSequence, uint32(bSnapshot ? SnapshotAt : 0));
+		TestTrue(FString::Printf(TEXT("%s: every changed brick is reported"), Mode), RestoredBricks.Includes(ChangedBricks));
+
+		TArray<float> Result;
+		Restored.ToDense(Result);
+		TestTrue(FString::Printf(TEXT("%s: restored voxels match replaying every edit"), Mode),
+			Result.Num() == Expected.Num() && FMemory::Memcmp(Result.GetData(), Expected.GetData(), Expected.Num() * sizeof(float)) == 0);
+	}
+	FVoxelJournal::Delete(BaselinePath);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelJournalTornRecordTest, "VoxelCore.Journal.TornRecord",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelJournalTornRecordTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = 40;
+	const FIntVector Dims(Size + 1);
+	const int32 NumEdits = 8;
+	TArray<FVoxelEdit> Edits;
+	MakeTestEdits(Size, NumEdits, Edits);
+
+	const FString BaselinePath = FPaths::AutomationTransientDir() / TEXT("VoxelJournalTornTest.voxel");
+	const FString JournalPath = FVoxelJournal::GetJournalPath(BaselinePath);
+	FVoxelJournal::Delete(BaselinePath);
+	TestTrue(TEXT("Journal is written"), FVoxelJournal::AppendEdits(BaselinePath, Dims, MakeArrayView(Edits.GetData(), NumEdits / 2)));
+	TArray<uint8> Intact;
+	TestTrue(TEXT("Journal is read back"), FFileHelper::LoadFileToArray(Intact, *JournalPath));
+
+	// Every record has the same length, after the 20 byte header
+	const int32 HeaderSize = 5 * sizeof(uint32);
+	const int32 RecordSize = (Intact.Num() - HeaderSize) / (NumEdits / 2);
+
+	// A record damaged in the middle ends the journal there instead of misaligning the ones after it
+	TArray<uint8> Damaged = Intact;
+	Damaged[HeaderSize + RecordSize + RecordSize / 2] ^= 0xFF;
+	FFileHelper::SaveArrayToFile(Damaged, *JournalPath);
+	TArray<FVoxelEdit> Read;
+	FVoxelJournal::ReadEdits(BaselinePath, Dims, Read);
+	TestEqual(TEXT("Edits before the damaged record"), Read.Num(), 1);
+
+	// Half a record left by a crash is cut off before the next append, so what follows it still reads
+	TArray<uint8> Torn = Intact;
+	Torn.Append(Intact.GetData() + HeaderSize, RecordSize / 2);
+	FFileHelper::SaveArrayToFile(Torn, *JournalPath);
+	TestTrue(TEXT("Journal is appended after a torn record"),
+		FVoxelJournal::AppendEdits(BaselinePath, Dims, MakeArrayView(Edits.GetData() + NumEdits / 2, NumEdits - NumEdits / 2)));
+	Read.Reset();
+	FVoxelJournal::ReadEdits(BaselinePath, Dims, Read);
+	TestEqual(TEXT("Edits after appending past a torn record"), Read.Num(), NumEdits);
+	for (int32 i = 0; i < Read.Num(); ++i)
+	{
+		TestEqual(TEXT("Edits come back in order"), Read[i].Sequence, Edits[i].Sequence);
+	}
+	FVoxelJournal::Delete(BaselinePath);
+	return true;
+}
+
+#endif
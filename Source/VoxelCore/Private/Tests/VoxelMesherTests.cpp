@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelMesher.h"
+#include "VoxelTestShapes.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	//Sphere of SphereRadius voxels on a Size^3 grid and a view over all of it
+	void MakeSphereView(int32 Size, double SphereRadius, TArray<float>& Out, FVoxelGridView& OutView)
+	{
+		MakeSphereVoxels(FIntVector(Size), SphereRadius, Out);
+		OutView.Data = Out.GetData();
+		OutView.Dims = FIntVector(Size + 1);
+	}
+
+	FVoxelMeshSettings MakeTestSettings()
+	{
+		FVoxelMeshSettings Settings;
+		Settings.SurfaceLevel = TestSurfaceLevel;
+		Settings.VoxelSize = TestVoxelSize;
+		return Settings;
+	}
+
+	//Whether every edge is used by exactly two triangles, once in each direction
+	bool IsClosed(const FVoxelMeshBuffers& Mesh)
+	{
+		TMap<TPair<int32, int32>, int32> Edges;
+		for (int32 i = 0; i < Mesh.Triangles.Num(); i += 3)
+		{
+			for (int32 k = 0; k < 3; ++k)
+			{
+				++Edges.FindOrAdd(TPair<int32, int32>(Mesh.Triangles[i + k], Mesh.Triangles[i + (k + 1) % 3]));
+			}
+		}
+		for (const TPair<TPair<int32, int32>, int32>& Edge : Edges)
+		{
+			const int32* Opposite = Edges.Find(TPair<int32, int32>(Edge.Key.Value, Edge.Key.Key));
+			if (Edge.Value != 1 || !Opposite || *Opposite != 1)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelMesherSphereTest, "VoxelCore.Mesher.Sphere",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelMesherSphereTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = 32;
+	const double SphereRadius = Size * 0.35;
+	// Where the values cross the surface level
+	const double SurfaceRadius = (SphereRadius - TestSurfaceLevel / TestVoxelSize) * TestVoxelSize;
+	const FVector Center(Size * 0.5 * TestVoxelSize);
+	TArray<float> Voxels;
+	FVoxelGridView View;
+	MakeSphereView(Size, SphereRadius, Voxels, View);
+
+	for (const bool bShared : { false, true })
+	{
+		const TCHAR* Mode = bShared ? TEXT("shared") : TEXT("flat");
+		FVoxelMeshSettings Settings = MakeTestSettings();
+		Settings.bSharedVertices = bShared;
+		// One MarchCells call over the whole grid, MeshJobs would split the shared vertices between its slabs
+		FVoxelMeshBuffers Mesh;
+		FVoxelMesher(Settings, View).MarchCells(FIntVector::ZeroValue, FIntVector(Size), Mesh);
+
+		if (!TestTrue(FString::Printf(TEXT("%s: sphere has triangles"), Mode), Mesh.Triangles.Num() > 0))
+		{
+			continue;
+		}
+		TestEqual(FString::Printf(TEXT("%s: one normal per vertex"), Mode), Mesh.Normals.Num(), Mesh.Vertices.Num());
+
+		// Interpolating along the edges is exact up to the bend of the distance field within a cell
+		double WorstError = 0.0;
+		int32 InwardNormals = 0;
+		for (int32 i = 0; i < Mesh.Vertices.Num(); ++i)
+		{
+			const FVector Offset = Mesh.Vertices[i] - Center;
+			WorstError = FMath::Max(WorstError, FMath::Abs(Offset.Size() - SurfaceRadius));
+			InwardNormals += FVector::DotProduct(Mesh.Normals[i], Offset) <= 0.0;
+		}
+		TestTrue(FString::Printf(TEXT("%s: vertices within a tenth of a voxel of the surface (worst %.3f)"), Mode, WorstError / TestVoxelSize),
+			WorstError < TestVoxelSize * 0.1);
+		TestEqual(FString::Printf(TEXT("%s: normals pointing into the sphere"), Mode), InwardNormals, 0);
+		if (bShared)
+		{
+			TestTrue(TEXT("shared: mesh is closed"), IsClosed(Mesh));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelMesherRowClassificationTest, "VoxelCore.Mesher.RowClassificationMatchesPerCell",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelMesherRowClassificationTest::RunTest(const FString& Parameters)
+{
+	// A bumpy sphere so rows start and end inside and outside at every offset within a SIMD lane
+	const int32 Size = 37;
+	TArray<float> Voxels;
+	FVoxelGridView View;
+	MakeSphereView(Size, Size * 0.35, Voxels, View);
+	for (int32 i = 0; i < Voxels.Num(); ++i)
+	{
+		Voxels[i] += FMath::Sin(i * 0.37f) * TestVoxelSize * 0.8f;
+	}
+
+	// The same voxels as int16 steps, the way a quantized store hands them to the mesher
+	const float Quantum = TestVoxelSize / 256.f;
+	TArray<int16> Steps;
+	Steps.SetNumUninitialized(Voxels.Num());
+	for (int32 i = 0; i < Voxels.Num(); ++i)
+	{
+		Steps[i] = int16(FMath::Clamp(FMath::RoundToInt(Voxels[i] / Quantum), -MAX_int16, MAX_int16));
+	}
+	FVoxelGridView QuantizedView = View;
+	QuantizedView.Data = nullptr;
+	QuantizedView.QuantizedData = Steps.GetData();
+	QuantizedView.Quantum = Quantum;
+
+	for (const bool bQuantized : { false, true })
+	{
+		for (const bool bShared : { false, true })
+		{
+			const FString Mode = FString::Printf(TEXT("%s %s"), bQuantized ? TEXT("int16") : TEXT("float"), bShared ? TEXT("shared") : TEXT("flat"));
+			FVoxelMeshBuffers Meshes[2];
+			for (const bool bRows : { false, true })
+			{
+				FVoxelMeshSettings Settings = MakeTestSettings();
+				Settings.bSharedVertices = bShared;
+				Settings.bRowClassification = bRows;
+				FVoxelMesher(Settings, bQuantized ? QuantizedView : View).MarchCells(FIntVector(1, 0, 2), FIntVector(Size, Size - 1, Size), Meshes[bRows]);
+			}
+			TestTrue(Mode + TEXT(": has triangles"), Meshes[0].Triangles.Num() > 0);
+			TestTrue(Mode + TEXT(": triangles are identical"), Meshes[1].Triangles == Meshes[0].Triangles);
+			TestTrue(Mode + TEXT(": vertices are identical"), Meshes[1].Vertices == Meshes[0].Vertices);
+			TestTrue(Mode + TEXT(": normals are identical"), Meshes[1].Normals == Meshes[0].Normals);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelMesherSurfaceNetsTest, "VoxelCore.Mesher.SurfaceNetsSphere",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelMesherSurfaceNetsTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = 32;
+	const double SphereRadius = Size * 0.35;
+	const double SurfaceRadius = (SphereRadius - TestSurfaceLevel / TestVoxelSize) * TestVoxelSize;
+	const FVector Center(Size * 0.5 * TestVoxelSize);
+	TArray<float> Voxels;
+	FVoxelGridView View;
+	MakeSphereView(Size, SphereRadius, Voxels, View);
+
+	// Away from the grid's faces so the cells below CellMin can be read
+	FVoxelMeshSettings Settings = MakeTestSettings();
+	Settings.bSurfaceNets = true;
+	FVoxelMeshBuffers Mesh;
+	FVoxelMesher(Settings, View).MarchCells(FIntVector(1), FIntVector(Size - 1), Mesh);
+	if (!TestTrue(TEXT("Sphere has triangles"), Mesh.Triangles.Num() > 0))
+	{
+		return false;
+	}
+
+	// One quad across every voxel edge the surface crosses
+	int32 CrossedEdges = 0;
+	for (int32 Z = 0; Z <= Size; ++Z)
+	{
+		for (int32 Y = 0; Y <= Size; ++Y)
+		{
+			for (int32 X = 0; X <= Size; ++X)
+			{
+				const bool bBelow = View.Get(X, Y, Z) <= TestSurfaceLevel;
+				CrossedEdges += X < Size && bBelow != (View.Get(X + 1, Y, Z) <= TestSurfaceLevel);
+				CrossedEdges += Y < Size && bBelow != (View.Get(X, Y + 1, Z) <= TestSurfaceLevel);
+				CrossedEdges += Z < Size && bBelow != (View.Get(X, Y, Z + 1) <= TestSurfaceLevel);
+			}
+		}
+	}
+	TestEqual(TEXT("Two triangles per crossed voxel edge"), Mesh.Triangles.Num() / 3, CrossedEdges * 2);
+
+	// The vertex averages the edge crossings of its cell, so it sits a little inside the curve
+	double WorstError = 0.0;
+	int32 InwardNormals = 0;
+	for (int32 i = 0; i < Mesh.Vertices.Num(); ++i)
+	{
+		const FVector Offset = Mesh.Vertices[i] - Center;
+		WorstError = FMath::Max(WorstError, FMath::Abs(Offset.Size() - SurfaceRadius));
+		InwardNormals += FVector::DotProduct(Mesh.Normals[i], Offset) <= 0.0;
+	}
+	TestTrue(FString::Printf(TEXT("Vertices within a quarter of a voxel of the surface (worst %.3f)"), WorstError / TestVoxelSize),
+		WorstError < TestVoxelSize * 0.25);
+	TestEqual(TEXT("Normals pointing into the sphere"), InwardNormals, 0);
+
+	// Closed, and with the Euler characteristic of a sphere, so there are no handles or stray pieces
+	TestTrue(TEXT("Mesh is closed"), IsClosed(Mesh));
+	TSet<TPair<int32, int32>> Edges;
+	for (int32 i = 0; i < Mesh.Triangles.Num(); i += 3)
+	{
+		for (int32 k = 0; k < 3; ++k)
+		{
+			const int32 A = Mesh.Triangles[i + k];
+			const int32 B = Mesh.Triangles[i + (k + 1) % 3];
+			Edges.Add(TPair<int32, int32>(FMath::Min(A, B), FMath::Max(A, B)));
+		}
+	}
+	TestEqual(TEXT("Euler characteristic"), Mesh.Vertices.Num() - Edges.Num() + Mesh.Triangles.Num() / 3, 2);
+	return true;
+}
+
+#endif
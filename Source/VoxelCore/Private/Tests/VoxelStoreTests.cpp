@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VoxelStore.h"
+#include "VoxelTestShapes.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelStoreRoundTripTest, "VoxelCore.Store.RoundTrip",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelStoreRoundTripTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = 40;
+	const FIntVector Dims(Size + 1);
+	TArray<float> Dense;
+	MakeTestShapeVoxels(EVoxelTestShape::Sphere, Size, Dense);
+
+	FVoxelStore Store;
+	Store.FromDense(Dims, Dense, TestSurfaceLevel);
+	TestTrue(TEXT("Bricks away from the surface collapsed"), Store.NumDenseBricks() < Store.GetUniformMask().Num());
+
+	TArray<float> RoundTrip;
+	Store.ToDense(RoundTrip);
+	if (!TestEqual(TEXT("Voxel count"), RoundTrip.Num(), Dense.Num()))
+	{
+		return false;
+	}
+
+	// Expanded bricks keep every value, collapsed ones only which side of the surface their voxels are on
+	int32 ValueMismatches = 0;
+	int32 SideMismatches = 0;
+	int32 GetMismatches = 0;
+	for (int32 Z = 0; Z < Dims.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < Dims.Y; ++Y)
+		{
+			for (int32 X = 0; X < Dims.X; ++X)
+			{
+				const int32 Index = (Z * Dims.Y + Y) * Dims.X + X;
+				const int32 Brick = Store.GetBrickIndex(X / FVoxelStore::BrickSize, Y / FVoxelStore::BrickSize, Z / FVoxelStore::BrickSize);
+				if (!Store.GetUniformMask()[Brick])
+				{
+					ValueMismatches += RoundTrip[Index] != Dense[Index];
+				}
+				SideMismatches += (RoundTrip[Index] <= TestSurfaceLevel) != (Dense[Index] <= TestSurfaceLevel);
+				GetMismatches += Store.Get(X, Y, Z) != RoundTrip[Index];
+			}
+		}
+	}
+	TestEqual(TEXT("Values changed in expanded bricks"), ValueMismatches, 0);
+	TestEqual(TEXT("Voxels moved across the surface"), SideMismatches, 0);
+	TestEqual(TEXT("Get disagrees with ToDense"), GetMismatches, 0);
+
+	// Writing into a collapsed brick expands it and the value reads back
+	Store.Set(1, 1, 1, 5.f);
+	TestEqual(TEXT("Set then Get in a collapsed brick"), Store.Get(1, 1, 1), 5.f);
+	TestTrue(TEXT("Corner brick has a surface after the write"), Store.MayContainSurface(FIntVector(0), FIntVector(1)));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelStoreApplyBrushTest, "VoxelCore.Store.ApplyBrush",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FVoxelStoreApplyBrushTest::RunTest(const FString& Parameters)
+{
+	const int32 Size = 40;
+	const FIntVector Dims(Size + 1);
+	TArray<float> Dense;
+	MakeTestShapeVoxels(EVoxelTestShape::Sphere, Size, Dense);
+
+	const EVoxelBrushOp Operations[] = { EVoxelBrushOp::Carve, EVoxelBrushOp::Subtract, EVoxelBrushOp::Union };
+	const TCHAR* OperationNames[] = { TEXT("Carve"), TEXT("Subtract"), TEXT("Union") };
+	for (int32 Op = 0; Op < UE_ARRAY_COUNT(Operations); ++Op)
+	{
+		FVoxelStore Store;
+		Store.FromDense(Dims, Dense, TestSurfaceLevel);
+
+		// On the sphere's surface so the brush both removes and adds solid
+		FVoxelBrush Brush = FVoxelBrush::MakeSphere(FVector3f(Size * 0.5f + Size * 0.35f, Size * 0.5f, Size * 0.5f), 5.f);
+		Brush.Operation = Operations[Op];
+		Brush.DistanceScale = TestVoxelSize;
+		Brush.HoleValue = -TestVoxelSize * 2;
+		const FVoxelRegion Region = Store.ApplyBrush(Brush);
+		TestFalse(FString::Printf(TEXT("%s changed voxels"), OperationNames[Op]), Region.IsEmpty());
+
+		// The same combination voxel by voxel over the brush's bounds
+		TArray<float> Expected = Dense;
+		FIntVector BoundsMin;
+		FIntVector BoundsMax;
+		Brush.GetBounds(BoundsMin, BoundsMax);
+		BoundsMin = BoundsMin.ComponentMax(FIntVector::ZeroValue);
+		BoundsMax = BoundsMax.ComponentMin(Dims - FIntVector(1));
+		for (int32 Z = BoundsMin.Z; Z <= BoundsMax.Z; ++Z)
+		{
+			for (int32 Y = BoundsMin.Y; Y <= BoundsMax.Y; ++Y)
+			{
+				for (int32 X = BoundsMin.X; X <= BoundsMax.X; ++X)
+				{
+					float& Value = Expected[(Z * Dims.Y + Y) * Dims.X + X];
+					const float Distance = Brush.GetDistance(FVector3f(X, Y, Z)) * Brush.DistanceScale;
+					switch (Brush.Operation)
+					{
+					case EVoxelBrushOp::Carve:
+						Value = Distance > 0.f ? FMath::Min(Value, Brush.HoleValue) : Value;
+						break;
+					case EVoxelBrushOp::Subtract:
+						Value = FMath::Min(Value, -Distance);
+						break;
+					default:
+						Value = FMath::Max(Value, Distance);
+						break;
+					}
+				}
+			}
+		}
+
+		TArray<float> Result;
+		Store.ToDense(Result);
+		int32 SideMismatches = 0;
+		int32 OutsideRegion = 0;
+		for (int32 Z = 0; Z < Dims.Z; ++Z)
+		{
+			for (int32 Y = 0; Y < Dims.Y; ++Y)
+			{
+				for (int32 X = 0; X < Dims.X; ++X)
+				{
+					const int32 Index = (Z * Dims.Y + Y) * Dims.X + X;
+					const bool bBelow = Result[Index] <= TestSurfaceLevel;
+					SideMismatches += bBelow != (Expected[Index] <= TestSurfaceLevel);
+					const bool bInRegion = X >= Region.Min.X && X <= Region.Max.X && Y >= Region.Min.Y && Y <= Region.Max.Y
+						&& Z >= Region.Min.Z && Z <= Region.Max.Z;
+					OutsideRegion += !bInRegion && bBelow != (Dense[Index] <= TestSurfaceLevel);
+				}
+			}
+		}
+		TestEqual(FString::Printf(TEXT("%s: voxels on the wrong side of the surface"), OperationNames[Op]), SideMismatches, 0);
+		TestEqual(FString::Printf(TEXT("%s: changed voxels outside the returned region"), OperationNames[Op]), OutsideRegion, 0);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMesher.h"
+#include "VoxelStore.h"
+#include "Async/ParallelFor.h"
+
+//Voxels shared by the VoxelCore tests and the benchmarks. Positive inside and in world units like the baked voxels.
+//Sizes count cells, there is one more voxel than cells along each axis, X rows first.
+
+//The actor's defaults
+constexpr float TestSurfaceLevel = -10.f;
+constexpr float TestVoxelSize = 20.f;
+constexpr int32 TestChunkSize = 16;
+
+enum class EVoxelTestShape : uint8
+{
+	Sphere,
+	Box,
+	Wall
+};
+
+inline const TCHAR* GetTestShapeName(EVoxelTestShape Shape)
+{
+	switch (Shape)
+	{
+	case EVoxelTestShape::Sphere: return TEXT("Sphere");
+	case EVoxelTestShape::Box: return TEXT("Box");
+	default: return TEXT("Wall");
+	}
+}
+
+inline float SphereDistance(const FVector& P, const FVector& Center, double Radius)
+{
+	return (Radius - FVector::Dist(P, Center)) * TestVoxelSize;
+}
+
+//The shape centred in a Size^3 grid at voxel P. The sphere has a radius of 0.35 Size, the box and the wall are
+//rounded boxes of 0.6 Size and 0.8 by 0.16 by 0.8 Size.
+inline float SampleTestShape(EVoxelTestShape Shape, const FVector& P, int32 Size)
+{
+	const FVector Center(Size * 0.5);
+	if (Shape == EVoxelTestShape::Sphere)
+	{
+		return SphereDistance(P, Center, Size * 0.35);
+	}
+	const FVector HalfExtent = Shape == EVoxelTestShape::Box ? FVector(Size * 0.3) : FVector(Size * 0.4, Size * 0.08, Size * 0.4);
+	const FVector Q = (P - Center).GetAbs() - HalfExtent;
+	return -(Q.ComponentMax(FVector::ZeroVector).Size() + FMath::Min(Q.GetMax(), 0.0)) * TestVoxelSize;
+}
+
+//Sphere of Radius voxels centred in a grid of Cells
+inline void MakeSphereVoxels(const FIntVector& Cells, double Radius, TArray<float>& Out)
+{
+	const FIntVector Dims = Cells + FIntVector(1);
+	const FVector Center = FVector(Cells) * 0.5;
+	Out.SetNumUninitialized(Dims.X * Dims.Y * Dims.Z);
+	ParallelFor(Dims.Z, [&](int32 Z)
+	{
+		for (int32 Y = 0; Y < Dims.Y; ++Y)
+		{
+			for (int32 X = 0; X < Dims.X; ++X)
+			{
+				Out[(Z * Dims.Y + Y) * Dims.X + X] = SphereDistance(FVector(X, Y, Z), Center, Radius);
+			}
+		}
+	});
+}
+
+inline void MakeTestShapeVoxels(EVoxelTestShape Shape, int32 Size, TArray<float>& Out)
+{
+	const int32 Dim = Size + 1;
+	Out.SetNumUninitialized(Dim * Dim * Dim);
+	ParallelFor(Dim, [&](int32 Z)
+	{
+		for (int32 Y = 0; Y < Dim; ++Y)
+		{
+			for (int32 X = 0; X < Dim; ++X)
+			{
+				Out[(Z * Dim + Y) * Dim + X] = SampleTestShape(Shape, FVector(X, Y, Z), Size);
+			}
+		}
+	});
+}
+
+//Chunk jobs of ChunkSize cells covering a Size^3 grid, in the layout the actor uses
+inline void MakeTestChunkJobs(int32 Size, int32 ChunkSize, TArray<FVoxelMeshBuffers>& Buffers, TArray<FVoxelMesher::FJob>& Jobs)
+{
+	const int32 NumChunks = FMath::DivideAndRoundUp(Size, ChunkSize);
+	Buffers.Reset();
+	Buffers.SetNum(NumChunks * NumChunks * NumChunks);
+	Jobs.Reset();
+	for (int32 CZ = 0; CZ < NumChunks; ++CZ)
+	{
+		for (int32 CY = 0; CY < NumChunks; ++CY)
+		{
+			for (int32 CX = 0; CX < NumChunks; ++CX)
+			{
+				const FIntVector CellMin = FIntVector(CX, CY, CZ) * ChunkSize;
+				const FIntVector CellMax = (CellMin + FIntVector(ChunkSize)).ComponentMin(FIntVector(Size));
+				Jobs.Add({ CellMin, CellMax, &Buffers[Jobs.Num()] });
+			}
+		}
+	}
+}
+
+//View over dense values starting at Origin, skipping the store's empty bricks
+inline FVoxelGridView MakeTestView(const TArray<float>& Values, const FIntVector& Origin, const FIntVector& Dims, const FVoxelStore& Store)
+{
+	FVoxelGridView View;
+	View.Data = Values.GetData();
+	View.Origin = Origin;
+	View.Dims = Dims;
+	View.EmptyBricks = Store.GetEmptyMask().GetData();
+	View.NumBricks = Store.GetNumBricks();
+	View.BrickSize = FVoxelStore::BrickSize;
+	return View;
+}
+
+inline FVoxelGridView MakeTestView(const FVoxelBoxCopy& Copy, const FIntVector& Origin, const FIntVector& Dims, const FVoxelStore& Store)
+{
+	FVoxelGridView View = MakeTestView(Copy.Values, Origin, Dims, Store);
+	if (!Copy.Steps.IsEmpty())
+	{
+		View.QuantizedData = Copy.Steps.GetData();
+		View.Quantum = Copy.Quantum;
+	}
+	return View;
+}
@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TriangleBVH.h"
+
+#include "Algo/Sort.h"
+
+void FTriangleBVH::Build(const TArray<FVector>& Vertices, const TArray<int>& Indices)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	Nodes.Reset();
+	TriangleIds.Reset();
+	Corners.Reset();
+
+	const int32 TriangleCount = Indices.Num() / 3;
+	if (TriangleCount == 0)
+	{
+		BuildSeconds = FPlatformTime::Seconds() - StartTime;
+		return;
+	}
+
+	TArray<FVector> Centroids;
+	TArray<FBox> TriangleBounds;
+	Centroids.SetNumUninitialized(TriangleCount);
+	TriangleBounds.SetNumUninitialized(TriangleCount);
+	TriangleIds.SetNumUninitialized(TriangleCount);
+	for (int32 i = 0; i < TriangleCount; ++i)
+	{
+		const FVector& A = Vertices[Indices[i * 3]];
+		const FVector& B = Vertices[Indices[i * 3 + 1]];
+		const FVector& C = Vertices[Indices[i * 3 + 2]];
+		Centroids[i] = (A + B + C) / 3.0;
+		TriangleBounds[i] = FBox(A.ComponentMin(B).ComponentMin(C), A.ComponentMax(B).ComponentMax(C));
+		TriangleIds[i] = i;
+	}
+
+	// Worst case is one leaf per triangle
+	Nodes.Reserve(TriangleCount * 2);
+	BuildNode(Centroids, TriangleBounds, 0, TriangleCount);
+
+	// Keep the corners next to each other in leaf order so the queries walk memory linearly
+	Corners.SetNumUninitialized(TriangleCount * 3);
+	for (int32 i = 0; i < TriangleCount; ++i)
+	{
+		const int32 Triangle = TriangleIds[i];
+		Corners[i * 3] = Vertices[Indices[Triangle * 3]];
+		Corners[i * 3 + 1] = Vertices[Indices[Triangle * 3 + 1]];
+		Corners[i * 3 + 2] = Vertices[Indices[Triangle * 3 + 2]];
+	}
+
+	BuildSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+int32 FTriangleBVH::BuildNode(const TArray<FVector>& Centroids, const TArray<FBox>& TriangleBounds, int32 Start, int32 Count)
+{
+	const int32 NodeIndex = Nodes.AddDefaulted();
+
+	FBox Bounds(ForceInit);
+	FBox CentroidBounds(ForceInit);
+	for (int32 i = Start; i < Start + Count; ++i)
+	{
+		Bounds += TriangleBounds[TriangleIds[i]];
+		CentroidBounds += Centroids[TriangleIds[i]];
+	}
+	Nodes[NodeIndex].Bounds = Bounds;
+	Nodes[NodeIndex].Start = Start;
+
+	if (Count <= MaxLeafTriangles)
+	{
+		Nodes[NodeIndex].Count = Count;
+		return NodeIndex;
+	}
+
+	// Median split on the longest axis of the centroids
+	const FVector Extent = CentroidBounds.GetSize();
+	const int32 Axis = Extent.X >= Extent.Y && Extent.X >= Extent.Z ? 0 : (Extent.Y >= Extent.Z ? 1 : 2);
+	Algo::Sort(MakeArrayView(TriangleIds.GetData() + Start, Count), [&Centroids, Axis](int32 A, int32 B)
+	{
+		return Centroids[A][Axis] < Centroids[B][Axis];
+	});
+
+	// The left child is always the next node, only the right one needs remembering
+	const int32 LeftCount = Count / 2;
+	BuildNode(Centroids, TriangleBounds, Start, LeftCount);
+	const int32 Right = BuildNode(Centroids, TriangleBounds, Start + LeftCount, Count - LeftCount);
+	Nodes[NodeIndex].RightChild = Right;
+	return NodeIndex;
+}
+
+float FTriangleBVH::ClosestDistance(const FVector& P, int32* OutTriangle, FVector* OutClosestPoint) const
+{
+	double BestDistSquared = DBL_MAX;
+	int32 BestTriangle = INDEX_NONE;
+	FVector BestPoint = FVector::ZeroVector;
+	if (Nodes.IsEmpty())
+	{
+		return FLT_MAX;
+	}
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Push(0);
+	while (!Stack.IsEmpty())
+	{
+		const FNode& Node = Nodes[Stack.Pop(EAllowShrinking::No)];
+		if (Node.Bounds.ComputeSquaredDistanceToPoint(P) >= BestDistSquared)
+		{
+			continue;
+		}
+
+		if (Node.Count > 0)
+		{
+			for (int32 i = Node.Start; i < Node.Start + Node.Count; ++i)
+			{
+				const FVector Closest = FMath::ClosestPointOnTriangleToPoint(P, Corners[i * 3], Corners[i * 3 + 1], Corners[i * 3 + 2]);
+				const double DistSquared = FVector::DistSquared(P, Closest);
+				if (DistSquared < BestDistSquared)
+				{
+					BestDistSquared = DistSquared;
+					BestTriangle = TriangleIds[i];
+					BestPoint = Closest;
+				}
+			}
+			continue;
+		}
+
+		// Visit the nearer child first so the far one is more likely to be pruned
+		const int32 Left = static_cast<int32>(&Node - Nodes.GetData()) + 1;
+		const int32 Right = Node.RightChild;
+		const double LeftDist = Nodes[Left].Bounds.ComputeSquaredDistanceToPoint(P);
+		const double RightDist = Nodes[Right].Bounds.ComputeSquaredDistanceToPoint(P);
+		if (LeftDist < RightDist)
+		{
+			Stack.Push(Right);
+			Stack.Push(Left);
+		}
+		else
+		{
+			Stack.Push(Left);
+			Stack.Push(Right);
+		}
+	}
+
+	if (OutTriangle)
+	{
+		*OutTriangle = BestTriangle * 3;
+	}
+	if (OutClosestPoint)
+	{
+		*OutClosestPoint = BestPoint;
+	}
+	return FMath::Sqrt(BestDistSquared);
+}
+
+int32 FTriangleBVH::CountSegmentHits(const FVector& Start, const FVector& End) const
+{
+	if (Nodes.IsEmpty())
+	{
+		return 0;
+	}
+
+	const FVector Dir = End - Start;
+	const FVector InvDir(
+		Dir.X != 0.0 ? 1.0 / Dir.X : 0.0,
+		Dir.Y != 0.0 ? 1.0 / Dir.Y : 0.0,
+		Dir.Z != 0.0 ? 1.0 / Dir.Z : 0.0);
+
+	int32 Hits = 0;
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Push(0);
+	while (!Stack.IsEmpty())
+	{
+		const int32 NodeIndex = Stack.Pop(EAllowShrinking::No);
+		const FNode& Node = Nodes[NodeIndex];
+		if (!SegmentHitsBox(Node.Bounds, Start, InvDir, Dir))
+		{
+			continue;
+		}
+
+		if (Node.Count > 0)
+		{
+			for (int32 i = Node.Start; i < Node.Start + Node.Count; ++i)
+			{
+				FVector HitPoint;
+				FVector HitNormal;
+				if (FMath::SegmentTriangleIntersection(Start, End, Corners[i * 3], Corners[i * 3 + 1], Corners[i * 3 + 2], HitPoint, HitNormal))
+				{
+					++Hits;
+				}
+			}
+			continue;
+		}
+
+		Stack.Push(NodeIndex + 1);
+		Stack.Push(Node.RightChild);
+	}
+	return Hits;
+}
+
+bool FTriangleBVH::SegmentHitsBox(const FBox& Box, const FVector& Start, const FVector& InvDir, const FVector& Dir)
+{
+	// Padded so triangles lying flat on a box face are never culled
+	const FBox Padded = Box.ExpandBy(UE_KINDA_SMALL_NUMBER * 10.0);
+
+	double TMin = 0.0;
+	double TMax = 1.0;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (Dir[Axis] == 0.0)
+		{
+			if (Start[Axis] < Padded.Min[Axis] || Start[Axis] > Padded.Max[Axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		double T1 = (Padded.Min[Axis] - Start[Axis]) * InvDir[Axis];
+		double T2 = (Padded.Max[Axis] - Start[Axis]) * InvDir[Axis];
+		if (T1 > T2)
+		{
+			Swap(T1, T2);
+		}
+		TMin = FMath::Max(TMin, T1);
+		TMax = FMath::Min(TMax, T2);
+		if (TMin > TMax)
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelBrush.h"
+
+namespace
+{
+	FORCEINLINE VectorRegister4Float VectorLength3(const VectorRegister4Float& X, const VectorRegister4Float& Y, const VectorRegister4Float& Z)
+	{
+		return VectorSqrt(VectorMultiplyAdd(X, X, VectorMultiplyAdd(Y, Y, VectorMultiply(Z, Z))));
+	}
+
+	FORCEINLINE VectorRegister4Float VectorClamp01(const VectorRegister4Float& X)
+	{
+		return VectorMin(VectorMax(X, VectorZeroFloat()), VectorOneFloat());
+	}
+}
+
+FVoxelBrush FVoxelBrush::MakeSphere(const FVector3f& Center, float Radius)
+{
+	FVoxelBrush Brush;
+	Brush.Shape = EVoxelBrushShape::Sphere;
+	Brush.Start = Center;
+	Brush.End = Center;
+	Brush.Radius = Radius;
+	return Brush;
+}
+
+FVoxelBrush FVoxelBrush::MakeCapsule(const FVector3f& Start, const FVector3f& End, float Radius)
+{
+	FVoxelBrush Brush;
+	Brush.Shape = EVoxelBrushShape::Capsule;
+	Brush.Start = Start;
+	Brush.End = End;
+	Brush.Radius = Radius;
+	return Brush;
+}
+
+FVoxelBrush FVoxelBrush::MakeBox(const FVector3f& Center, const FVector3f& Extent, const FQuat4f& Rotation)
+{
+	FVoxelBrush Brush;
+	Brush.Shape = EVoxelBrushShape::Box;
+	Brush.Start = Center;
+	Brush.End = Center;
+	Brush.Extent = Extent;
+	Brush.Rotation = Rotation;
+	return Brush;
+}
+
+FVoxelBrush FVoxelBrush::MakeCone(const FVector3f& Base, const FVector3f& Tip, float Radius)
+{
+	FVoxelBrush Brush;
+	Brush.Shape = EVoxelBrushShape::Cone;
+	Brush.Start = Base;
+	Brush.End = Tip;
+	Brush.Radius = Radius;
+	return Brush;
+}
+
+void FVoxelBrush::GetBounds(FIntVector& OutMin, FIntVector& OutMax) const
+{
+	FVector3f HalfSize(Radius);
+	if (Shape == EVoxelBrushShape::Box)
+	{
+		HalfSize = Rotation.GetAxisX().GetAbs() * Extent.X + Rotation.GetAxisY().GetAbs() * Extent.Y + Rotation.GetAxisZ().GetAbs() * Extent.Z;
+	}
+	const float Padding = Operation == EVoxelBrushOp::Carve ? 0.f : Smoothing + 2.f;
+	const FVector3f Min = Start.ComponentMin(End) - HalfSize - FVector3f(Padding);
+	const FVector3f Max = Start.ComponentMax(End) + HalfSize + FVector3f(Padding);
+	OutMin = FIntVector(FMath::FloorToInt(Min.X), FMath::FloorToInt(Min.Y), FMath::FloorToInt(Min.Z));
+	OutMax = FIntVector(FMath::CeilToInt(Max.X), FMath::CeilToInt(Max.Y), FMath::CeilToInt(Max.Z));
+}
+
+float FVoxelBrush::GetDistance(const FVector3f& P) const
+{
+	float Lanes[4];
+	GetRowDistances(P, 1, Lanes);
+	return Lanes[0];
+}
+
+void FVoxelBrush::GetRowDistances(const FVector3f& RowStart, int32 Count, float* Out) const
+{
+	// Only X changes along a row, everything that depends on Y and Z alone is worked out once per row
+	const VectorRegister4Float LaneOffsets = MakeVectorRegisterFloat(0.f, 1.f, 2.f, 3.f);
+	const FVector3f P = RowStart - Start;
+	switch (Shape)
+	{
+	case EVoxelBrushShape::Sphere:
+	{
+		const VectorRegister4Float DistanceYZ = VectorSetFloat1(P.Y * P.Y + P.Z * P.Z);
+		const VectorRegister4Float R = VectorSetFloat1(Radius);
+		for (int32 i = 0; i < Count; i += 4)
+		{
+			const VectorRegister4Float X = VectorAdd(VectorSetFloat1(P.X + i), LaneOffsets);
+			VectorStore(VectorSubtract(R, VectorSqrt(VectorMultiplyAdd(X, X, DistanceYZ))), Out + i);
+		}
+		break;
+	}
+	case EVoxelBrushShape::Capsule:
+	{
+		// Distance to the closest point of the segment, Start + Axis * H
+		const FVector3f Axis = End - Start;
+		const VectorRegister4Float AxisX = VectorSetFloat1(Axis.X);
+		const VectorRegister4Float AxisY = VectorSetFloat1(Axis.Y);
+		const VectorRegister4Float AxisZ = VectorSetFloat1(Axis.Z);
+		const VectorRegister4Float InvAxisSquared = VectorSetFloat1(1.f / FMath::Max(Axis.SizeSquared(), UE_SMALL_NUMBER));
+		const VectorRegister4Float DotYZ = VectorSetFloat1(P.Y * Axis.Y + P.Z * Axis.Z);
+		const VectorRegister4Float PY = VectorSetFloat1(P.Y);
+		const VectorRegister4Float PZ = VectorSetFloat1(P.Z);
+		const VectorRegister4Float R = VectorSetFloat1(Radius);
+		for (int32 i = 0; i < Count; i += 4)
+		{
+			const VectorRegister4Float X = VectorAdd(VectorSetFloat1(P.X + i), LaneOffsets);
+			const VectorRegister4Float H = VectorClamp01(VectorMultiply(VectorMultiplyAdd(X, AxisX, DotYZ), InvAxisSquared));
+			const VectorRegister4Float DX = VectorSubtract(X, VectorMultiply(AxisX, H));
+			const VectorRegister4Float DY = VectorSubtract(PY, VectorMultiply(AxisY, H));
+			const VectorRegister4Float DZ = VectorSubtract(PZ, VectorMultiply(AxisZ, H));
+			VectorStore(VectorSubtract(R, VectorLength3(DX, DY, DZ)), Out + i);
+		}
+		break;
+	}
+	case EVoxelBrushShape::Box:
+	{
+		// A row is a straight line in box space too, lane i sits at Local + Step * i
+		const FVector3f Local = Rotation.UnrotateVector(P);
+		const FVector3f Step = Rotation.UnrotateVector(FVector3f::XAxisVector);
+		const VectorRegister4Float LocalX = VectorSetFloat1(Local.X);
+		const VectorRegister4Float LocalY = VectorSetFloat1(Local.Y);
+		const VectorRegister4Float LocalZ = VectorSetFloat1(Local.Z);
+		const VectorRegister4Float StepX = VectorSetFloat1(Step.X);
+		const VectorRegister4Float StepY = VectorSetFloat1(Step.Y);
+		const VectorRegister4Float StepZ = VectorSetFloat1(Step.Z);
+		const VectorRegister4Float ExtentX = VectorSetFloat1(Extent.X);
+		const VectorRegister4Float ExtentY = VectorSetFloat1(Extent.Y);
+		const VectorRegister4Float ExtentZ = VectorSetFloat1(Extent.Z);
+		const VectorRegister4Float Zero = VectorZeroFloat();
+		for (int32 i = 0; i < Count; i += 4)
+		{
+			const VectorRegister4Float Lane = VectorAdd(VectorSetFloat1(float(i)), LaneOffsets);
+			const VectorRegister4Float QX = VectorSubtract(VectorAbs(VectorMultiplyAdd(StepX, Lane, LocalX)), ExtentX);
+			const VectorRegister4Float QY = VectorSubtract(VectorAbs(VectorMultiplyAdd(StepY, Lane, LocalY)), ExtentY);
+			const VectorRegister4Float QZ = VectorSubtract(VectorAbs(VectorMultiplyAdd(StepZ, Lane, LocalZ)), ExtentZ);
+			const VectorRegister4Float Outside = VectorLength3(VectorMax(QX, Zero), VectorMax(QY, Zero), VectorMax(QZ, Zero));
+			const VectorRegister4Float Inside = VectorMin(VectorMax(QX, VectorMax(QY, QZ)), Zero);
+			VectorStore(VectorNegate(VectorAdd(Outside, Inside)), Out + i);
+		}
+		break;
+	}
+	case EVoxelBrushShape::Cone:
+	{
+		// Exact capped cone with a zero radius cap, https://iquilezles.org/articles/distfunctions/
+		// X is the distance from the axis, H how far along it (0 at the base, 1 at the tip). CapX, CapY are the
+		// offsets to the base disc and SideX, SideY the offsets to the slanted side.
+		const FVector3f Axis = End - Start;
+		const float AxisSquared = FMath::Max(Axis.SizeSquared(), UE_SMALL_NUMBER);
+		const VectorRegister4Float AxisX = VectorSetFloat1(Axis.X);
+		const VectorRegister4Float InvAxisSquared = VectorSetFloat1(1.f / AxisSquared);
+		const VectorRegister4Float AxisSq = VectorSetFloat1(AxisSquared);
+		const VectorRegister4Float DotYZ = VectorSetFloat1(P.Y * Axis.Y + P.Z * Axis.Z);
+		const VectorRegister4Float DistanceYZ = VectorSetFloat1(P.Y * P.Y + P.Z * P.Z);
+		const VectorRegister4Float R = VectorSetFloat1(Radius);
+		const VectorRegister4Float InvSlant = VectorSetFloat1(1.f / (Radius * Radius + AxisSquared));
+		const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+		const VectorRegister4Float Zero = VectorZeroFloat();
+		for (int32 i = 0; i < Count; i += 4)
+		{
+			const VectorRegister4Float X = VectorAdd(VectorSetFloat1(P.X + i), LaneOffsets);
+			const VectorRegister4Float H = VectorMultiply(VectorMultiplyAdd(X, AxisX, DotYZ), InvAxisSquared);
+			const VectorRegister4Float PointSquared = VectorMultiplyAdd(X, X, DistanceYZ);
+			const VectorRegister4Float Radial = VectorSqrt(VectorMax(VectorSubtract(PointSquared, VectorMultiply(VectorMultiply(H, H), AxisSq)), Zero));
+
+			const VectorRegister4Float CapRadius = VectorSelect(VectorCompareLT(H, Half), R, Zero);
+			const VectorRegister4Float CapX = VectorMax(VectorSubtract(Radial, CapRadius), Zero);
+			const VectorRegister4Float CapY = VectorSubtract(VectorAbs(VectorSubtract(H, Half)), Half);
+
+			const VectorRegister4Float FromRim = VectorSubtract(Radial, R);
+			const VectorRegister4Float F = VectorClamp01(VectorMultiply(VectorMultiplyAdd(H, AxisSq, VectorNegate(VectorMultiply(R, FromRim))), InvSlant));
+			const VectorRegister4Float SideX = VectorMultiplyAdd(F, R, FromRim);
+			const VectorRegister4Float SideY = VectorSubtract(H, F);
+
+			const VectorRegister4Float CapSquared = VectorMultiplyAdd(CapX, CapX, VectorMultiply(VectorMultiply(CapY, CapY), AxisSq));
+			const VectorRegister4Float SideSquared = VectorMultiplyAdd(SideX, SideX, VectorMultiply(VectorMultiply(SideY, SideY), AxisSq));
+			const VectorRegister4Float Distance = VectorSqrt(VectorMin(CapSquared, SideSquared));
+			const VectorRegister4Float bInside = VectorBitwiseAnd(VectorCompareLT(SideX, Zero), VectorCompareLT(CapY, Zero));
+			VectorStore(VectorSelect(bInside, Distance, VectorNegate(Distance)), Out + i);
+		}
+		break;
+	}
+	}
+}
+
+void FVoxelBrush::CombineRow(const float* Distances, int32 Count, float* Values) const
+{
+	const VectorRegister4Float Scale = VectorSetFloat1(Operation == EVoxelBrushOp::Subtract ? -DistanceScale : DistanceScale);
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	if (Operation == EVoxelBrushOp::Carve)
+	{
+		const VectorRegister4Float Hole = VectorSetFloat1(HoleValue);
+		for (int32 i = 0; i < Count; i += 4)
+		{
+			const VectorRegister4Float Value = VectorLoad(Values + i);
+			const VectorRegister4Float bInside = VectorCompareGT(VectorLoad(Distances + i), Zero);
+			VectorStore(VectorSelect(bInside, VectorMin(Value, Hole), Value), Values + i);
+		}
+		return;
+	}
+
+	// Polynomial smooth min, https://iquilezles.org/articles/smin/. Union is the same with both sides negated.
+	const bool bSubtract = Operation == EVoxelBrushOp::Subtract;
+	const float K = Smoothing * DistanceScale;
+	const VectorRegister4Float Blend = VectorSetFloat1(K > 0.f ? 1.f / K : 0.f);
+	const VectorRegister4Float QuarterK = VectorSetFloat1(bSubtract ? -K * 0.25f : K * 0.25f);
+	const VectorRegister4Float KVector = VectorSetFloat1(K);
+	for (int32 i = 0; i < Count; i += 4)
+	{
+		const VectorRegister4Float Value = VectorLoad(Values + i);
+		const VectorRegister4Float Shape = VectorMultiply(VectorLoad(Distances + i), Scale);
+		VectorRegister4Float Result = bSubtract ? VectorMin(Value, Shape) : VectorMax(Value, Shape);
+		if (K > 0.f)
+		{
+			const VectorRegister4Float H = VectorMultiply(VectorMax(VectorSubtract(KVector, VectorAbs(VectorSubtract(Value, Shape))), Zero), Blend);
+			Result = VectorMultiplyAdd(VectorMultiply(H, H), QuarterK, Result);
+		}
+		VectorStore(Result, Values + i);
+	}
+}
+
+bool FVoxelBrush::MayChange(const FVector3f& Center, float Reach, float RangeMin, float RangeMax) const
+{
+	const float Highest = (GetDistance(Center) + Reach) * DistanceScale;
+	const float K = Operation == EVoxelBrushOp::Carve ? 0.f : Smoothing * DistanceScale;
+	switch (Operation)
+	{
+	case EVoxelBrushOp::Carve:
+		return Highest > 0.f && RangeMax > HoleValue;
+	case EVoxelBrushOp::Subtract:
+		// A value only moves where -Shape is below it, or within K of it
+		return RangeMax > -Highest - K;
+	default:
+		return Highest > RangeMin - K;
+	}
+}
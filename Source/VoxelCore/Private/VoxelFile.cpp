@@ -0,0 +1,302 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelFile.h"
+
+#include "VoxelStats.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/Crc.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void FVoxelFile::Write(const FVoxelFileData& Data, float QuantizeCenter, float QuantizeRange, TArray<uint8>& Out)
+{
+	const int32 NumVoxels = Data.Voxels.Num();
+	const EEncoding Encoding = QuantizeRange > 0.f ? EEncoding::Int16 : EEncoding::Float32;
+	const float Scale = Encoding == EEncoding::Int16 ? QuantizeRange / MAX_int16 : 1.f;
+	const int32 ValueBytes = Encoding == EEncoding::Int16 ? sizeof(int16) : sizeof(float);
+	const int32 NumBlocks = FMath::DivideAndRoundUp(NumVoxels, BlockVoxels);
+
+	TArray<TArray<uint8>> Blocks;
+	Blocks.SetNum(NumBlocks);
+	ParallelFor(NumBlocks, [&](int32 Block)
+	{
+		const int32 First = Block * BlockVoxels;
+		const int32 Count = FMath::Min(BlockVoxels, NumVoxels - First);
+		const void* Raw = &Data.Voxels[First];
+
+		TArray<int16> Quantized;
+		if (Encoding == EEncoding::Int16)
+		{
+			Quantized.SetNumUninitialized(Count);
+			for (int32 i = 0; i < Count; ++i)
+			{
+				const int32 Value = FMath::RoundToInt((Data.Voxels[First + i] - QuantizeCenter) / Scale);
+				Quantized[i] = int16(FMath::Clamp(Value, -MAX_int16, MAX_int16));
+			}
+			Raw = Quantized.GetData();
+		}
+
+		const int32 RawBytes = Count * ValueBytes;
+		int32 CompressedBytes = FCompression::CompressMemoryBound(NAME_Zlib, RawBytes);
+		TArray<uint8>& Compressed = Blocks[Block];
+		Compressed.SetNumUninitialized(CompressedBytes);
+		if (FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedBytes, Raw, RawBytes) && CompressedBytes < RawBytes)
+		{
+			Compressed.SetNum(CompressedBytes);
+		}
+		else
+		{
+			// Stored as is, the reader tells by the block being exactly RawBytes long
+			Compressed.SetNumUninitialized(RawBytes);
+			FMemory::Memcpy(Compressed.GetData(), Raw, RawBytes);
+		}
+	});
+
+	TArray<int32> BlockSizes;
+	BlockSizes.SetNumUninitialized(NumBlocks);
+	for (int32 Block = 0; Block < NumBlocks; ++Block)
+	{
+		BlockSizes[Block] = Blocks[Block].Num();
+	}
+
+	Out.Reset();
+	FMemoryWriter Writer(Out);
+	uint32 FileMagic = Magic;
+	uint32 FileVersion = Version;
+	int32 SizeX = Data.SizeX;
+	int32 SizeY = Data.SizeY;
+	int32 SizeZ = Data.SizeZ;
+	float VoxelSize = Data.VoxelSize;
+	int32 Count = NumVoxels;
+	uint8 EncodingByte = uint8(Encoding);
+	float Offset = Encoding == EEncoding::Int16 ? QuantizeCenter : 0.f;
+	float FileScale = Scale;
+	int32 FileBlocks = NumBlocks;
+	uint32 Crc = 0;
+	Writer << FileMagic << FileVersion << SizeX << SizeY << SizeZ << VoxelSize << Count;
+	Writer << EncodingByte << Offset << FileScale << FileBlocks;
+	const int64 CrcOffset = Writer.Tell();
+	Writer << Crc;
+	Writer.Serialize(BlockSizes.GetData(), BlockSizes.Num() * BlockSizes.GetTypeSize());
+	for (TArray<uint8>& Compressed : Blocks)
+	{
+		Writer.Serialize(Compressed.GetData(), Compressed.Num());
+	}
+
+	// Everything after the magic except the CRC itself, so a damaged size or scale is caught as well
+	Crc = GetCrc(Out, CrcOffset);
+	FMemory::Memcpy(Out.GetData() + CrcOffset, &Crc, sizeof(Crc));
+}
+
+uint32 FVoxelFile::GetCrc(TArrayView<const uint8> File, int64 CrcOffset)
+{
+	const int64 BodyStart = CrcOffset + sizeof(uint32);
+	const uint32 HeaderCrc = FCrc::MemCrc32(File.GetData() + sizeof(uint32), CrcOffset - sizeof(uint32));
+	return FCrc::MemCrc32(File.GetData() + BodyStart, File.Num() - BodyStart, HeaderCrc);
+}
+
+bool FVoxelFile::Read(TArrayView<const uint8> File, FVoxelFileData& Out, uint32* OutVersion)
+{
+	// A v1 file starts with SizeX, which is never anywhere near the magic number
+	const bool bHasMagic = File.Num() >= int32(sizeof(uint32)) && *reinterpret_cast<const uint32*>(File.GetData()) == Magic;
+	if (OutVersion)
+	{
+		*OutVersion = bHasMagic ? Version : 1;
+	}
+	return bHasMagic ? ReadV2(File, Out) : ReadV1(File, Out);
+}
+
+int32 FVoxelFile::ReadV1Header(TArrayView<const uint8> Header, FVoxelFileData& Out)
+{
+	FMemoryReaderView Reader(Header, true);
+
+	int32 NumVoxels = 0;
+	Reader << Out.SizeX << Out.SizeY << Out.SizeZ << Out.VoxelSize << NumVoxels;
+
+	if (Reader.IsError() || NumVoxels <= 0 || NumVoxels > 10000000) // Sanity check
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Invalid voxel count: %d"), NumVoxels);
+		return 0;
+	}
+	return NumVoxels;
+}
+
+bool FVoxelFile::ReadV1(TArrayView<const uint8> File, FVoxelFileData& Out)
+{
+	const int32 NumVoxels = ReadV1Header(File, Out);
+	if (NumVoxels == 0)
+	{
+		return false;
+	}
+	if (File.Num() < GetV1Size(NumVoxels))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Voxel file is truncated"));
+		return false;
+	}
+
+	Out.Voxels.SetNumUninitialized(NumVoxels);
+	FMemory::Memcpy(Out.Voxels.GetData(), File.GetData() + V1HeaderSize, NumVoxels * sizeof(float));
+	return true;
+}
+
+bool FVoxelFile::ReadFile(const TCHAR* Path, FVoxelFileData& Out, uint32* OutVersion, int64* OutFileSize)
+{
+	TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(Path));
+	if (!Handle)
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to load file: %s"), Path);
+		return false;
+	}
+	const int64 FileSize = Handle->Size();
+	if (OutFileSize)
+	{
+		*OutFileSize = FileSize;
+	}
+
+	uint8 Header[V1HeaderSize];
+	if (FileSize < V1HeaderSize || !Handle->Read(Header, V1HeaderSize))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Voxel file is truncated"));
+		return false;
+	}
+
+	if (*reinterpret_cast<const uint32*>(Header) == Magic)
+	{
+		// The compressed blocks need a buffer either way
+		TArray<uint8> File;
+		File.SetNumUninitialized(FileSize);
+		FMemory::Memcpy(File.GetData(), Header, V1HeaderSize);
+		if (!Handle->Read(File.GetData() + V1HeaderSize, FileSize - V1HeaderSize))
+		{
+			UE_LOG(LogVoxel, Error, TEXT("Failed to read %s"), Path);
+			return false;
+		}
+		if (OutVersion)
+		{
+			*OutVersion = Version;
+		}
+		return ReadV2(File, Out);
+	}
+
+	if (OutVersion)
+	{
+		*OutVersion = 1;
+	}
+	const int32 NumVoxels = ReadV1Header(Header, Out);
+	if (NumVoxels == 0)
+	{
+		return false;
+	}
+	if (FileSize < GetV1Size(NumVoxels))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Voxel file is truncated"));
+		return false;
+	}
+	Out.Voxels.SetNumUninitialized(NumVoxels);
+	return Handle->Read(reinterpret_cast<uint8*>(Out.Voxels.GetData()), int64(NumVoxels) * sizeof(float));
+}
+
+bool FVoxelFile::ReadV2(TArrayView<const uint8> File, FVoxelFileData& Out)
+{
+	FMemoryReaderView Reader(File, true);
+
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	int32 NumVoxels = 0;
+	uint8 EncodingByte = 0;
+	float Offset = 0.f;
+	float Scale = 0.f;
+	int32 NumBlocks = 0;
+	uint32 Crc = 0;
+	Reader << FileMagic << FileVersion << Out.SizeX << Out.SizeY << Out.SizeZ << Out.VoxelSize << NumVoxels;
+	Reader << EncodingByte << Offset << Scale << NumBlocks;
+	const int64 CrcOffset = Reader.Tell();
+	Reader << Crc;
+
+	// Every file with the magic is v2, anything else is damaged or from a version this build doesn't know
+	if (Reader.IsError() || FileVersion != Version)
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Unsupported voxel file version %u"), FileVersion);
+		return false;
+	}
+	if (NumVoxels <= 0 || int64(NumVoxels) != int64(Out.SizeX + 1) * (Out.SizeY + 1) * (Out.SizeZ + 1)
+		|| NumBlocks != FMath::DivideAndRoundUp(NumVoxels, BlockVoxels) || EncodingByte > uint8(EEncoding::Int16))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Invalid voxel file header"));
+		return false;
+	}
+
+	TArray<int32> BlockSizes;
+	BlockSizes.SetNumUninitialized(NumBlocks);
+	Reader.Serialize(BlockSizes.GetData(), NumBlocks * BlockSizes.GetTypeSize());
+
+	TArray<int64> BlockOffsets;
+	BlockOffsets.SetNumUninitialized(NumBlocks);
+	int64 End = Reader.Tell();
+	for (int32 Block = 0; Block < NumBlocks; ++Block)
+	{
+		BlockOffsets[Block] = End;
+		End += FMath::Max(BlockSizes[Block], 0);
+	}
+	if (Reader.IsError() || End > File.Num())
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Voxel file is truncated"));
+		return false;
+	}
+	if (GetCrc(File.Left(int32(End)), CrcOffset) != Crc)
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Voxel file failed its checksum"));
+		return false;
+	}
+
+	const EEncoding Encoding = EEncoding(EncodingByte);
+	const int32 ValueBytes = Encoding == EEncoding::Int16 ? sizeof(int16) : sizeof(float);
+	Out.Voxels.SetNumUninitialized(NumVoxels);
+
+	TArray<bool> BlockFailed;
+	BlockFailed.Init(false, NumBlocks);
+	ParallelFor(NumBlocks, [&](int32 Block)
+	{
+		const int32 First = Block * BlockVoxels;
+		const int32 Count = FMath::Min(BlockVoxels, NumVoxels - First);
+		const int32 RawBytes = Count * ValueBytes;
+		const uint8* Compressed = File.GetData() + BlockOffsets[Block];
+
+		// Float blocks unpack straight into the voxels, int16 ones go through a scratch buffer
+		TArray<int16> Quantized;
+		void* Raw = &Out.Voxels[First];
+		if (Encoding == EEncoding::Int16)
+		{
+			Quantized.SetNumUninitialized(Count);
+			Raw = Quantized.GetData();
+		}
+
+		if (BlockSizes[Block] == RawBytes)
+		{
+			FMemory::Memcpy(Raw, Compressed, RawBytes);
+		}
+		else if (!FCompression::UncompressMemory(NAME_Zlib, Raw, RawBytes, Compressed, BlockSizes[Block]))
+		{
+			BlockFailed[Block] = true;
+			return;
+		}
+
+		if (Encoding == EEncoding::Int16)
+		{
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Out.Voxels[First + i] = Offset + Quantized[i] * Scale;
+			}
+		}
+	});
+
+	if (BlockFailed.Contains(true))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Voxel file has a block that failed to decompress"));
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,406 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelJournal.h"
+
+#include "VoxelStats.h"
+#include "VoxelStore.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	void SerializeEdit(FArchive& Ar, FVoxelEdit& Edit, uint32 FileVersion)
+	{
+		FVoxelBrush& Brush = Edit.Brush;
+		if (FileVersion < 2)
+		{
+			// Every edit before brushes was a carved sphere
+			FVector3f Center;
+			float Radius = 0.f;
+			uint8 Operation = 0;
+			Ar << Edit.Sequence << Center.X << Center.Y << Center.Z << Radius << Operation;
+			Brush = FVoxelBrush::MakeSphere(Center, Radius);
+			return;
+		}
+
+		uint8 Shape = uint8(Brush.Shape);
+		uint8 Operation = uint8(Brush.Operation);
+		Ar << Edit.Sequence << Shape << Operation << Brush.Start << Brush.End << Brush.Radius << Brush.Extent << Brush.Rotation << Brush.Smoothing;
+		if (Shape > uint8(EVoxelBrushShape::Cone) || Operation > uint8(EVoxelBrushOp::Union))
+		{
+			Ar.SetError();
+		}
+		Brush.Shape = EVoxelBrushShape(Shape);
+		Brush.Operation = EVoxelBrushOp(Operation);
+	}
+
+	//Magic, version and dims
+	constexpr int64 JournalHeaderSize = 5 * sizeof(uint32);
+
+	//Version 3 frames each record with its length and CRC so a torn one can't be misread as the start of the next
+	void WriteRecord(FArchive& Ar, FVoxelEdit Edit, uint32 FileVersion)
+	{
+		TArray<uint8> Record;
+		FMemoryWriter RecordWriter(Record);
+		SerializeEdit(RecordWriter, Edit, FileVersion);
+		uint32 Length = Record.Num();
+		uint32 Crc = FCrc::MemCrc32(Record.GetData(), Record.Num());
+		Ar << Length << Crc;
+		Ar.Serialize(Record.GetData(), Record.Num());
+	}
+
+	//Reads records up to the first one that is torn or corrupt and returns the offset the intact ones end at
+	int64 ReadRecords(const TArray<uint8>& Bytes, uint32 FileVersion, TArray<FVoxelEdit>* Out)
+	{
+		FMemoryReader Reader(Bytes, true);
+		Reader.Seek(JournalHeaderSize);
+		int64 GoodEnd = Reader.Tell();
+		while (!Reader.AtEnd())
+		{
+			FVoxelEdit Edit;
+			if (FileVersion < 3)
+			{
+				SerializeEdit(Reader, Edit, FileVersion);
+			}
+			else
+			{
+				uint32 Length = 0;
+				uint32 Crc = 0;
+				Reader << Length << Crc;
+				if (Reader.IsError() || Length > Reader.TotalSize() - Reader.Tell()
+					|| FCrc::MemCrc32(Bytes.GetData() + Reader.Tell(), Length) != Crc)
+				{
+					break;
+				}
+				FMemoryReaderView RecordReader(TArrayView64<const uint8>(Bytes.GetData() + Reader.Tell(), Length), true);
+				SerializeEdit(RecordReader, Edit, FileVersion);
+				if (RecordReader.IsError() || !RecordReader.AtEnd())
+				{
+					break;
+				}
+				Reader.Seek(Reader.Tell() + Length);
+			}
+			if (Reader.IsError())
+			{
+				break;
+			}
+			GoodEnd = Reader.Tell();
+			if (Out)
+			{
+				Out->Add(Edit);
+			}
+		}
+		return GoodEnd;
+	}
+
+	bool ReadJournalHeader(const TArray<uint8>& Bytes, uint32 Magic, const FIntVector& Dims, uint32& OutVersion)
+	{
+		FMemoryReader Reader(Bytes, true);
+		uint32 FileMagic = 0;
+		FIntVector FileDims;
+		Reader << FileMagic << OutVersion << FileDims.X << FileDims.Y << FileDims.Z;
+		return !Reader.IsError() && FileMagic == Magic && FileDims == Dims;
+	}
+}
+
+bool FVoxelJournal::AppendEdits(const FString& BaselinePath, const FIntVector& Dims, TArrayView<const FVoxelEdit> Edits)
+{
+	const FString Path = GetJournalPath(BaselinePath);
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// Records can only be appended in the layout the journal was started with, older journals are rewritten.
+	// A torn record left by a crash is cut off first, or everything appended after it would be lost with it.
+	TArray<uint8> Existing;
+	TArray<FVoxelEdit> OlderEdits;
+	int64 AppendAt = -1;
+	uint32 FileVersion = 0;
+	if (FFileHelper::LoadFileToArray(Existing, *Path, FILEREAD_Silent))
+	{
+		if (ReadJournalHeader(Existing, JournalMagic, Dims, FileVersion) && FileVersion == Version)
+		{
+			AppendAt = ReadRecords(Existing, FileVersion, nullptr);
+		}
+		else
+		{
+			ReadEdits(BaselinePath, Dims, OlderEdits);
+			PlatformFile.DeleteFile(*Path);
+		}
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	if (AppendAt < 0)
+	{
+		uint32 Magic = JournalMagic;
+		FileVersion = Version;
+		FIntVector FileDims = Dims;
+		Writer << Magic << FileVersion << FileDims.X << FileDims.Y << FileDims.Z;
+		AppendAt = 0;
+	}
+	for (const FVoxelEdit& Edit : OlderEdits)
+	{
+		WriteRecord(Writer, Edit, Version);
+	}
+	for (const FVoxelEdit& Edit : Edits)
+	{
+		WriteRecord(Writer, Edit, Version);
+	}
+
+	TUniquePtr<IFileHandle> Handle(PlatformFile.OpenWrite(*Path, true, true));
+	if (Handle && AppendAt < Existing.Num() && AppendAt > 0)
+	{
+		UE_LOG(LogVoxel, Warning, TEXT("Dropping %lld bytes of torn journal records from %s"), Existing.Num() - AppendAt, *Path);
+		if (!Handle->Truncate(AppendAt))
+		{
+			Handle.Reset();
+		}
+	}
+	if (!Handle || !Handle->Seek(AppendAt) || !Handle->Write(Bytes.GetData(), Bytes.Num()))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to append %d edits to %s"), Edits.Num(), *Path);
+		return false;
+	}
+	return true;
+}
+
+bool FVoxelJournal::ReadEdits(const FString& BaselinePath, const FIntVector& Dims, TArray<FVoxelEdit>& Out)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *GetJournalPath(BaselinePath), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	uint32 FileVersion = 0;
+	if (!ReadJournalHeader(Bytes, JournalMagic, Dims, FileVersion) || FileVersion > Version)
+	{
+		UE_LOG(LogVoxel, Warning, TEXT("Ignoring the edit journal of %s, it doesn't match the baseline"), *BaselinePath);
+		return false;
+	}
+
+	// A crash mid append leaves a torn record, which ends the journal. Before version 3 that was only
+	// detected when it was the last thing in the file.
+	ReadRecords(Bytes, FileVersion, &Out);
+	return true;
+}
+
+bool FVoxelJournal::WriteSnapshot(const FString& BaselinePath, const FVoxelBrickSnapshot& Snapshot)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+	int32 NumBricks = Snapshot.Bricks.Num();
+	PayloadWriter << NumBricks;
+	PayloadWriter.Serialize(const_cast<int32*>(Snapshot.Bricks.GetData()), Snapshot.Bricks.Num() * sizeof(int32));
+	PayloadWriter.Serialize(const_cast<uint8*>(Snapshot.bDense.GetData()), Snapshot.bDense.Num());
+	PayloadWriter.Serialize(const_cast<float*>(Snapshot.Values.GetData()), Snapshot.Values.Num() * sizeof(float));
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Payload.Num());
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, Payload.GetData(), Payload.Num()))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to compress the brick snapshot of %s"), *BaselinePath);
+		return false;
+	}
+	Compressed.SetNum(CompressedSize);
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	uint32 Magic = SnapshotMagic;
+	uint32 FileVersion = Version;
+	uint32 Sequence = Snapshot.Sequence;
+	FIntVector Dims = Snapshot.Dims;
+	int32 PayloadSize = Payload.Num();
+	uint32 Crc = FCrc::MemCrc32(Compressed.GetData(), Compressed.Num());
+	Writer << Magic << FileVersion << Sequence << Dims.X << Dims.Y << Dims.Z << PayloadSize << Crc;
+	Writer.Serialize(Compressed.GetData(), Compressed.Num());
+
+	// Written next to the old one and swapped in, so a crash never leaves half a snapshot. Moving over a file
+	// isn't atomic everywhere, so the old one is deleted first. A crash right after that leaves only the .tmp,
+	// which ReadSnapshot falls back to.
+	const FString Path = GetSnapshotPath(BaselinePath);
+	const FString TempPath = GetSnapshotTempPath(BaselinePath);
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to write %s"), *TempPath);
+		return false;
+	}
+	PlatformFile.DeleteFile(*Path);
+	if (!PlatformFile.MoveFile(*Path, *TempPath))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to replace %s"), *Path);
+		return false;
+	}
+
+	// Every journaled edit so far is in the snapshot now. Journal records carry their sequence number, so
+	// a crash before this delete only leaves edits behind that Restore skips.
+	PlatformFile.DeleteFile(*GetJournalPath(BaselinePath));
+	return true;
+}
+
+void FVoxelJournal::MergeSnapshot(FVoxelBrickSnapshot& Into, const FVoxelBrickSnapshot& Changes)
+{
+	constexpr int32 BrickVoxels = FVoxelStore::BrickSize * FVoxelStore::BrickSize * FVoxelStore::BrickSize;
+	TSet<int32> Replaced;
+	Replaced.Append(Changes.Bricks);
+
+	FVoxelBrickSnapshot Merged;
+	Merged.Sequence = Changes.Sequence;
+	Merged.Dims = Changes.Dims;
+	int32 ValueIndex = 0;
+	for (int32 i = 0; i < Into.Bricks.Num(); ++i)
+	{
+		const int32 Count = Into.bDense[i] ? BrickVoxels : 1;
+		if (!Replaced.Contains(Into.Bricks[i]))
+		{
+			Merged.Bricks.Add(Into.Bricks[i]);
+			Merged.bDense.Add(Into.bDense[i]);
+			Merged.Values.Append(Into.Values.GetData() + ValueIndex, Count);
+		}
+		ValueIndex += Count;
+	}
+	Merged.Bricks.Append(Changes.Bricks);
+	Merged.bDense.Append(Changes.bDense);
+	Merged.Values.Append(Changes.Values);
+	Into = MoveTemp(Merged);
+}
+
+bool FVoxelJournal::ReadSnapshot(const FString& BaselinePath, const FIntVector& Dims, FVoxelBrickSnapshot& Out)
+{
+	// A crash after the .tmp was written but before the old snapshot was deleted leaves both, and the .tmp may
+	// hold edits that were never journaled, so the newer one wins. A .tmp torn mid write fails its CRC.
+	const bool bHasSnapshot = ReadSnapshotFile(GetSnapshotPath(BaselinePath), Dims, Out);
+	FVoxelBrickSnapshot Pending;
+	if (ReadSnapshotFile(GetSnapshotTempPath(BaselinePath), Dims, Pending) && (!bHasSnapshot || Pending.Sequence > Out.Sequence))
+	{
+		UE_LOG(LogVoxel, Warning, TEXT("Recovered the brick snapshot of %s from an interrupted save"), *BaselinePath);
+		Out = MoveTemp(Pending);
+		return true;
+	}
+	return bHasSnapshot;
+}
+
+bool FVoxelJournal::ReadSnapshotFile(const FString& Path, const FIntVector& Dims, FVoxelBrickSnapshot& Out)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes, true);
+	uint32 Magic = 0;
+	uint32 FileVersion = 0;
+	int32 PayloadSize = 0;
+	uint32 Crc = 0;
+	Reader << Magic << FileVersion << Out.Sequence << Out.Dims.X << Out.Dims.Y << Out.Dims.Z << PayloadSize << Crc;
+	const int64 CompressedStart = Reader.Tell();
+	if (Reader.IsError() || Magic != SnapshotMagic || FileVersion > Version || Out.Dims != Dims || PayloadSize < int32(sizeof(int32))
+		|| FCrc::MemCrc32(Bytes.GetData() + CompressedStart, Bytes.Num() - CompressedStart) != Crc)
+	{
+		UE_LOG(LogVoxel, Warning, TEXT("Ignoring the brick snapshot %s, it doesn't match the baseline or is corrupt"), *Path);
+		return false;
+	}
+
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(PayloadSize);
+	if (!FCompression::UncompressMemory(NAME_Zlib, Payload.GetData(), PayloadSize, Bytes.GetData() + CompressedStart, Bytes.Num() - CompressedStart))
+	{
+		UE_LOG(LogVoxel, Warning, TEXT("Failed to decompress the brick snapshot %s"), *Path);
+		return false;
+	}
+
+	FMemoryReader PayloadReader(Payload, true);
+	int32 NumBricks = 0;
+	PayloadReader << NumBricks;
+	if (NumBricks < 0 || int64(NumBricks) * (sizeof(int32) + 1) > PayloadSize)
+	{
+		return false;
+	}
+	Out.Bricks.SetNumUninitialized(NumBricks);
+	Out.bDense.SetNumUninitialized(NumBricks);
+	PayloadReader.Serialize(Out.Bricks.GetData(), NumBricks * sizeof(int32));
+	PayloadReader.Serialize(Out.bDense.GetData(), NumBricks);
+
+	constexpr int32 BrickVoxels = FVoxelStore::BrickSize * FVoxelStore::BrickSize * FVoxelStore::BrickSize;
+	int64 NumValues = 0;
+	for (uint8 bDense : Out.bDense)
+	{
+		NumValues += bDense ? BrickVoxels : 1;
+	}
+	if (PayloadReader.TotalSize() - PayloadReader.Tell() != NumValues * int64(sizeof(float)))
+	{
+		return false;
+	}
+	Out.Values.SetNumUninitialized(NumValues);
+	PayloadReader.Serialize(Out.Values.GetData(), NumValues * sizeof(float));
+	return !PayloadReader.IsError();
+}
+
+void FVoxelJournal::Delete(const FString& BaselinePath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.DeleteFile(*GetJournalPath(BaselinePath));
+	PlatformFile.DeleteFile(*GetSnapshotPath(BaselinePath));
+	PlatformFile.DeleteFile(*GetSnapshotTempPath(BaselinePath));
+}
+
+uint32 FVoxelJournal::Restore(const FString& BaselinePath, FVoxelStore& Store, float HoleValue, float DistanceScale, TSet<int32>& OutChangedBricks, uint32& OutSnapshotSequence)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	constexpr int32 BrickVoxels = FVoxelStore::BrickSize * FVoxelStore::BrickSize * FVoxelStore::BrickSize;
+	const int32 TotalBricks = Store.GetUniformMask().Num();
+
+	// Bricks are copied back as they were, no matter how many edits went into them
+	uint32 Sequence = 0;
+	OutSnapshotSequence = 0;
+	FVoxelBrickSnapshot Snapshot;
+	if (ReadSnapshot(BaselinePath, Store.GetDims(), Snapshot))
+	{
+		Sequence = Snapshot.Sequence;
+		OutSnapshotSequence = Snapshot.Sequence;
+		int32 ValueIndex = 0;
+		for (int32 i = 0; i < Snapshot.Bricks.Num(); ++i)
+		{
+			const int32 Count = Snapshot.bDense[i] ? BrickVoxels : 1;
+			if (Snapshot.Bricks[i] >= 0 && Snapshot.Bricks[i] < TotalBricks)
+			{
+				const TArrayView<const float> Values(Snapshot.Values.GetData() + ValueIndex, Count);
+				Store.SetBrick(Snapshot.Bricks[i], Values[0], Snapshot.bDense[i] ? Values : TArrayView<const float>());
+				OutChangedBricks.Add(Snapshot.Bricks[i]);
+			}
+			ValueIndex += Count;
+		}
+	}
+
+	// Then whatever happened after the snapshot
+	TArray<FVoxelEdit> Edits;
+	ReadEdits(BaselinePath, Store.GetDims(), Edits);
+	int32 Replayed = 0;
+	for (FVoxelEdit& Edit : Edits)
+	{
+		if (Edit.Sequence <= Sequence)
+		{
+			continue;
+		}
+		Edit.Brush.HoleValue = HoleValue;
+		Edit.Brush.DistanceScale = DistanceScale;
+		const FVoxelRegion Edited = Store.ApplyBrush(Edit.Brush);
+		Store.CollectBricks(Edited, OutChangedBricks);
+		Sequence = Edit.Sequence;
+		++Replayed;
+	}
+
+	if (Snapshot.Bricks.Num() > 0 || Replayed > 0)
+	{
+		UE_LOG(LogVoxel, Display, TEXT("Restored %d snapshot bricks and replayed %d edits on %s in %.2f ms"),
+			Snapshot.Bricks.Num(), Replayed, *BaselinePath, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+	return Sequence;
+}
@@ -0,0 +1,923 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelMesher.h"
+
+#include "VoxelSimplifier.h"
+#include "VoxelStats.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+//the marching cube technique that we're trying to mimic requires a lot of data. We could remake it.
+//We could also reinvent the wheel, but I think we have better things to do.
+//information was pulled from
+//https://gist.github.com/BLaZeKiLL/48de66d6d667f6062e30b38c4cb97536
+//great walkthrough of the marching cube technique too!
+
+#pragma region MarchingCubeData
+constexpr int VertexOffset[8][3] = {
+	{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+	{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}
+};
+
+constexpr int EdgeConnection[12][2] = {
+	{0, 1}, {1, 2}, {2, 3}, {3, 0},
+	{4, 5}, {5, 6}, {6, 7}, {7, 4},
+	{0, 4}, {1, 5}, {2, 6}, {3, 7}
+};         
+
+constexpr float EdgeDirection[12][3] = {
+	{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+	{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+	{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}
+};
+
+constexpr int CubeEdgeFlags[256] = {
+	0x000, 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c, 0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
+	0x190, 0x099, 0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c, 0x99c, 0x895, 0xb9f, 0xa96, 0xd9a, 0xc93, 0xf99, 0xe90,
+	0x230, 0x339, 0x033, 0x13a, 0x636, 0x73f, 0x435, 0x53c, 0xa3c, 0xb35, 0x83f, 0x936, 0xe3a, 0xf33, 0xc39, 0xd30,
+	0x3a0, 0x2a9, 0x1a3, 0x0aa, 0x7a6, 0x6af, 0x5a5, 0x4ac, 0xbac, 0xaa5, 0x9af, 0x8a6, 0xfaa, 0xea3, 0xda9, 0xca0,
+	0x460, 0x569, 0x663, 0x76a, 0x066, 0x16f, 0x265, 0x36c, 0xc6c, 0xd65, 0xe6f, 0xf66, 0x86a, 0x963, 0xa69, 0xb60,
+	0x5f0, 0x4f9, 0x7f3, 0x6fa, 0x1f6, 0x0ff, 0x3f5, 0x2fc, 0xdfc, 0xcf5, 0xfff, 0xef6, 0x9fa, 0x8f3, 0xbf9, 0xaf0,
+	0x650, 0x759, 0x453, 0x55a, 0x256, 0x35f, 0x055, 0x15c, 0xe5c, 0xf55, 0xc5f, 0xd56, 0xa5a, 0xb53, 0x859, 0x950,
+	0x7c0, 0x6c9, 0x5c3, 0x4ca, 0x3c6, 0x2cf, 0x1c5, 0x0cc, 0xfcc, 0xec5, 0xdcf, 0xcc6, 0xbca, 0xac3, 0x9c9, 0x8c0,
+	0x8c0, 0x9c9, 0xac3, 0xbca, 0xcc6, 0xdcf, 0xec5, 0xfcc, 0x0cc, 0x1c5, 0x2cf, 0x3c6, 0x4ca, 0x5c3, 0x6c9, 0x7c0,
+	0x950, 0x859, 0xb53, 0xa5a, 0xd56, 0xc5f, 0xf55, 0xe5c, 0x15c, 0x055, 0x35f, 0x256, 0x55a, 0x453, 0x759, 0x650,
+	0xaf0, 0xbf9, 0x8f3, 0x9fa, 0xef6, 0xfff, 0xcf5, 0xdfc, 0x2fc, 0x3f5, 0x0ff, 0x1f6, 0x6fa, 0x7f3, 0x4f9, 0x5f0,
+	0xb60, 0xa69, 0x963, 0x86a, 0xf66, 0xe6f, 0xd65, 0xc6c, 0x36c, 0x265, 0x16f, 0x066, 0x76a, 0x663, 0x569, 0x460,
+	0xca0, 0xda9, 0xea3, 0xfaa, 0x8a6, 0x9af, 0xaa5, 0xbac, 0x4ac, 0x5a5, 0x6af, 0x7a6, 0x0aa, 0x1a3, 0x2a9, 0x3a0,
+	0xd30, 0xc39, 0xf33, 0xe3a, 0x936, 0x83f, 0xb35, 0xa3c, 0x53c, 0x435, 0x73f, 0x636, 0x13a, 0x033, 0x339, 0x230,
+	0xe90, 0xf99, 0xc93, 0xd9a, 0xa96, 0xb9f, 0x895, 0x99c, 0x69c, 0x795, 0x49f, 0x596, 0x29a, 0x393, 0x099, 0x190,
+	0xf00, 0xe09, 0xd03, 0xc0a, 0xb06, 0xa0f, 0x905, 0x80c, 0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x000
+};
+
+constexpr int TriangleConnectionTable[256][16] = {
+	{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 8, 3, 9, 8, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 2, 10, 0, 2, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 8, 3, 2, 10, 8, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1},
+	{3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 11, 2, 8, 11, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 9, 0, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 11, 2, 1, 9, 11, 9, 8, 11, -1, -1, -1, -1, -1, -1, -1},
+	{3, 10, 1, 11, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 10, 1, 0, 8, 10, 8, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+	{3, 9, 0, 3, 11, 9, 11, 10, 9, -1, -1, -1, -1, -1, -1, -1},
+	{9, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 3, 0, 7, 3, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 1, 9, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 1, 9, 4, 7, 1, 7, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 4, 7, 3, 0, 4, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1},
+	{9, 2, 10, 9, 0, 2, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
+	{2, 10, 9, 2, 9, 7, 2, 7, 3, 7, 9, 4, -1, -1, -1, -1},
+	{8, 4, 7, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{11, 4, 7, 11, 2, 4, 2, 0, 4, -1, -1, -1, -1, -1, -1, -1},
+	{9, 0, 1, 8, 4, 7, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
+	{4, 7, 11, 9, 4, 11, 9, 11, 2, 9, 2, 1, -1, -1, -1, -1},
+	{3, 10, 1, 3, 11, 10, 7, 8, 4, -1, -1, -1, -1, -1, -1, -1},
+	{1, 11, 10, 1, 4, 11, 1, 0, 4, 7, 11, 4, -1, -1, -1, -1},
+	{4, 7, 8, 9, 0, 11, 9, 11, 10, 11, 0, 3, -1, -1, -1, -1},
+	{4, 7, 11, 4, 11, 9, 9, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 4, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 5, 4, 1, 5, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{8, 5, 4, 8, 3, 5, 3, 1, 5, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 8, 1, 2, 10, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+	{5, 2, 10, 5, 4, 2, 4, 0, 2, -1, -1, -1, -1, -1, -1, -1},
+	{2, 10, 5, 3, 2, 5, 3, 5, 4, 3, 4, 8, -1, -1, -1, -1},
+	{9, 5, 4, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 11, 2, 0, 8, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+	{0, 5, 4, 0, 1, 5, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
+	{2, 1, 5, 2, 5, 8, 2, 8, 11, 4, 8, 5, -1, -1, -1, -1},
+	{10, 3, 11, 10, 1, 3, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1},
+	{4, 9, 5, 0, 8, 1, 8, 10, 1, 8, 11, 10, -1, -1, -1, -1},
+	{5, 4, 0, 5, 0, 11, 5, 11, 10, 11, 0, 3, -1, -1, -1, -1},
+	{5, 4, 8, 5, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1},
+	{9, 7, 8, 5, 7, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 3, 0, 9, 5, 3, 5, 7, 3, -1, -1, -1, -1, -1, -1, -1},
+	{0, 7, 8, 0, 1, 7, 1, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+	{1, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 7, 8, 9, 5, 7, 10, 1, 2, -1, -1, -1, -1, -1, -1, -1},
+	{10, 1, 2, 9, 5, 0, 5, 3, 0, 5, 7, 3, -1, -1, -1, -1},
+	{8, 0, 2, 8, 2, 5, 8, 5, 7, 10, 5, 2, -1, -1, -1, -1},
+	{2, 10, 5, 2, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+	{7, 9, 5, 7, 8, 9, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 7, 9, 7, 2, 9, 2, 0, 2, 7, 11, -1, -1, -1, -1},
+	{2, 3, 11, 0, 1, 8, 1, 7, 8, 1, 5, 7, -1, -1, -1, -1},
+	{11, 2, 1, 11, 1, 7, 7, 1, 5, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 8, 8, 5, 7, 10, 1, 3, 10, 3, 11, -1, -1, -1, -1},
+	{5, 7, 0, 5, 0, 9, 7, 11, 0, 1, 0, 10, 11, 10, 0, -1},
+	{11, 10, 0, 11, 0, 3, 10, 5, 0, 8, 0, 7, 5, 7, 0, -1},
+	{11, 10, 5, 7, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 0, 1, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 8, 3, 1, 9, 8, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+	{1, 6, 5, 2, 6, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 6, 5, 1, 2, 6, 3, 0, 8, -1, -1, -1, -1, -1, -1, -1},
+	{9, 6, 5, 9, 0, 6, 0, 2, 6, -1, -1, -1, -1, -1, -1, -1},
+	{5, 9, 8, 5, 8, 2, 5, 2, 6, 3, 2, 8, -1, -1, -1, -1},
+	{2, 3, 11, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{11, 0, 8, 11, 2, 0, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
+	{0, 1, 9, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+	{5, 10, 6, 1, 9, 2, 9, 11, 2, 9, 8, 11, -1, -1, -1, -1},
+	{6, 3, 11, 6, 5, 3, 5, 1, 3, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 11, 0, 11, 5, 0, 5, 1, 5, 11, 6, -1, -1, -1, -1},
+	{3, 11, 6, 0, 3, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1},
+	{6, 5, 9, 6, 9, 11, 11, 9, 8, -1, -1, -1, -1, -1, -1, -1},
+	{5, 10, 6, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 3, 0, 4, 7, 3, 6, 5, 10, -1, -1, -1, -1, -1, -1, -1},
+	{1, 9, 0, 5, 10, 6, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
+	{10, 6, 5, 1, 9, 7, 1, 7, 3, 7, 9, 4, -1, -1, -1, -1},
+	{6, 1, 2, 6, 5, 1, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 5, 5, 2, 6, 3, 0, 4, 3, 4, 7, -1, -1, -1, -1},
+	{8, 4, 7, 9, 0, 5, 0, 6, 5, 0, 2, 6, -1, -1, -1, -1},
+	{7, 3, 9, 7, 9, 4, 3, 2, 9, 5, 9, 6, 2, 6, 9, -1},
+	{3, 11, 2, 7, 8, 4, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
+	{5, 10, 6, 4, 7, 2, 4, 2, 0, 2, 7, 11, -1, -1, -1, -1},
+	{0, 1, 9, 4, 7, 8, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1},
+	{9, 2, 1, 9, 11, 2, 9, 4, 11, 7, 11, 4, 5, 10, 6, -1},
+	{8, 4, 7, 3, 11, 5, 3, 5, 1, 5, 11, 6, -1, -1, -1, -1},
+	{5, 1, 11, 5, 11, 6, 1, 0, 11, 7, 11, 4, 0, 4, 11, -1},
+	{0, 5, 9, 0, 6, 5, 0, 3, 6, 11, 6, 3, 8, 4, 7, -1},
+	{6, 5, 9, 6, 9, 11, 4, 7, 9, 7, 11, 9, -1, -1, -1, -1},
+	{10, 4, 9, 6, 4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 10, 6, 4, 9, 10, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1},
+	{10, 0, 1, 10, 6, 0, 6, 4, 0, -1, -1, -1, -1, -1, -1, -1},
+	{8, 3, 1, 8, 1, 6, 8, 6, 4, 6, 1, 10, -1, -1, -1, -1},
+	{1, 4, 9, 1, 2, 4, 2, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 8, 1, 2, 9, 2, 4, 9, 2, 6, 4, -1, -1, -1, -1},
+	{0, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{8, 3, 2, 8, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1},
+	{10, 4, 9, 10, 6, 4, 11, 2, 3, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 2, 2, 8, 11, 4, 9, 10, 4, 10, 6, -1, -1, -1, -1},
+	{3, 11, 2, 0, 1, 6, 0, 6, 4, 6, 1, 10, -1, -1, -1, -1},
+	{6, 4, 1, 6, 1, 10, 4, 8, 1, 2, 1, 11, 8, 11, 1, -1},
+	{9, 6, 4, 9, 3, 6, 9, 1, 3, 11, 6, 3, -1, -1, -1, -1},
+	{8, 11, 1, 8, 1, 0, 11, 6, 1, 9, 1, 4, 6, 4, 1, -1},
+	{3, 11, 6, 3, 6, 0, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+	{6, 4, 8, 11, 6, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{7, 10, 6, 7, 8, 10, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1},
+	{0, 7, 3, 0, 10, 7, 0, 9, 10, 6, 7, 10, -1, -1, -1, -1},
+	{10, 6, 7, 1, 10, 7, 1, 7, 8, 1, 8, 0, -1, -1, -1, -1},
+	{10, 6, 7, 10, 7, 1, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 6, 1, 6, 8, 1, 8, 9, 8, 6, 7, -1, -1, -1, -1},
+	{2, 6, 9, 2, 9, 1, 6, 7, 9, 0, 9, 3, 7, 3, 9, -1},
+	{7, 8, 0, 7, 0, 6, 6, 0, 2, -1, -1, -1, -1, -1, -1, -1},
+	{7, 3, 2, 6, 7, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 3, 11, 10, 6, 8, 10, 8, 9, 8, 6, 7, -1, -1, -1, -1},
+	{2, 0, 7, 2, 7, 11, 0, 9, 7, 6, 7, 10, 9, 10, 7, -1},
+	{1, 8, 0, 1, 7, 8, 1, 10, 7, 6, 7, 10, 2, 3, 11, -1},
+	{11, 2, 1, 11, 1, 7, 10, 6, 1, 6, 7, 1, -1, -1, -1, -1},
+	{8, 9, 6, 8, 6, 7, 9, 1, 6, 11, 6, 3, 1, 3, 6, -1},
+	{0, 9, 1, 11, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{7, 8, 0, 7, 0, 6, 3, 11, 0, 11, 6, 0, -1, -1, -1, -1},
+	{7, 11, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 8, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 1, 9, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{8, 1, 9, 8, 3, 1, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
+	{10, 1, 2, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 3, 0, 8, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+	{2, 9, 0, 2, 10, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+	{6, 11, 7, 2, 10, 3, 10, 8, 3, 10, 9, 8, -1, -1, -1, -1},
+	{7, 2, 3, 6, 2, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{7, 0, 8, 7, 6, 0, 6, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+	{2, 7, 6, 2, 3, 7, 0, 1, 9, -1, -1, -1, -1, -1, -1, -1},
+	{1, 6, 2, 1, 8, 6, 1, 9, 8, 8, 7, 6, -1, -1, -1, -1},
+	{10, 7, 6, 10, 1, 7, 1, 3, 7, -1, -1, -1, -1, -1, -1, -1},
+	{10, 7, 6, 1, 7, 10, 1, 8, 7, 1, 0, 8, -1, -1, -1, -1},
+	{0, 3, 7, 0, 7, 10, 0, 10, 9, 6, 10, 7, -1, -1, -1, -1},
+	{7, 6, 10, 7, 10, 8, 8, 10, 9, -1, -1, -1, -1, -1, -1, -1},
+	{6, 8, 4, 11, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 6, 11, 3, 0, 6, 0, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+	{8, 6, 11, 8, 4, 6, 9, 0, 1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 4, 6, 9, 6, 3, 9, 3, 1, 11, 3, 6, -1, -1, -1, -1},
+	{6, 8, 4, 6, 11, 8, 2, 10, 1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 3, 0, 11, 0, 6, 11, 0, 4, 6, -1, -1, -1, -1},
+	{4, 11, 8, 4, 6, 11, 0, 2, 9, 2, 10, 9, -1, -1, -1, -1},
+	{10, 9, 3, 10, 3, 2, 9, 4, 3, 11, 3, 6, 4, 6, 3, -1},
+	{8, 2, 3, 8, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1},
+	{0, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 9, 0, 2, 3, 4, 2, 4, 6, 4, 3, 8, -1, -1, -1, -1},
+	{1, 9, 4, 1, 4, 2, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+	{8, 1, 3, 8, 6, 1, 8, 4, 6, 6, 10, 1, -1, -1, -1, -1},
+	{10, 1, 0, 10, 0, 6, 6, 0, 4, -1, -1, -1, -1, -1, -1, -1},
+	{4, 6, 3, 4, 3, 8, 6, 10, 3, 0, 3, 9, 10, 9, 3, -1},
+	{10, 9, 4, 6, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 9, 5, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 4, 9, 5, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
+	{5, 0, 1, 5, 4, 0, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
+	{11, 7, 6, 8, 3, 4, 3, 5, 4, 3, 1, 5, -1, -1, -1, -1},
+	{9, 5, 4, 10, 1, 2, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
+	{6, 11, 7, 1, 2, 10, 0, 8, 3, 4, 9, 5, -1, -1, -1, -1},
+	{7, 6, 11, 5, 4, 10, 4, 2, 10, 4, 0, 2, -1, -1, -1, -1},
+	{3, 4, 8, 3, 5, 4, 3, 2, 5, 10, 5, 2, 11, 7, 6, -1},
+	{7, 2, 3, 7, 6, 2, 5, 4, 9, -1, -1, -1, -1, -1, -1, -1},
+	{9, 5, 4, 0, 8, 6, 0, 6, 2, 6, 8, 7, -1, -1, -1, -1},
+	{3, 6, 2, 3, 7, 6, 1, 5, 0, 5, 4, 0, -1, -1, -1, -1},
+	{6, 2, 8, 6, 8, 7, 2, 1, 8, 4, 8, 5, 1, 5, 8, -1},
+	{9, 5, 4, 10, 1, 6, 1, 7, 6, 1, 3, 7, -1, -1, -1, -1},
+	{1, 6, 10, 1, 7, 6, 1, 0, 7, 8, 7, 0, 9, 5, 4, -1},
+	{4, 0, 10, 4, 10, 5, 0, 3, 10, 6, 10, 7, 3, 7, 10, -1},
+	{7, 6, 10, 7, 10, 8, 5, 4, 10, 4, 8, 10, -1, -1, -1, -1},
+	{6, 9, 5, 6, 11, 9, 11, 8, 9, -1, -1, -1, -1, -1, -1, -1},
+	{3, 6, 11, 0, 6, 3, 0, 5, 6, 0, 9, 5, -1, -1, -1, -1},
+	{0, 11, 8, 0, 5, 11, 0, 1, 5, 5, 6, 11, -1, -1, -1, -1},
+	{6, 11, 3, 6, 3, 5, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 10, 9, 5, 11, 9, 11, 8, 11, 5, 6, -1, -1, -1, -1},
+	{0, 11, 3, 0, 6, 11, 0, 9, 6, 5, 6, 9, 1, 2, 10, -1},
+	{11, 8, 5, 11, 5, 6, 8, 0, 5, 10, 5, 2, 0, 2, 5, -1},
+	{6, 11, 3, 6, 3, 5, 2, 10, 3, 10, 5, 3, -1, -1, -1, -1},
+	{5, 8, 9, 5, 2, 8, 5, 6, 2, 3, 8, 2, -1, -1, -1, -1},
+	{9, 5, 6, 9, 6, 0, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1},
+	{1, 5, 8, 1, 8, 0, 5, 6, 8, 3, 8, 2, 6, 2, 8, -1},
+	{1, 5, 6, 2, 1, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 3, 6, 1, 6, 10, 3, 8, 6, 5, 6, 9, 8, 9, 6, -1},
+	{10, 1, 0, 10, 0, 6, 9, 5, 0, 5, 6, 0, -1, -1, -1, -1},
+	{0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{10, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{11, 5, 10, 7, 5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{11, 5, 10, 11, 7, 5, 8, 3, 0, -1, -1, -1, -1, -1, -1, -1},
+	{5, 11, 7, 5, 10, 11, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1},
+	{10, 7, 5, 10, 11, 7, 9, 8, 1, 8, 3, 1, -1, -1, -1, -1},
+	{11, 1, 2, 11, 7, 1, 7, 5, 1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 1, 2, 7, 1, 7, 5, 7, 2, 11, -1, -1, -1, -1},
+	{9, 7, 5, 9, 2, 7, 9, 0, 2, 2, 11, 7, -1, -1, -1, -1},
+	{7, 5, 2, 7, 2, 11, 5, 9, 2, 3, 2, 8, 9, 8, 2, -1},
+	{2, 5, 10, 2, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+	{8, 2, 0, 8, 5, 2, 8, 7, 5, 10, 2, 5, -1, -1, -1, -1},
+	{9, 0, 1, 5, 10, 3, 5, 3, 7, 3, 10, 2, -1, -1, -1, -1},
+	{9, 8, 2, 9, 2, 1, 8, 7, 2, 10, 2, 5, 7, 5, 2, -1},
+	{1, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 7, 0, 7, 1, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+	{9, 0, 3, 9, 3, 5, 5, 3, 7, -1, -1, -1, -1, -1, -1, -1},
+	{9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{5, 8, 4, 5, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1},
+	{5, 0, 4, 5, 11, 0, 5, 10, 11, 11, 3, 0, -1, -1, -1, -1},
+	{0, 1, 9, 8, 4, 10, 8, 10, 11, 10, 4, 5, -1, -1, -1, -1},
+	{10, 11, 4, 10, 4, 5, 11, 3, 4, 9, 4, 1, 3, 1, 4, -1},
+	{2, 5, 1, 2, 8, 5, 2, 11, 8, 4, 5, 8, -1, -1, -1, -1},
+	{0, 4, 11, 0, 11, 3, 4, 5, 11, 2, 11, 1, 5, 1, 11, -1},
+	{0, 2, 5, 0, 5, 9, 2, 11, 5, 4, 5, 8, 11, 8, 5, -1},
+	{9, 4, 5, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 5, 10, 3, 5, 2, 3, 4, 5, 3, 8, 4, -1, -1, -1, -1},
+	{5, 10, 2, 5, 2, 4, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+	{3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, -1},
+	{5, 10, 2, 5, 2, 4, 1, 9, 2, 9, 4, 2, -1, -1, -1, -1},
+	{8, 4, 5, 8, 5, 3, 3, 5, 1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 4, 5, 1, 0, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{8, 4, 5, 8, 5, 3, 9, 0, 5, 0, 3, 5, -1, -1, -1, -1},
+	{9, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 11, 7, 4, 9, 11, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+	{0, 8, 3, 4, 9, 7, 9, 11, 7, 9, 10, 11, -1, -1, -1, -1},
+	{1, 10, 11, 1, 11, 4, 1, 4, 0, 7, 4, 11, -1, -1, -1, -1},
+	{3, 1, 4, 3, 4, 8, 1, 10, 4, 7, 4, 11, 10, 11, 4, -1},
+	{4, 11, 7, 9, 11, 4, 9, 2, 11, 9, 1, 2, -1, -1, -1, -1},
+	{9, 7, 4, 9, 11, 7, 9, 1, 11, 2, 11, 1, 0, 8, 3, -1},
+	{11, 7, 4, 11, 4, 2, 2, 4, 0, -1, -1, -1, -1, -1, -1, -1},
+	{11, 7, 4, 11, 4, 2, 8, 3, 4, 3, 2, 4, -1, -1, -1, -1},
+	{2, 9, 10, 2, 7, 9, 2, 3, 7, 7, 4, 9, -1, -1, -1, -1},
+	{9, 10, 7, 9, 7, 4, 10, 2, 7, 8, 7, 0, 2, 0, 7, -1},
+	{3, 7, 10, 3, 10, 2, 7, 4, 10, 1, 10, 0, 4, 0, 10, -1},
+	{1, 10, 2, 8, 7, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 9, 1, 4, 1, 7, 7, 1, 3, -1, -1, -1, -1, -1, -1, -1},
+	{4, 9, 1, 4, 1, 7, 0, 8, 1, 8, 7, 1, -1, -1, -1, -1},
+	{4, 0, 3, 7, 4, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{9, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 9, 3, 9, 11, 11, 9, 10, -1, -1, -1, -1, -1, -1, -1},
+	{0, 1, 10, 0, 10, 8, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+	{3, 1, 10, 11, 3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 2, 11, 1, 11, 9, 9, 11, 8, -1, -1, -1, -1, -1, -1, -1},
+	{3, 0, 9, 3, 9, 11, 1, 2, 9, 2, 11, 9, -1, -1, -1, -1},
+	{0, 2, 11, 8, 0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{3, 2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 3, 8, 2, 8, 10, 10, 8, 9, -1, -1, -1, -1, -1, -1, -1},
+	{9, 10, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{2, 3, 8, 2, 8, 10, 0, 1, 8, 1, 10, 8, -1, -1, -1, -1},
+	{1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{1, 3, 8, 9, 1, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+	{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}
+};
+#pragma endregion
+
+}
+
+//Vertex index of every edge crossing on the two voxel layers a row of cells touches.
+//Layer 0 holds the edges starting on the cells' bottom face (and the vertical edges), layer 1 the top face.
+struct FEdgeVertexCache
+{
+	FIntVector Origin;
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	TArray<int32> Layers[2];
+
+	FEdgeVertexCache(const FIntVector& CellMin, const FIntVector& CellMax)
+		: Origin(CellMin)
+		, SizeX(CellMax.X - CellMin.X + 1)
+		, SizeY(CellMax.Y - CellMin.Y + 1)
+	{
+		Layers[0].Init(INDEX_NONE, SizeX * SizeY * 3);
+		Layers[1].Init(INDEX_NONE, SizeX * SizeY * 3);
+	}
+
+	int32& Get(int X, int Y, int Layer, int Axis)
+	{
+		return Layers[Layer][((Y - Origin.Y) * SizeX + (X - Origin.X)) * 3 + Axis];
+	}
+
+	//Moves up one layer of cells, the old top face becomes the new bottom face
+	void Advance()
+	{
+		Swap(Layers[0], Layers[1]);
+		for (int32& Vertex : Layers[1])
+		{
+			Vertex = INDEX_NONE;
+		}
+	}
+};
+
+void FVoxelMesher::MeshJobs(TArrayView<const FJob> Jobs, bool bParallel) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FVoxelMesher::MeshJobs);
+	// Jobs are cut into Z slabs and every slab is marched into its own buffers
+	struct FSlab
+	{
+		int32 Job;
+		FIntVector CellMin;
+		FIntVector CellMax;
+		FVoxelMeshBuffers MeshData;
+		int32 VertexOffset = 0;
+		int32 TriangleOffset = 0;
+	};
+	TArray<FSlab> Slabs;
+	for (int32 JobIndex = 0; JobIndex < Jobs.Num(); ++JobIndex)
+	{
+		const FJob& Job = Jobs[JobIndex];
+		for (int Z = Job.CellMin.Z; Z < Job.CellMax.Z; Z += SlabDepth)
+		{
+			FSlab& Slab = Slabs.AddDefaulted_GetRef();
+			Slab.Job = JobIndex;
+			Slab.CellMin = FIntVector(Job.CellMin.X, Job.CellMin.Y, Z);
+			Slab.CellMax = FIntVector(Job.CellMax.X, Job.CellMax.Y, FMath::Min(Z + SlabDepth, Job.CellMax.Z));
+		}
+	}
+
+	const EParallelForFlags Flags = bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	ParallelFor(Slabs.Num(), [&Slabs, this](int32 i)
+	{
+		// Slabs away from the surface never reach the mesher, so the work follows the surface area
+		if (Grid.IsBoxEmpty(Slabs[i].CellMin, Slabs[i].CellMax))
+		{
+			return;
+		}
+		MarchCells(Slabs[i].CellMin, Slabs[i].CellMax, Slabs[i].MeshData);
+	}, Flags);
+
+	// Prefix sum over the slabs of each job, in slab order so the triangle order never depends on scheduling
+	int32 SlabIndex = 0;
+	for (int32 JobIndex = 0; JobIndex < Jobs.Num(); ++JobIndex)
+	{
+		int32 VertexTotal = 0;
+		int32 TriangleTotal = 0;
+		for (; SlabIndex < Slabs.Num() && Slabs[SlabIndex].Job == JobIndex; ++SlabIndex)
+		{
+			Slabs[SlabIndex].VertexOffset = VertexTotal;
+			Slabs[SlabIndex].TriangleOffset = TriangleTotal;
+			VertexTotal += Slabs[SlabIndex].MeshData.Vertices.Num();
+			TriangleTotal += Slabs[SlabIndex].MeshData.Triangles.Num();
+		}
+
+		FVoxelMeshBuffers& Out = *Jobs[JobIndex].Out;
+		Out.Reset();
+		Out.Vertices.SetNumUninitialized(VertexTotal);
+		Out.Normals.SetNumUninitialized(VertexTotal);
+		Out.Colors.SetNumUninitialized(VertexTotal);
+		Out.UVs.SetNumUninitialized(VertexTotal);
+		Out.Triangles.SetNumUninitialized(TriangleTotal);
+	}
+
+	// Every slab now knows where it goes, so they can be copied in parallel
+	ParallelFor(Slabs.Num(), [&Slabs, Jobs](int32 i)
+	{
+		const FSlab& Slab = Slabs[i];
+		const FVoxelMeshBuffers& Src = Slab.MeshData;
+		FVoxelMeshBuffers& Out = *Jobs[Slab.Job].Out;
+		const int32 VertexNum = Src.Vertices.Num();
+		FMemory::Memcpy(Out.Vertices.GetData() + Slab.VertexOffset, Src.Vertices.GetData(), VertexNum * sizeof(FVector));
+		FMemory::Memcpy(Out.Normals.GetData() + Slab.VertexOffset, Src.Normals.GetData(), VertexNum * sizeof(FVector));
+		FMemory::Memcpy(Out.Colors.GetData() + Slab.VertexOffset, Src.Colors.GetData(), VertexNum * sizeof(FColor));
+		FMemory::Memcpy(Out.UVs.GetData() + Slab.VertexOffset, Src.UVs.GetData(), VertexNum * sizeof(FVector2D));
+		for (int32 t = 0; t < Src.Triangles.Num(); ++t)
+		{
+			Out.Triangles[Slab.TriangleOffset + t] = Src.Triangles[t] + Slab.VertexOffset;
+		}
+	}, Flags);
+
+	// Whole jobs only, the open edges between slabs would be locked and keep the seams dense
+	if (Settings.SimplifyError > 0.f)
+	{
+		ParallelFor(Jobs.Num(), [Jobs, this](int32 i)
+		{
+			FVoxelMeshSimplifier::Simplify(*Jobs[i].Out, Settings.SimplifyError, !Settings.bSharedVertices && !Settings.bSurfaceNets);
+		}, Flags);
+	}
+}
+
+void FVoxelMesher::MarchCells(const FIntVector& CellMin, const FIntVector& CellMax, FVoxelMeshBuffers& Out) const
+{
+	// Runs on the worker threads, the stats system keeps a timer per thread
+	SCOPE_CYCLE_COUNTER(STAT_VoxelMarch);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FVoxelMesher::MarchCells);
+	const FIntVector Size = CellMax - CellMin;
+	INC_DWORD_STAT_BY(STAT_VoxelCellsMarched, Size.X * Size.Y * Size.Z);
+
+	TOptional<FEdgeVertexCache> EdgeCache;
+	if (Settings.bSharedVertices && !Settings.bSurfaceNets)
+	{
+		EdgeCache.Emplace(CellMin, CellMax);
+	}
+
+	if (Settings.bSurfaceNets)
+	{
+		SurfaceNetCells(CellMin, CellMax, Out);
+	}
+	else if (!Settings.bRowClassification)
+	{
+		MarchCellsPerCell(CellMin, CellMax, Out, EdgeCache.GetPtrOrNull());
+	}
+	else
+	{
+		// Every voxel is compared once, then the case of a cell is 8 byte loads from the planes below and above it
+		const int32 PlaneX = CellMax.X - CellMin.X + 1;
+		TArray<uint8> InsideBottom;
+		TArray<uint8> InsideTop;
+		TArray<uint8> Cases;
+		Cases.SetNumUninitialized(CellMax.X - CellMin.X);
+		ClassifyPlane(CellMin, CellMax, CellMin.Z, InsideBottom);
+
+		float Cube[8];
+		for (int Z = CellMin.Z; Z < CellMax.Z; ++Z)
+		{
+			ClassifyPlane(CellMin, CellMax, Z + 1, InsideTop);
+			for (int Y = CellMin.Y; Y < CellMax.Y; ++Y)
+			{
+				if (Grid.IsBoxEmpty(FIntVector(CellMin.X, Y, Z), FIntVector(CellMax.X, Y + 1, Z + 1)))
+				{
+					continue;
+				}
+				const uint8* B0 = InsideBottom.GetData() + (Y - CellMin.Y) * PlaneX;
+				const uint8* B1 = B0 + PlaneX;
+				const uint8* T0 = InsideTop.GetData() + (Y - CellMin.Y) * PlaneX;
+				const uint8* T1 = T0 + PlaneX;
+				// Bit order follows VertexOffset
+				for (int i = 0; i < Cases.Num(); ++i)
+				{
+					Cases[i] = B0[i] | B0[i + 1] << 1 | B1[i + 1] << 2 | B1[i] << 3 | T0[i] << 4 | T0[i + 1] << 5 | T1[i + 1] << 6 | T1[i] << 7;
+				}
+
+				for (int i = 0; i < Cases.Num(); ++i)
+				{
+					if (CubeEdgeFlags[Cases[i]] == 0)
+					{
+						continue;
+					}
+					const int X = CellMin.X + i;
+					for (int c = 0; c < 8; ++c)
+					{
+						Cube[c] = Grid.Get(X + VertexOffset[c][0], Y + VertexOffset[c][1], Z + VertexOffset[c][2]);
+					}
+					March(X, Y, Z, Cube, Cases[i], Out, EdgeCache.GetPtrOrNull());
+				}
+			}
+
+			Swap(InsideBottom, InsideTop);
+			if (EdgeCache)
+			{
+				EdgeCache->Advance();
+			}
+		}
+	}
+
+	// Shared vertices summed the area weighted normals of every triangle using them
+	if (EdgeCache)
+	{
+		for (FVector& Normal : Out.Normals)
+		{
+			Normal.Normalize();
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_VoxelTrianglesEmitted, Out.Triangles.Num() / 3);
+}
+
+void FVoxelMesher::ClassifyPlane(const FIntVector& CellMin, const FIntVector& CellMax, int Z, TArray<uint8>& OutInside) const
+{
+	const int32 PlaneX = CellMax.X - CellMin.X + 1;
+	OutInside.SetNumUninitialized(PlaneX * (CellMax.Y - CellMin.Y + 1));
+	const VectorRegister4Float LevelVector = VectorSetFloat1(Level);
+
+	for (int Y = CellMin.Y; Y <= CellMax.Y; ++Y)
+	{
+		uint8* Inside = OutInside.GetData() + (Y - CellMin.Y) * PlaneX;
+		for (int X = CellMin.X; X <= CellMax.X;)
+		{
+			// Runs inside an empty brick are all on the side of their first voxel
+			const int RunEnd = FMath::Min((X / Grid.BrickSize + 1) * Grid.BrickSize, CellMax.X + 1);
+			if (Grid.IsInEmptyBrick(X, Y, Z))
+			{
+				FMemory::Memset(Inside + X - CellMin.X, Grid.Get(X, Y, Z) <= Level ? 1 : 0, RunEnd - X);
+				X = RunEnd;
+				continue;
+			}
+
+			const int32 Num = Grid.EmptyBricks ? RunEnd - X : CellMax.X + 1 - X;
+			uint8* RunInside = Inside + X - CellMin.X;
+			if (Grid.QuantizedData)
+			{
+				// Steps are compared as integers, a plain loop the compiler vectorizes
+				const int16* Steps = Grid.GetQuantizedRow(X, Y, Z);
+				const int32 StepLevel = FMath::FloorToInt(Level);
+				for (int32 i = 0; i < Num; ++i)
+				{
+					RunInside[i] = Steps[i] <= StepLevel ? 1 : 0;
+				}
+				X += Num;
+				continue;
+			}
+
+			// Four compares at once, the sign mask is spread back out to one byte per voxel
+			const float* Values = Grid.GetRow(X, Y, Z);
+			int32 i = 0;
+			for (; i + 4 <= Num; i += 4)
+			{
+				const int32 Bits = VectorMaskBits(VectorCompareLE(VectorLoad(Values + i), LevelVector));
+				RunInside[i] = Bits & 1;
+				RunInside[i + 1] = (Bits >> 1) & 1;
+				RunInside[i + 2] = (Bits >> 2) & 1;
+				RunInside[i + 3] = (Bits >> 3) & 1;
+			}
+			for (; i < Num; ++i)
+			{
+				RunInside[i] = Values[i] <= Level ? 1 : 0;
+			}
+			X += Num;
+		}
+	}
+}
+
+void FVoxelMesher::MarchCellsPerCell(const FIntVector& CellMin, const FIntVector& CellMax, FVoxelMeshBuffers& Out, FEdgeVertexCache* EdgeCache) const
+{
+	float Cube[8];
+	for (int Z = CellMin.Z; Z < CellMax.Z; ++Z)
+	{
+		for (int Y = CellMin.Y; Y < CellMax.Y; ++Y)
+		{
+			for (int X = CellMin.X; X < CellMax.X; ++X)
+			{
+				// Nothing to march until the next brick, the edge cache has nothing to share there either
+				if (Grid.IsInEmptyBrick(X, Y, Z))
+				{
+					X = FMath::Min((X / Grid.BrickSize + 1) * Grid.BrickSize, CellMax.X) - 1;
+					continue;
+				}
+				int VertexMask = 0;
+				for (int i = 0; i < 8; ++i)
+				{
+					Cube[i] = Grid.Get(X + VertexOffset[i][0], Y + VertexOffset[i][1], Z + VertexOffset[i][2]);
+					if (Cube[i] <= Level)
+						VertexMask |= (1 << i);
+				}
+				March(X,Y,Z,Cube,VertexMask,Out,EdgeCache);
+			}
+		}
+
+		if (EdgeCache)
+		{
+			EdgeCache->Advance();
+		}
+	}
+}
+
+void FVoxelMesher::March(int X, int Y, int Z, const float Cube[8], int VertexMask, FVoxelMeshBuffers& Out, FEdgeVertexCache* EdgeCache) const
+{
+	const float meshWidth = Settings.UVWidth;
+	const float meshHeight = Settings.UVHeight;
+	
+	FVector EdgeVertex[12];
+	const int EdgeMask = CubeEdgeFlags[VertexMask];
+
+	if (EdgeMask == 0 ) return;
+	
+	//Makes cubes showing alll the marching cubes in the object. Debugging.
+    /*if (EdgeMask != 0)
+    {
+        FVector CubeMin = FVector(X, Y, Z) * VoxelSize;
+        FVector CubeMax = CubeMin + FVector(VoxelSize, VoxelSize, VoxelSize);
+        FColor BoxColor = FColor::Yellow;
+        FColor BoxHitColor = FColor::Red;
+        
+        // Draw debug box with actor transform applied
+        DrawDebugBox(
+            GetWorld(),
+            GetActorLocation() + GetActorRotation().RotateVector((CubeMin + CubeMax) * 0.5f),
+            (CubeMax - CubeMin) * 0.5f,
+            GetActorRotation().Quaternion(),
+            VoxelsHitStatus[GetVoxelIndex(X,Y,Z)] ? BoxHitColor : BoxColor,
+            false,
+            10000000.0f,  // Lifetime (0 = one frame)
+            0,     // DepthPriority
+            1.0f   // Thickness
+        );
+    }*/
+
+	//UE_LOG(LogTemp, Warning, TEXT("Making Edges"))
+	for (int i = 0; i < 12; ++i)
+	{
+		if ((EdgeMask & (1 << i)) != 0)
+		{
+			const float Offset = Settings.bInterpolation ? GetInterpolationOffset(Cube[EdgeConnection[i][0]], Cube[EdgeConnection[i][1]]) : 0.5f;
+
+			EdgeVertex[i].X = X + (VertexOffset[EdgeConnection[i][0]][0] + Offset * EdgeDirection[i][0]);
+			EdgeVertex[i].Y = Y + (VertexOffset[EdgeConnection[i][0]][1] + Offset * EdgeDirection[i][1]);
+			EdgeVertex[i].Z = Z + (VertexOffset[EdgeConnection[i][0]][2] + Offset * EdgeDirection[i][2]);
+		}
+	}
+
+	if (EdgeCache)
+	{
+		MarchShared(X, Y, Z, VertexMask, EdgeMask, EdgeVertex, Out, *EdgeCache);
+		return;
+	}
+
+	for (int i = 0; i < 5; ++i)
+	{
+		if (TriangleConnectionTable[VertexMask][3*i] < 0) break;
+		FVector V1  = GetVertexPosition(EdgeVertex[TriangleConnectionTable[VertexMask][3*i]]);
+		FVector V2  = GetVertexPosition(EdgeVertex[TriangleConnectionTable[VertexMask][3*i + 1]]);
+		FVector V3  = GetVertexPosition(EdgeVertex[TriangleConnectionTable[VertexMask][3*i + 2]]);
+
+		FVector Normal = FVector::CrossProduct(V2 - V1, V3 - V1);
+
+		// MakeRandomColor has zero saturation so it always gave white, and FRand isn't safe on the meshing workers
+		const FColor Color = FColor::White;
+
+		Normal.Normalize();
+
+		const int VertexCount = Out.Vertices.Num();
+		Out.Vertices.Append({V1, V2, V3});
+
+		FVector2D UV1 = FVector2D(V1.X / meshWidth, (V1.Y + V1.Z) / (meshHeight + meshHeight));
+		FVector2D UV2 = FVector2D(V2.X / meshWidth, (V2.Y + V2.Z) / (meshHeight + meshHeight));
+		FVector2D UV3 = FVector2D(V3.X / meshWidth, (V3.Y + V3.Z) / (meshHeight + meshHeight));
+		
+        Out.UVs.Append({ UV1, UV2, UV3 });
+		
+		Out.Triangles.Append({
+			VertexCount + Settings.TriangleOrder[0],
+			VertexCount + Settings.TriangleOrder[1],
+			VertexCount + Settings.TriangleOrder[2]});
+
+		Out.Normals.Append({Normal, Normal, Normal});
+		
+		Out.Colors.Append({Color, Color, Color});
+	}
+}
+
+void FVoxelMesher::MarchShared(int X, int Y, int Z, int VertexMask, int EdgeMask, const FVector EdgeVertex[12], FVoxelMeshBuffers& Out, FEdgeVertexCache& EdgeCache) const
+{
+	// Where each cube edge starts relative to the cell and which axis it runs along,
+	// so neighbouring cells agree on the id of an edge they share
+	static constexpr int EdgeStart[12][4] = {
+		{0, 0, 0, 0}, {1, 0, 0, 1}, {0, 1, 0, 0}, {0, 0, 0, 1},
+		{0, 0, 1, 0}, {1, 0, 1, 1}, {0, 1, 1, 0}, {0, 0, 1, 1},
+		{0, 0, 0, 2}, {1, 0, 0, 2}, {1, 1, 0, 2}, {0, 1, 0, 2}
+	};
+
+	const float meshWidth = Settings.UVWidth;
+	const float meshHeight = Settings.UVHeight;
+
+	int EdgeIndex[12];
+	for (int i = 0; i < 12; ++i)
+	{
+		if ((EdgeMask & (1 << i)) == 0)
+		{
+			continue;
+		}
+
+		int32& Cached = EdgeCache.Get(X + EdgeStart[i][0], Y + EdgeStart[i][1], EdgeStart[i][2], EdgeStart[i][3]);
+		if (Cached == INDEX_NONE)
+		{
+			const FVector V = GetVertexPosition(EdgeVertex[i]);
+			Cached = Out.Vertices.Add(V);
+			Out.Normals.Add(FVector::ZeroVector);
+			Out.UVs.Add(FVector2D(V.X / meshWidth, (V.Y + V.Z) / (meshHeight + meshHeight)));
+			Out.Colors.Add(FColor::White);
+		}
+		EdgeIndex[i] = Cached;
+	}
+
+	for (int i = 0; i < 5; ++i)
+	{
+		if (TriangleConnectionTable[VertexMask][3*i] < 0) break;
+		const int Corner[3] = {
+			EdgeIndex[TriangleConnectionTable[VertexMask][3*i]],
+			EdgeIndex[TriangleConnectionTable[VertexMask][3*i + 1]],
+			EdgeIndex[TriangleConnectionTable[VertexMask][3*i + 2]]
+		};
+
+		// Left unnormalized so bigger triangles weigh more, MarchCells normalizes at the end
+		const FVector& V1 = Out.Vertices[Corner[0]];
+		const FVector FaceNormal = FVector::CrossProduct(Out.Vertices[Corner[1]] - V1, Out.Vertices[Corner[2]] - V1);
+		Out.Normals[Corner[0]] += FaceNormal;
+		Out.Normals[Corner[1]] += FaceNormal;
+		Out.Normals[Corner[2]] += FaceNormal;
+
+		Out.Triangles.Append({
+			Corner[Settings.TriangleOrder[0]],
+			Corner[Settings.TriangleOrder[1]],
+			Corner[Settings.TriangleOrder[2]]});
+	}
+}
+
+void FVoxelMesher::SurfaceNetCells(const FIntVector& CellMin, const FIntVector& CellMax, FVoxelMeshBuffers& Out) const
+{
+	// Quads reach one cell below CellMin. Those vertices are made again here instead of being shared with the
+	// neighbouring job, they come out the same since a vertex only depends on its cell's corners.
+	const FIntVector VertexMin = (CellMin - FIntVector(1)).ComponentMax(Grid.Origin);
+	const FIntVector Size = CellMax - VertexMin;
+	TArray<int32> CellVertices;
+	CellVertices.Init(INDEX_NONE, Size.X * Size.Y * Size.Z);
+	auto GetCellVertex = [&CellVertices, &VertexMin, &Size](const FIntVector& Cell) -> int32&
+	{
+		return CellVertices[((Cell.Z - VertexMin.Z) * Size.Y + (Cell.Y - VertexMin.Y)) * Size.X + (Cell.X - VertexMin.X)];
+	};
+
+	const float meshWidth = Settings.UVWidth;
+	const float meshHeight = Settings.UVHeight;
+	float Cube[8];
+	for (int Z = VertexMin.Z; Z < CellMax.Z; ++Z)
+	{
+		for (int Y = VertexMin.Y; Y < CellMax.Y; ++Y)
+		{
+			for (int X = VertexMin.X; X < CellMax.X; ++X)
+			{
+				if (Grid.IsInEmptyBrick(X, Y, Z))
+				{
+					X = FMath::Min((X / Grid.BrickSize + 1) * Grid.BrickSize, CellMax.X) - 1;
+					continue;
+				}
+				int VertexMask = 0;
+				for (int i = 0; i < 8; ++i)
+				{
+					Cube[i] = Grid.Get(X + VertexOffset[i][0], Y + VertexOffset[i][1], Z + VertexOffset[i][2]);
+					if (Cube[i] <= Level)
+						VertexMask |= (1 << i);
+				}
+				const int EdgeMask = CubeEdgeFlags[VertexMask];
+				if (EdgeMask == 0)
+				{
+					continue;
+				}
+
+				FVector Local = FVector::ZeroVector;
+				int Crossings = 0;
+				for (int i = 0; i < 12; ++i)
+				{
+					if ((EdgeMask & (1 << i)) != 0)
+					{
+						const float Offset = Settings.bInterpolation ? GetInterpolationOffset(Cube[EdgeConnection[i][0]], Cube[EdgeConnection[i][1]]) : 0.5f;
+						Local += FVector(VertexOffset[EdgeConnection[i][0]][0], VertexOffset[EdgeConnection[i][0]][1], VertexOffset[EdgeConnection[i][0]][2])
+							+ Offset * FVector(EdgeDirection[i][0], EdgeDirection[i][1], EdgeDirection[i][2]);
+						++Crossings;
+					}
+				}
+				Local /= Crossings;
+
+				// Gradient of the trilinear blend of the corners at the vertex. Values grow into the solid, so the
+				// normal points the other way, the same side marching cubes normals face.
+				FVector Gradient = FVector::ZeroVector;
+				for (int i = 0; i < 8; ++i)
+				{
+					const FVector Weight(
+						VertexOffset[i][0] ? Local.X : 1.0 - Local.X,
+						VertexOffset[i][1] ? Local.Y : 1.0 - Local.Y,
+						VertexOffset[i][2] ? Local.Z : 1.0 - Local.Z);
+					Gradient.X += Cube[i] * (VertexOffset[i][0] ? 1.0 : -1.0) * Weight.Y * Weight.Z;
+					Gradient.Y += Cube[i] * (VertexOffset[i][1] ? 1.0 : -1.0) * Weight.X * Weight.Z;
+					Gradient.Z += Cube[i] * (VertexOffset[i][2] ? 1.0 : -1.0) * Weight.X * Weight.Y;
+				}
+
+				// A short last cell squeezes the blend along that axis, steepening it the same amount
+				for (int Axis = 0; Axis < 3; ++Axis)
+				{
+					Gradient[Axis] /= GetCellLength(Axis, Axis == 0 ? X : Axis == 1 ? Y : Z);
+				}
+
+				const FVector V = GetVertexPosition(FVector(X, Y, Z) + Local);
+				GetCellVertex(FIntVector(X, Y, Z)) = Out.Vertices.Add(V);
+				Out.Normals.Add((-Gradient).GetSafeNormal());
+				Out.UVs.Add(FVector2D(V.X / meshWidth, (V.Y + V.Z) / (meshHeight + meshHeight)));
+				Out.Colors.Add(FColor::White);
+			}
+		}
+	}
+
+	// Every crossed voxel edge gets a quad between the four cells around it. A job owns the edges starting at its
+	// own cells, so between jobs no quad is made twice and none is missed.
+	// The two other axes of each edge axis, in the order that makes (U, V) counter clockwise around it
+	static constexpr int QuadAxes[3][2] = { {1, 2}, {2, 0}, {0, 1} };
+	for (int Z = CellMin.Z; Z < CellMax.Z; ++Z)
+	{
+		for (int Y = CellMin.Y; Y < CellMax.Y; ++Y)
+		{
+			for (int X = CellMin.X; X < CellMax.X; ++X)
+			{
+				const FIntVector Cell(X, Y, Z);
+				const int32 CellVertex = GetCellVertex(Cell);
+				if (CellVertex == INDEX_NONE)
+				{
+					continue;
+				}
+				const bool bBelow = Grid.Get(X, Y, Z) <= Level;
+				for (int Axis = 0; Axis < 3; ++Axis)
+				{
+					FIntVector Next = Cell;
+					Next[Axis] += 1;
+					if ((Grid.Get(Next.X, Next.Y, Next.Z) <= Level) == bBelow)
+					{
+						continue;
+					}
+					FIntVector U = FIntVector::ZeroValue;
+					FIntVector V = FIntVector::ZeroValue;
+					U[QuadAxes[Axis][0]] = 1;
+					V[QuadAxes[Axis][1]] = 1;
+					const FIntVector Corner = Cell - U - V;
+					// On the low face of the grid there is nothing on the other side
+					if (Corner[QuadAxes[Axis][0]] < VertexMin[QuadAxes[Axis][0]] || Corner[QuadAxes[Axis][1]] < VertexMin[QuadAxes[Axis][1]])
+					{
+						continue;
+					}
+
+					int32 Quad[4] = { GetCellVertex(Corner), GetCellVertex(Cell - V), CellVertex, GetCellVertex(Cell - U) };
+					if (Quad[0] == INDEX_NONE || Quad[1] == INDEX_NONE || Quad[3] == INDEX_NONE)
+					{
+						continue;
+					}
+					// Wound to face along +Axis, flipped when that is the solid side so it faces away from it like
+					// the marching cubes triangles before TriangleOrder
+					if (bBelow)
+					{
+						Swap(Quad[1], Quad[3]);
+					}
+					for (int t = 0; t < 2; ++t)
+					{
+						const int Corners[3] = { Quad[0], Quad[t + 1], Quad[t + 2] };
+						Out.Triangles.Append({
+							Corners[Settings.TriangleOrder[0]],
+							Corners[Settings.TriangleOrder[1]],
+							Corners[Settings.TriangleOrder[2]]});
+					}
+				}
+			}
+		}
+	}
+}
+
+double FVoxelMesher::GetCellLength(int Axis, int Cell) const
+{
+	const double End = Settings.CellEnd[Axis];
+	const double LastCell = FMath::CeilToDouble(End) - 1.0;
+	return End > 0.0 && Cell == LastCell ? End - LastCell : 1.0;
+}
+
+FVector FVoxelMesher::GetVertexPosition(const FVector& GridPosition) const
+{
+	FVector Position = GridPosition;
+	for (int Axis = 0; Axis < 3; ++Axis)
+	{
+		const double End = Settings.CellEnd[Axis];
+		const double LastCell = FMath::CeilToDouble(End) - 1.0;
+		if (End > 0.0 && Position[Axis] > LastCell)
+		{
+			Position[Axis] = LastCell + (Position[Axis] - LastCell) * (End - LastCell);
+		}
+	}
+	return Position * Settings.VoxelSize;
+}
+
+float FVoxelMesher::GetInterpolationOffset(float V1, float V2) const
+{
+	const float Delta = V2 - V1;
+	return Delta == 0.0f ? Level : (Level - V1) / Delta;
+}
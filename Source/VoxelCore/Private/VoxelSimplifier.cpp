@@ -0,0 +1,359 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelSimplifier.h"
+
+#include "VoxelMesher.h"
+#include "VoxelStats.h"
+
+namespace
+{
+	//Sum of squared distances to a set of planes, as a symmetric 4x4 matrix
+	struct FQuadric
+	{
+		double A2 = 0.0, AB = 0.0, AC = 0.0, AD = 0.0;
+		double B2 = 0.0, BC = 0.0, BD = 0.0;
+		double C2 = 0.0, CD = 0.0;
+		double D2 = 0.0;
+
+		void AddPlane(const FVector& N, double D)
+		{
+			A2 += N.X * N.X; AB += N.X * N.Y; AC += N.X * N.Z; AD += N.X * D;
+			B2 += N.Y * N.Y; BC += N.Y * N.Z; BD += N.Y * D;
+			C2 += N.Z * N.Z; CD += N.Z * D;
+			D2 += D * D;
+		}
+
+		void Add(const FQuadric& Other)
+		{
+			A2 += Other.A2; AB += Other.AB; AC += Other.AC; AD += Other.AD;
+			B2 += Other.B2; BC += Other.BC; BD += Other.BD;
+			C2 += Other.C2; CD += Other.CD;
+			D2 += Other.D2;
+		}
+
+		double Evaluate(const FVector& P) const
+		{
+			return A2 * P.X * P.X + 2.0 * AB * P.X * P.Y + 2.0 * AC * P.X * P.Z + 2.0 * AD * P.X
+				+ B2 * P.Y * P.Y + 2.0 * BC * P.Y * P.Z + 2.0 * BD * P.Y
+				+ C2 * P.Z * P.Z + 2.0 * CD * P.Z
+				+ D2;
+		}
+	};
+
+	//Moving From onto To. Stamps go stale once either end changes.
+	struct FCollapse
+	{
+		double Cost = 0.0;
+		int32 From = INDEX_NONE;
+		int32 To = INDEX_NONE;
+		uint32 FromStamp = 0;
+		uint32 ToStamp = 0;
+
+		bool operator<(const FCollapse& Other) const
+		{
+			return Cost < Other.Cost;
+		}
+	};
+
+	uint64 EdgeKey(int32 A, int32 B)
+	{
+		return A < B ? (uint64(uint32(A)) << 32) | uint32(B) : (uint64(uint32(B)) << 32) | uint32(A);
+	}
+}
+
+int32 FVoxelMeshSimplifier::Simplify(FVoxelMeshBuffers& Mesh, float MaxError, bool bFlatNormals)
+{
+	const int32 NumTriangles = Mesh.Triangles.Num() / 3;
+	if (NumTriangles == 0 || MaxError <= 0.f)
+	{
+		return 0;
+	}
+	SCOPE_CYCLE_COUNTER(STAT_VoxelSimplify);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FVoxelMeshSimplifier::Simplify);
+
+	// Per triangle output repeats every vertex, welding gives the collapses the connectivity
+	TArray<FVector> Positions;
+	//Mesh vertex each welded vertex takes its attributes from
+	TArray<int32> Sources;
+	TArray<int32> Corners;
+	Corners.SetNumUninitialized(NumTriangles * 3);
+	{
+		TMap<FIntVector, int32> Welded;
+		Welded.Reserve(Mesh.Vertices.Num());
+		for (int32 i = 0; i < Corners.Num(); ++i)
+		{
+			const int32 MeshVertex = Mesh.Triangles[i];
+			const FVector& P = Mesh.Vertices[MeshVertex];
+			const FIntVector Key(FMath::RoundToInt(P.X / WeldTolerance), FMath::RoundToInt(P.Y / WeldTolerance), FMath::RoundToInt(P.Z / WeldTolerance));
+			int32& Vertex = Welded.FindOrAdd(Key, INDEX_NONE);
+			if (Vertex == INDEX_NONE)
+			{
+				Vertex = Positions.Add(P);
+				Sources.Add(MeshVertex);
+			}
+			Corners[i] = Vertex;
+		}
+	}
+
+	const int32 NumVertices = Positions.Num();
+	TArray<TArray<int32>> VertexTriangles;
+	VertexTriangles.SetNum(NumVertices);
+	TArray<FQuadric> Quadrics;
+	Quadrics.SetNum(NumVertices);
+	TArray<bool> TriangleRemoved;
+	TriangleRemoved.Init(false, NumTriangles);
+	TMap<uint64, int32> EdgeUses;
+	EdgeUses.Reserve(NumTriangles * 3 / 2);
+	for (int32 t = 0; t < NumTriangles; ++t)
+	{
+		const int32* Tri = &Corners[t * 3];
+		if (Tri[0] == Tri[1] || Tri[1] == Tri[2] || Tri[2] == Tri[0])
+		{
+			TriangleRemoved[t] = true;
+			continue;
+		}
+		const FVector Normal = FVector::CrossProduct(Positions[Tri[1]] - Positions[Tri[0]], Positions[Tri[2]] - Positions[Tri[0]]).GetSafeNormal();
+		for (int c = 0; c < 3; ++c)
+		{
+			if (!Normal.IsZero())
+			{
+				Quadrics[Tri[c]].AddPlane(Normal, -FVector::DotProduct(Normal, Positions[Tri[0]]));
+			}
+			VertexTriangles[Tri[c]].Add(t);
+			++EdgeUses.FindOrAdd(EdgeKey(Tri[c], Tri[(c + 1) % 3]), 0);
+		}
+	}
+
+	// Open and non-manifold edges are the chunk border, the ends stay where they are
+	TArray<bool> Locked;
+	Locked.Init(false, NumVertices);
+	for (const TPair<uint64, int32>& Edge : EdgeUses)
+	{
+		if (Edge.Value != 2)
+		{
+			Locked[int32(Edge.Key >> 32)] = true;
+			Locked[int32(Edge.Key & 0xFFFFFFFF)] = true;
+		}
+	}
+
+	TArray<uint32> Stamps;
+	Stamps.Init(0, NumVertices);
+	TArray<bool> VertexRemoved;
+	VertexRemoved.Init(false, NumVertices);
+	const double MaxCost = double(MaxError) * MaxError;
+	TArray<FCollapse> Heap;
+	// Quadrics only ever grow, so a collapse over the limit now never comes under it later
+	auto TryPush = [&](int32 From, int32 To)
+	{
+		if (Locked[From])
+		{
+			return;
+		}
+		const double Cost = Quadrics[From].Evaluate(Positions[To]) + Quadrics[To].Evaluate(Positions[To]);
+		if (Cost <= MaxCost)
+		{
+			Heap.HeapPush({ Cost, From, To, Stamps[From], Stamps[To] });
+		}
+	};
+	for (int32 t = 0; t < NumTriangles; ++t)
+	{
+		if (!TriangleRemoved[t])
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				TryPush(Corners[t * 3 + c], Corners[t * 3 + (c + 1) % 3]);
+				TryPush(Corners[t * 3 + (c + 1) % 3], Corners[t * 3 + c]);
+			}
+		}
+	}
+
+	auto HasCorner = [&Corners](int32 Triangle, int32 Vertex)
+	{
+		return Corners[Triangle * 3] == Vertex || Corners[Triangle * 3 + 1] == Vertex || Corners[Triangle * 3 + 2] == Vertex;
+	};
+	auto GatherNeighbours = [&Corners, &VertexTriangles](int32 Vertex, TArray<int32>& Out)
+	{
+		Out.Reset();
+		for (int32 Triangle : VertexTriangles[Vertex])
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				if (Corners[Triangle * 3 + c] != Vertex)
+				{
+					Out.AddUnique(Corners[Triangle * 3 + c]);
+				}
+			}
+		}
+	};
+
+	TArray<int32> Around;
+	TArray<int32> FromNeighbours;
+	TArray<int32> ToNeighbours;
+	int32 RemovedTriangles = 0;
+	while (Heap.Num() > 0)
+	{
+		FCollapse Collapse;
+		Heap.HeapPop(Collapse, EAllowShrinking::No);
+		const int32 From = Collapse.From;
+		const int32 To = Collapse.To;
+		if (VertexRemoved[From] || VertexRemoved[To] || Stamps[From] != Collapse.FromStamp || Stamps[To] != Collapse.ToStamp)
+		{
+			continue;
+		}
+
+		// Drops the triangles removed since, the list is walked again below anyway
+		VertexTriangles[From].RemoveAllSwap([&TriangleRemoved](int32 Triangle) { return TriangleRemoved[Triangle]; });
+		VertexTriangles[To].RemoveAllSwap([&TriangleRemoved](int32 Triangle) { return TriangleRemoved[Triangle]; });
+		Around = VertexTriangles[From];
+		int32 Shared = 0;
+		for (int32 Triangle : Around)
+		{
+			Shared += HasCorner(Triangle, To) ? 1 : 0;
+		}
+		if (Shared == 0)
+		{
+			continue;
+		}
+
+		// Link condition, the ends may only share the vertices opposite the collapsed edge or the surface pinches
+		GatherNeighbours(From, FromNeighbours);
+		GatherNeighbours(To, ToNeighbours);
+		int32 Common = 0;
+		for (int32 Vertex : FromNeighbours)
+		{
+			Common += ToNeighbours.Contains(Vertex) ? 1 : 0;
+		}
+		if (Common != Shared)
+		{
+			continue;
+		}
+
+		// No triangle may fold over
+		bool bFlips = false;
+		for (int32 Triangle : Around)
+		{
+			if (HasCorner(Triangle, To))
+			{
+				continue;
+			}
+			FVector Old[3];
+			FVector New[3];
+			for (int c = 0; c < 3; ++c)
+			{
+				const int32 Vertex = Corners[Triangle * 3 + c];
+				Old[c] = Positions[Vertex];
+				New[c] = Positions[Vertex == From ? To : Vertex];
+			}
+			const FVector OldNormal = FVector::CrossProduct(Old[1] - Old[0], Old[2] - Old[0]);
+			const FVector NewNormal = FVector::CrossProduct(New[1] - New[0], New[2] - New[0]);
+			if (FVector::DotProduct(OldNormal, NewNormal) <= 0.0)
+			{
+				bFlips = true;
+				break;
+			}
+		}
+		if (bFlips)
+		{
+			continue;
+		}
+
+		for (int32 Triangle : Around)
+		{
+			if (HasCorner(Triangle, To))
+			{
+				TriangleRemoved[Triangle] = true;
+				++RemovedTriangles;
+				continue;
+			}
+			for (int c = 0; c < 3; ++c)
+			{
+				if (Corners[Triangle * 3 + c] == From)
+				{
+					Corners[Triangle * 3 + c] = To;
+				}
+			}
+			VertexTriangles[To].Add(Triangle);
+		}
+		VertexTriangles[From].Empty();
+		Quadrics[To].Add(Quadrics[From]);
+		VertexRemoved[From] = true;
+		++Stamps[To];
+
+		GatherNeighbours(To, ToNeighbours);
+		for (int32 Vertex : ToNeighbours)
+		{
+			TryPush(To, Vertex);
+			TryPush(Vertex, To);
+		}
+	}
+
+	if (RemovedTriangles == 0)
+	{
+		return 0;
+	}
+
+	// Surviving vertices never moved, so they keep the attributes of the mesh vertex they were welded from
+	FVoxelMeshBuffers Result;
+	if (bFlatNormals)
+	{
+		// Winding decides which way the cross product points, the first triangle's normal tells which way is out
+		double Facing = 1.0;
+		for (int32 t = 0; t < NumTriangles; ++t)
+		{
+			const int32* Tri = &Mesh.Triangles[t * 3];
+			const FVector Cross = FVector::CrossProduct(Mesh.Vertices[Tri[1]] - Mesh.Vertices[Tri[0]], Mesh.Vertices[Tri[2]] - Mesh.Vertices[Tri[0]]);
+			if (!Cross.IsNearlyZero())
+			{
+				Facing = FVector::DotProduct(Cross, Mesh.Normals[Tri[0]]) < 0.0 ? -1.0 : 1.0;
+				break;
+			}
+		}
+		for (int32 t = 0; t < NumTriangles; ++t)
+		{
+			if (TriangleRemoved[t])
+			{
+				continue;
+			}
+			const int32* Tri = &Corners[t * 3];
+			const FVector Normal = FVector::CrossProduct(Positions[Tri[1]] - Positions[Tri[0]], Positions[Tri[2]] - Positions[Tri[0]]).GetSafeNormal() * Facing;
+			for (int c = 0; c < 3; ++c)
+			{
+				Result.Triangles.Add(Result.Vertices.Add(Positions[Tri[c]]));
+				Result.Normals.Add(Normal);
+				Result.UVs.Add(Mesh.UVs[Sources[Tri[c]]]);
+				Result.Colors.Add(Mesh.Colors[Sources[Tri[c]]]);
+			}
+		}
+	}
+	else
+	{
+		TArray<int32> NewIndex;
+		NewIndex.Init(INDEX_NONE, NumVertices);
+		for (int32 t = 0; t < NumTriangles; ++t)
+		{
+			if (TriangleRemoved[t])
+			{
+				continue;
+			}
+			for (int c = 0; c < 3; ++c)
+			{
+				const int32 Vertex = Corners[t * 3 + c];
+				if (NewIndex[Vertex] == INDEX_NONE)
+				{
+					const int32 Source = Sources[Vertex];
+					NewIndex[Vertex] = Result.Vertices.Add(Positions[Vertex]);
+					Result.Normals.Add(Mesh.Normals[Source]);
+					Result.UVs.Add(Mesh.UVs[Source]);
+					Result.Colors.Add(Mesh.Colors[Source]);
+				}
+				Result.Triangles.Add(NewIndex[Vertex]);
+			}
+		}
+	}
+
+	Mesh = MoveTemp(Result);
+	const int32 Simplified = NumTriangles - Mesh.Triangles.Num() / 3;
+	INC_DWORD_STAT_BY(STAT_VoxelTrianglesSimplified, Simplified);
+	return Simplified;
+}
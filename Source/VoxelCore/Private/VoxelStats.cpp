@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelStats.h"
+
+DEFINE_LOG_CATEGORY(LogVoxel);
+
+DEFINE_STAT(STAT_VoxelVoxelize);
+DEFINE_STAT(STAT_VoxelCarve);
+DEFINE_STAT(STAT_VoxelMarch);
+DEFINE_STAT(STAT_VoxelSimplify);
+DEFINE_STAT(STAT_VoxelMeshUpload);
+DEFINE_STAT(STAT_VoxelCollisionCook);
+DEFINE_STAT(STAT_VoxelNavDirty);
+
+DEFINE_STAT(STAT_VoxelVoxelsTouched);
+DEFINE_STAT(STAT_VoxelCellsMarched);
+DEFINE_STAT(STAT_VoxelTrianglesEmitted);
+DEFINE_STAT(STAT_VoxelTrianglesSimplified);
+DEFINE_STAT(STAT_VoxelEditsApplied);
+DEFINE_STAT(STAT_VoxelEditQueueDepth);
+DEFINE_STAT(STAT_VoxelEditLatency);
+
+FVoxelLatencyHistogram& FVoxelLatencyHistogram::GetEditLatency()
+{
+	static FVoxelLatencyHistogram Histogram;
+	return Histogram;
+}
+
+void FVoxelLatencyHistogram::Add(double Ms)
+{
+	int32 Bucket = 0;
+	while (Bucket < NumBuckets - 1 && Ms >= double(1 << Bucket))
+	{
+		++Bucket;
+	}
+	++Buckets[Bucket];
+	++Count;
+	TotalMs += Ms;
+	MaxMs = FMath::Max(MaxMs, Ms);
+	SET_FLOAT_STAT(STAT_VoxelEditLatency, Ms);
+}
+
+void FVoxelLatencyHistogram::Reset()
+{
+	*this = FVoxelLatencyHistogram();
+}
+
+double FVoxelLatencyHistogram::GetPercentile(double Percentile) const
+{
+	const uint32 Target = FMath::CeilToInt(Count * Percentile / 100.0);
+	uint32 Seen = 0;
+	for (int32 i = 0; i < NumBuckets - 1; ++i)
+	{
+		Seen += Buckets[i];
+		if (Seen >= Target)
+		{
+			return double(1 << i);
+		}
+	}
+	return MaxMs;
+}
+
+void FVoxelLatencyHistogram::Log() const
+{
+	if (Count == 0)
+	{
+		UE_LOG(LogVoxel, Display, TEXT("No edits timed yet"));
+		return;
+	}
+	UE_LOG(LogVoxel, Display, TEXT("Edit latency over %u edits: mean %.2f ms, p50 < %.0f ms, p99 < %.0f ms, max %.2f ms"),
+		Count, TotalMs / Count, GetPercentile(50.0), GetPercentile(99.0), MaxMs);
+	for (int32 i = 0; i < NumBuckets; ++i)
+	{
+		if (i < NumBuckets - 1)
+		{
+			UE_LOG(LogVoxel, Display, TEXT("  < %4d ms: %u"), 1 << i, Buckets[i]);
+		}
+		else
+		{
+			UE_LOG(LogVoxel, Display, TEXT("  >= %3d ms: %u"), 1 << (i - 1), Buckets[i]);
+		}
+	}
+}
@@ -0,0 +1,700 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VoxelStore.h"
+
+#include "VoxelStats.h"
+#include "Async/ParallelFor.h"
+
+void FVoxelStore::Init(const FIntVector& InDims, float Value, float InSurfaceLevel)
+{
+	Dims = InDims;
+	SurfaceLevel = InSurfaceLevel;
+	NumBricks = FIntVector(
+		FMath::DivideAndRoundUp(Dims.X, BrickSize),
+		FMath::DivideAndRoundUp(Dims.Y, BrickSize),
+		FMath::DivideAndRoundUp(Dims.Z, BrickSize));
+
+	Bricks.Reset();
+	Bricks.SetNum(NumBricks.X * NumBricks.Y * NumBricks.Z);
+	for (FBrick& Brick : Bricks)
+	{
+		Brick.Value = Value;
+	}
+	UniformMask.Init(1, Bricks.Num());
+
+	NumSupers = FIntVector(
+		FMath::DivideAndRoundUp(NumBricks.X, SuperSize),
+		FMath::DivideAndRoundUp(NumBricks.Y, SuperSize),
+		FMath::DivideAndRoundUp(NumBricks.Z, SuperSize));
+	FVoxelRange Range;
+	Range.Add(Value);
+	BrickRanges.Init(Range, Bricks.Num());
+	SuperRanges.Init(Range, NumSupers.X * NumSupers.Y * NumSupers.Z);
+	EmptyMask.Init(1, Bricks.Num());
+}
+
+template<typename GetterType>
+bool FVoxelStore::IsBrickUniform(int BX, int BY, int BZ, GetterType&& GetVoxel) const
+{
+	// The border is what keeps cells in the neighbouring bricks from interpolating towards the single value
+	const FIntVector Min(
+		FMath::Max(BX * BrickSize - 1, 0),
+		FMath::Max(BY * BrickSize - 1, 0),
+		FMath::Max(BZ * BrickSize - 1, 0));
+	const FIntVector Max(
+		FMath::Min((BX + 1) * BrickSize, Dims.X - 1),
+		FMath::Min((BY + 1) * BrickSize, Dims.Y - 1),
+		FMath::Min((BZ + 1) * BrickSize, Dims.Z - 1));
+
+	const bool bInside = GetVoxel(Min.X, Min.Y, Min.Z) <= SurfaceLevel;
+	for (int Z = Min.Z; Z <= Max.Z; ++Z)
+	{
+		for (int Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			for (int X = Min.X; X <= Max.X; ++X)
+			{
+				if ((GetVoxel(X, Y, Z) <= SurfaceLevel) != bInside)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void FVoxelStore::FromDense(const FIntVector& InDims, TArrayView<const float> Dense, float InSurfaceLevel)
+{
+	Init(InDims, 0.f, InSurfaceLevel);
+	check(Dense.Num() == Num());
+
+	// Rounded first when quantized, so the bricks are split on the values that are actually kept
+	auto GetDense = [&Dense, this](int X, int Y, int Z)
+	{
+		return Quantize(Dense[(Z * Dims.Y + Y) * Dims.X + X]);
+	};
+
+	ParallelFor(Bricks.Num(), [&](int32 BrickIndex)
+	{
+		const int BX = BrickIndex % NumBricks.X;
+		const int BY = (BrickIndex / NumBricks.X) % NumBricks.Y;
+		const int BZ = BrickIndex / (NumBricks.X * NumBricks.Y);
+		FBrick& Brick = Bricks[BrickIndex];
+
+		if (IsBrickUniform(BX, BY, BZ, GetDense))
+		{
+			// The average keeps a little of the shape for when an edit opens the brick up again
+			double Sum = 0.0;
+			int32 Count = 0;
+			for (int Z = BZ * BrickSize; Z < FMath::Min((BZ + 1) * BrickSize, Dims.Z); ++Z)
+			{
+				for (int Y = BY * BrickSize; Y < FMath::Min((BY + 1) * BrickSize, Dims.Y); ++Y)
+				{
+					for (int X = BX * BrickSize; X < FMath::Min((BX + 1) * BrickSize, Dims.X); ++X)
+					{
+						Sum += GetDense(X, Y, Z);
+						++Count;
+					}
+				}
+			}
+			Brick.Value = Quantize(Count > 0 ? float(Sum / Count) : 0.f);
+			return;
+		}
+
+		UniformMask[BrickIndex] = 0;
+		if (IsQuantized())
+		{
+			Brick.Steps.SetNumZeroed(BrickSize * BrickSize * BrickSize);
+		}
+		else
+		{
+			Brick.Values.SetNumZeroed(BrickSize * BrickSize * BrickSize);
+		}
+		for (int Z = BZ * BrickSize; Z < FMath::Min((BZ + 1) * BrickSize, Dims.Z); ++Z)
+		{
+			for (int Y = BY * BrickSize; Y < FMath::Min((BY + 1) * BrickSize, Dims.Y); ++Y)
+			{
+				for (int X = BX * BrickSize; X < FMath::Min((BX + 1) * BrickSize, Dims.X); ++X)
+				{
+					if (IsQuantized())
+					{
+						Brick.Steps[GetLocalIndex(X, Y, Z)] = ToSteps(GetDense(X, Y, Z));
+					}
+					else
+					{
+						Brick.Values[GetLocalIndex(X, Y, Z)] = GetDense(X, Y, Z);
+					}
+				}
+			}
+		}
+	});
+
+	UpdateRanges(FIntVector::ZeroValue, NumBricks - FIntVector(1));
+}
+
+void FVoxelStore::ToDense(TArray<float>& Out) const
+{
+	if (Num() == 0)
+	{
+		Out.Reset();
+		return;
+	}
+	CopyBox(FIntVector::ZeroValue, Dims - FIntVector(1), Out);
+}
+
+void FVoxelStore::Set(int X, int Y, int Z, float InValue)
+{
+	const float Value = Quantize(InValue);
+	const FIntVector BrickCoord(X / BrickSize, Y / BrickSize, Z / BrickSize);
+	const int32 BrickIndex = GetBrickIndex(BrickCoord.X, BrickCoord.Y, BrickCoord.Z);
+	FBrick& Brick = Bricks[BrickIndex];
+	if (!Brick.IsExpanded())
+	{
+		if (Brick.Value == Value)
+		{
+			return;
+		}
+		Expand(BrickIndex);
+	}
+	if (IsQuantized())
+	{
+		Brick.Steps[GetLocalIndex(X, Y, Z)] = ToSteps(Value);
+	}
+	else
+	{
+		Brick.Values[GetLocalIndex(X, Y, Z)] = Value;
+	}
+	WidenRanges(X, Y, Z, Value);
+
+	// Neighbours kept as one value count on their border voxels being on their side of the surface,
+	// otherwise the mesher would skip cells that now have a surface in them
+	const bool bInside = Value <= SurfaceLevel;
+	const FIntVector Local(X % BrickSize, Y % BrickSize, Z % BrickSize);
+	for (int DZ = -1; DZ <= 1; ++DZ)
+	{
+		for (int DY = -1; DY <= 1; ++DY)
+		{
+			for (int DX = -1; DX <= 1; ++DX)
+			{
+				const FIntVector Offset(DX, DY, DZ);
+				bool bOnBorder = Offset != FIntVector::ZeroValue;
+				for (int Axis = 0; Axis < 3 && bOnBorder; ++Axis)
+				{
+					bOnBorder = Offset[Axis] == 0 || (Offset[Axis] < 0 ? Local[Axis] == 0 : Local[Axis] == BrickSize - 1);
+				}
+				const FIntVector Neighbour = BrickCoord + Offset;
+				if (!bOnBorder || Neighbour.X < 0 || Neighbour.Y < 0 || Neighbour.Z < 0
+					|| Neighbour.X >= NumBricks.X || Neighbour.Y >= NumBricks.Y || Neighbour.Z >= NumBricks.Z)
+				{
+					continue;
+				}
+				const int32 NeighbourIndex = GetBrickIndex(Neighbour.X, Neighbour.Y, Neighbour.Z);
+				if (UniformMask[NeighbourIndex] && (Bricks[NeighbourIndex].Value <= SurfaceLevel) != bInside)
+				{
+					Expand(NeighbourIndex);
+				}
+			}
+		}
+	}
+}
+
+void FVoxelStore::Expand(int32 BrickIndex)
+{
+	FBrick& Brick = Bricks[BrickIndex];
+	if (IsQuantized())
+	{
+		Brick.Steps.Init(ToSteps(Brick.Value), BrickSize * BrickSize * BrickSize);
+	}
+	else
+	{
+		Brick.Values.Init(Brick.Value, BrickSize * BrickSize * BrickSize);
+	}
+	UniformMask[BrickIndex] = 0;
+}
+
+void FVoxelStore::SetQuantum(float InQuantum)
+{
+	const float NewQuantum = FMath::Max(InQuantum, 0.f);
+	if (NewQuantum == Quantum)
+	{
+		return;
+	}
+	if (IsEmpty())
+	{
+		Quantum = NewQuantum;
+		return;
+	}
+
+	// Rounding can move voxels across the surface next to a collapsed brick, so the bricks are split again
+	TArray<float> Dense;
+	ToDense(Dense);
+	Quantum = NewQuantum;
+	FromDense(Dims, Dense, SurfaceLevel);
+}
+
+void FVoxelStore::CopyBox(const FIntVector& Min, const FIntVector& Max, TArray<float>& Out) const
+{
+	const int RowLength = Max.X - Min.X + 1;
+	Out.SetNumUninitialized(RowLength * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1));
+	float* Dest = Out.GetData();
+	for (int Z = Min.Z; Z <= Max.Z; ++Z)
+	{
+		for (int Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			// One brick at a time along the row, uniform ones are a fill
+			for (int X = Min.X; X <= Max.X;)
+			{
+				const int RunEnd = FMath::Min((X / BrickSize + 1) * BrickSize, Max.X + 1);
+				const FBrick& Brick = Bricks[GetBrickIndex(X / BrickSize, Y / BrickSize, Z / BrickSize)];
+				if (!Brick.Steps.IsEmpty())
+				{
+					const int16* Steps = &Brick.Steps[GetLocalIndex(X, Y, Z)];
+					for (int i = X; i < RunEnd; ++i)
+					{
+						*Dest++ = *Steps++ * Quantum;
+					}
+				}
+				else if (Brick.Values.IsEmpty())
+				{
+					for (int i = X; i < RunEnd; ++i)
+					{
+						*Dest++ = Brick.Value;
+					}
+				}
+				else
+				{
+					FMemory::Memcpy(Dest, &Brick.Values[GetLocalIndex(X, Y, Z)], (RunEnd - X) * sizeof(float));
+					Dest += RunEnd - X;
+				}
+				X = RunEnd;
+			}
+		}
+	}
+}
+
+void FVoxelStore::CopyBox(const FIntVector& Min, const FIntVector& Max, FVoxelBoxCopy& Out) const
+{
+	Out.Quantum = Quantum;
+	if (!IsQuantized())
+	{
+		Out.Steps.Reset();
+		CopyBox(Min, Max, Out.Values);
+		return;
+	}
+
+	// Same walk as the float copy at half the bytes, the mesher reads the steps as they are
+	Out.Values.Reset();
+	const int RowLength = Max.X - Min.X + 1;
+	Out.Steps.SetNumUninitialized(RowLength * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1));
+	int16* Dest = Out.Steps.GetData();
+	for (int Z = Min.Z; Z <= Max.Z; ++Z)
+	{
+		for (int Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			for (int X = Min.X; X <= Max.X;)
+			{
+				const int RunEnd = FMath::Min((X / BrickSize + 1) * BrickSize, Max.X + 1);
+				const FBrick& Brick = Bricks[GetBrickIndex(X / BrickSize, Y / BrickSize, Z / BrickSize)];
+				if (Brick.Steps.IsEmpty())
+				{
+					const int16 Step = ToSteps(Brick.Value);
+					for (int i = X; i < RunEnd; ++i)
+					{
+						*Dest++ = Step;
+					}
+				}
+				else
+				{
+					FMemory::Memcpy(Dest, &Brick.Steps[GetLocalIndex(X, Y, Z)], (RunEnd - X) * sizeof(int16));
+					Dest += RunEnd - X;
+				}
+				X = RunEnd;
+			}
+		}
+	}
+}
+
+void FVoxelStore::Collapse(int32 BrickIndex)
+{
+	FBrick& Brick = Bricks[BrickIndex];
+	double Sum = 0.0;
+	for (float Value : Brick.Values)
+	{
+		Sum += Value;
+	}
+	for (int16 Step : Brick.Steps)
+	{
+		Sum += Step * Quantum;
+	}
+	Brick.Value = Quantize(float(Sum / (Brick.Values.Num() + Brick.Steps.Num())));
+	Brick.Values.Empty();
+	Brick.Steps.Empty();
+	UniformMask[BrickIndex] = 1;
+}
+
+void FVoxelStore::Compact(const FIntVector& BrickMin, const FIntVector& BrickMax)
+{
+	auto GetStored = [this](int X, int Y, int Z)
+	{
+		return Get(X, Y, Z);
+	};
+
+	for (int BZ = FMath::Max(BrickMin.Z, 0); BZ <= FMath::Min(BrickMax.Z, NumBricks.Z - 1); ++BZ)
+	{
+		for (int BY = FMath::Max(BrickMin.Y, 0); BY <= FMath::Min(BrickMax.Y, NumBricks.Y - 1); ++BY)
+		{
+			for (int BX = FMath::Max(BrickMin.X, 0); BX <= FMath::Min(BrickMax.X, NumBricks.X - 1); ++BX)
+			{
+				const int32 BrickIndex = GetBrickIndex(BX, BY, BZ);
+				if (Bricks[BrickIndex].IsExpanded() && IsBrickUniform(BX, BY, BZ, GetStored))
+				{
+					Collapse(BrickIndex);
+				}
+			}
+		}
+	}
+
+	// Collapsing moves values, and the bricks below see the border of the ones collapsed
+	UpdateRanges(BrickMin - FIntVector(1), BrickMax);
+}
+
+FVoxelRegion FVoxelStore::ApplyBrush(const FVoxelBrush& Brush, TBitArray<>* HitStatus)
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelCarve);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FVoxelStore::ApplyBrush);
+	FVoxelRegion Edited;
+	if (IsEmpty())
+	{
+		return Edited;
+	}
+
+	FIntVector BoxMin;
+	FIntVector BoxMax;
+	Brush.GetBounds(BoxMin, BoxMax);
+	BoxMin = BoxMin.ComponentMax(FIntVector::ZeroValue);
+	BoxMax = BoxMax.ComponentMin(Dims - FIntVector(1));
+
+	// A brick whose value range the brush can't reach has nothing to change, the same goes for a whole super
+	// brick. Repeated shots into the same crater only touch its rim.
+	const float BrickReach = FMath::Sqrt(3.f) * BrickSize * 0.5f;
+	const float SuperReach = BrickReach * SuperSize;
+	const bool bFlagHits = HitStatus && Brush.IsSubtractive();
+	int32 Touched = 0;
+	float Distances[BrickSize] = {};
+	float OldValues[BrickSize] = {};
+	float NewValues[BrickSize] = {};
+	for (int BZ = BoxMin.Z / BrickSize; BZ <= BoxMax.Z / BrickSize; ++BZ)
+	{
+		for (int BY = BoxMin.Y / BrickSize; BY <= BoxMax.Y / BrickSize; ++BY)
+		{
+			for (int BX = BoxMin.X / BrickSize; BX <= BoxMax.X / BrickSize; ++BX)
+			{
+				const FIntVector SuperStart = FIntVector(BX, BY, BZ) / SuperSize * SuperSize * BrickSize;
+				const FVoxelRange& Super = SuperRanges[GetSuperIndex(BX, BY, BZ)];
+				const FVoxelRange& BrickRange = BrickRanges[GetBrickIndex(BX, BY, BZ)];
+				if (!Brush.MayChange(FVector3f(SuperStart) + FVector3f(SuperSize * BrickSize * 0.5f), SuperReach, Super.Min, Super.Max)
+					|| !Brush.MayChange(FVector3f(BX + 0.5f, BY + 0.5f, BZ + 0.5f) * BrickSize, BrickReach, BrickRange.Min, BrickRange.Max))
+				{
+					continue;
+				}
+
+				const int32 BrickIndex = GetBrickIndex(BX, BY, BZ);
+				const int RowMin = FMath::Max(BoxMin.X, BX * BrickSize);
+				const int Count = FMath::Min(BoxMax.X, (BX + 1) * BrickSize - 1) - RowMin + 1;
+				for (int Z = FMath::Max(BoxMin.Z, BZ * BrickSize); Z <= FMath::Min(BoxMax.Z, (BZ + 1) * BrickSize - 1); ++Z)
+				{
+					for (int Y = FMath::Max(BoxMin.Y, BY * BrickSize); Y <= FMath::Min(BoxMax.Y, (BY + 1) * BrickSize - 1); ++Y)
+					{
+						// The brick may have been expanded by the row before
+						const FBrick& Brick = Bricks[BrickIndex];
+						if (!Brick.Steps.IsEmpty())
+						{
+							const int16* Steps = Brick.Steps.GetData() + GetLocalIndex(RowMin, Y, Z);
+							for (int i = 0; i < Count; ++i)
+							{
+								OldValues[i] = Steps[i] * Quantum;
+							}
+						}
+						else if (Brick.Values.IsEmpty())
+						{
+							for (int i = 0; i < BrickSize; ++i)
+							{
+								OldValues[i] = Brick.Value;
+							}
+						}
+						else
+						{
+							FMemory::Memcpy(OldValues, Brick.Values.GetData() + GetLocalIndex(RowMin, Y, Z), Count * sizeof(float));
+						}
+						FMemory::Memcpy(NewValues, OldValues, sizeof(NewValues));
+						Brush.GetRowDistances(FVector3f(RowMin, Y, Z), Count, Distances);
+						Brush.CombineRow(Distances, Count, NewValues);
+						// Changes smaller than half a step aren't changes in a quantized store
+						if (IsQuantized())
+						{
+							for (int i = 0; i < Count; ++i)
+							{
+								NewValues[i] = Quantize(NewValues[i]);
+							}
+						}
+
+						for (int i = 0; i < Count; ++i)
+						{
+							if (NewValues[i] == OldValues[i])
+							{
+								continue;
+							}
+							const int X = RowMin + i;
+							Set(X, Y, Z, NewValues[i]);
+							if (bFlagHits)
+							{
+								(*HitStatus)[(Z * Dims.Y + Y) * Dims.X + X] = true;
+							}
+							Edited.Add(X, Y, Z);
+							++Touched;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_VoxelVoxelsTouched, Touched);
+
+	// Bricks carved out completely (and their neighbours, whose border just changed) can go back to one value.
+	// Subtract and Union also leave ranges wider than the values that are left, which this tightens again.
+	if (!Edited.IsEmpty())
+	{
+		Compact(Edited.Min / BrickSize - FIntVector(1), Edited.Max / BrickSize + FIntVector(1));
+	}
+	return Edited;
+}
+
+FVoxelRegion FVoxelStore::CarveSphere(const FVector& Center, float Radius, float HoleValue, TBitArray<>* HitStatus)
+{
+	FVoxelBrush Brush = FVoxelBrush::MakeSphere(FVector3f(Center), Radius);
+	Brush.HoleValue = HoleValue;
+	return ApplyBrush(Brush, HitStatus);
+}
+
+void FVoxelStore::GetBrick(int32 BrickIndex, float& OutValue, TArray<float>& OutValues) const
+{
+	const FBrick& Brick = Bricks[BrickIndex];
+	OutValue = Brick.Value;
+	OutValues = Brick.Values;
+	for (int16 Step : Brick.Steps)
+	{
+		OutValues.Add(Step * Quantum);
+	}
+}
+
+void FVoxelStore::SetBrick(int32 BrickIndex, float Value, TArrayView<const float> Values)
+{
+	FBrick& Brick = Bricks[BrickIndex];
+	Brick.Value = Quantize(Value);
+	Brick.Values.Reset();
+	Brick.Steps.Reset();
+	if (IsQuantized())
+	{
+		for (float Voxel : Values)
+		{
+			Brick.Steps.Add(ToSteps(Voxel));
+		}
+	}
+	else
+	{
+		Brick.Values = TArray<float>(Values);
+	}
+	UniformMask[BrickIndex] = Values.IsEmpty() ? 1 : 0;
+
+	const FIntVector BrickCoord(BrickIndex % NumBricks.X, (BrickIndex / NumBricks.X) % NumBricks.Y, BrickIndex / (NumBricks.X * NumBricks.Y));
+	UpdateRanges(BrickCoord - FIntVector(1), BrickCoord);
+}
+
+void FVoxelStore::CollectBricks(const FVoxelRegion& Region, TSet<int32>& Out) const
+{
+	if (Region.IsEmpty())
+	{
+		return;
+	}
+	const FIntVector BrickMin = Region.Min / BrickSize - FIntVector(1);
+	const FIntVector BrickMax = Region.Max / BrickSize + FIntVector(1);
+	for (int BZ = FMath::Max(BrickMin.Z, 0); BZ <= FMath::Min(BrickMax.Z, NumBricks.Z - 1); ++BZ)
+	{
+		for (int BY = FMath::Max(BrickMin.Y, 0); BY <= FMath::Min(BrickMax.Y, NumBricks.Y - 1); ++BY)
+		{
+			for (int BX = FMath::Max(BrickMin.X, 0); BX <= FMath::Min(BrickMax.X, NumBricks.X - 1); ++BX)
+			{
+				Out.Add(GetBrickIndex(BX, BY, BZ));
+			}
+		}
+	}
+}
+
+bool FVoxelStore::MayContainSurface(const FIntVector& Min, const FIntVector& Max) const
+{
+	const FIntVector BrickMin = Min / BrickSize;
+	const FIntVector BrickMax = Max / BrickSize;
+	for (int SZ = BrickMin.Z / SuperSize; SZ <= BrickMax.Z / SuperSize; ++SZ)
+	{
+		for (int SY = BrickMin.Y / SuperSize; SY <= BrickMax.Y / SuperSize; ++SY)
+		{
+			for (int SX = BrickMin.X / SuperSize; SX <= BrickMax.X / SuperSize; ++SX)
+			{
+				if (!SuperRanges[(SZ * NumSupers.Y + SY) * NumSupers.X + SX].Crosses(SurfaceLevel))
+				{
+					continue;
+				}
+
+				// Only the bricks of a super brick that has a surface somewhere are looked at
+				for (int BZ = FMath::Max(BrickMin.Z, SZ * SuperSize); BZ <= FMath::Min(BrickMax.Z, (SZ + 1) * SuperSize - 1); ++BZ)
+				{
+					for (int BY = FMath::Max(BrickMin.Y, SY * SuperSize); BY <= FMath::Min(BrickMax.Y, (SY + 1) * SuperSize - 1); ++BY)
+					{
+						for (int BX = FMath::Max(BrickMin.X, SX * SuperSize); BX <= FMath::Min(BrickMax.X, (SX + 1) * SuperSize - 1); ++BX)
+						{
+							if (!EmptyMask[GetBrickIndex(BX, BY, BZ)])
+							{
+								return true;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+FVoxelRange FVoxelStore::ComputeBrickRange(int BX, int BY, int BZ) const
+{
+	FVoxelRange Range;
+	const FIntVector Min(BX * BrickSize, BY * BrickSize, BZ * BrickSize);
+	const FIntVector Max(
+		FMath::Min((BX + 1) * BrickSize, Dims.X - 1),
+		FMath::Min((BY + 1) * BrickSize, Dims.Y - 1),
+		FMath::Min((BZ + 1) * BrickSize, Dims.Z - 1));
+
+	// When the brick and the bricks its border reaches into are single values, those are the whole range
+	bool bAllUniform = true;
+	for (int Z = BZ; Z <= Max.Z / BrickSize && bAllUniform; ++Z)
+	{
+		for (int Y = BY; Y <= Max.Y / BrickSize && bAllUniform; ++Y)
+		{
+			for (int X = BX; X <= Max.X / BrickSize && bAllUniform; ++X)
+			{
+				const FBrick& Brick = Bricks[GetBrickIndex(X, Y, Z)];
+				bAllUniform = !Brick.IsExpanded();
+				Range.Add(Brick.Value);
+			}
+		}
+	}
+	if (bAllUniform)
+	{
+		return Range;
+	}
+
+	Range = FVoxelRange();
+	for (int Z = Min.Z; Z <= Max.Z; ++Z)
+	{
+		for (int Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			for (int X = Min.X; X <= Max.X; ++X)
+			{
+				Range.Add(Get(X, Y, Z));
+			}
+		}
+	}
+	return Range;
+}
+
+void FVoxelStore::UpdateRanges(const FIntVector& InBrickMin, const FIntVector& InBrickMax)
+{
+	const FIntVector BrickMin = InBrickMin.ComponentMax(FIntVector::ZeroValue);
+	const FIntVector BrickMax = InBrickMax.ComponentMin(NumBricks - FIntVector(1));
+	if (BrickMin.X > BrickMax.X || BrickMin.Y > BrickMax.Y || BrickMin.Z > BrickMax.Z)
+	{
+		return;
+	}
+
+	const FIntVector Size = BrickMax - BrickMin + FIntVector(1);
+	const int32 Count = Size.X * Size.Y * Size.Z;
+	ParallelFor(Count, [&](int32 i)
+	{
+		const int BX = BrickMin.X + i % Size.X;
+		const int BY = BrickMin.Y + (i / Size.X) % Size.Y;
+		const int BZ = BrickMin.Z + i / (Size.X * Size.Y);
+		const int32 BrickIndex = GetBrickIndex(BX, BY, BZ);
+		BrickRanges[BrickIndex] = ComputeBrickRange(BX, BY, BZ);
+		EmptyMask[BrickIndex] = BrickRanges[BrickIndex].Crosses(SurfaceLevel) ? 0 : 1;
+	}, Count < 64 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	const FIntVector SuperMin = BrickMin / SuperSize;
+	const FIntVector SuperMax = BrickMax / SuperSize;
+	for (int SZ = SuperMin.Z; SZ <= SuperMax.Z; ++SZ)
+	{
+		for (int SY = SuperMin.Y; SY <= SuperMax.Y; ++SY)
+		{
+			for (int SX = SuperMin.X; SX <= SuperMax.X; ++SX)
+			{
+				FVoxelRange Range;
+				for (int BZ = SZ * SuperSize; BZ < FMath::Min((SZ + 1) * SuperSize, NumBricks.Z); ++BZ)
+				{
+					for (int BY = SY * SuperSize; BY < FMath::Min((SY + 1) * SuperSize, NumBricks.Y); ++BY)
+					{
+						for (int BX = SX * SuperSize; BX < FMath::Min((SX + 1) * SuperSize, NumBricks.X); ++BX)
+						{
+							Range.Add(BrickRanges[GetBrickIndex(BX, BY, BZ)]);
+						}
+					}
+				}
+				SuperRanges[(SZ * NumSupers.Y + SY) * NumSupers.X + SX] = Range;
+			}
+		}
+	}
+}
+
+void FVoxelStore::WidenRanges(int X, int Y, int Z, float Value)
+{
+	// The voxel is in its own brick, and on the border of the bricks below it when it is first along an axis
+	const FIntVector BrickCoord(X / BrickSize, Y / BrickSize, Z / BrickSize);
+	const FIntVector Low(
+		X % BrickSize == 0 ? FMath::Max(BrickCoord.X - 1, 0) : BrickCoord.X,
+		Y % BrickSize == 0 ? FMath::Max(BrickCoord.Y - 1, 0) : BrickCoord.Y,
+		Z % BrickSize == 0 ? FMath::Max(BrickCoord.Z - 1, 0) : BrickCoord.Z);
+	for (int BZ = Low.Z; BZ <= BrickCoord.Z; ++BZ)
+	{
+		for (int BY = Low.Y; BY <= BrickCoord.Y; ++BY)
+		{
+			for (int BX = Low.X; BX <= BrickCoord.X; ++BX)
+			{
+				const int32 BrickIndex = GetBrickIndex(BX, BY, BZ);
+				BrickRanges[BrickIndex].Add(Value);
+				EmptyMask[BrickIndex] = BrickRanges[BrickIndex].Crosses(SurfaceLevel) ? 0 : 1;
+				SuperRanges[GetSuperIndex(BX, BY, BZ)].Add(Value);
+			}
+		}
+	}
+}
+
+int32 FVoxelStore::NumDenseBricks() const
+{
+	int32 Dense = 0;
+	for (uint8 bUniform : UniformMask)
+	{
+		Dense += bUniform ? 0 : 1;
+	}
+	return Dense;
+}
+
+SIZE_T FVoxelStore::GetAllocatedSize() const
+{
+	SIZE_T Size = Bricks.GetAllocatedSize() + UniformMask.GetAllocatedSize() + EmptyMask.GetAllocatedSize()
+		+ BrickRanges.GetAllocatedSize() + SuperRanges.GetAllocatedSize();
+	for (const FBrick& Brick : Bricks)
+	{
+		Size += Brick.Values.GetAllocatedSize() + Brick.Steps.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Angle weighted pseudo-normals (Baerentzen & Aanaes) for a closed triangle soup.
+//The sign of (P - ClosestPoint) dot PseudoNormal tells whether P is inside the mesh, using only the
+//closest triangle, so inside/outside costs one nearest-triangle query.
+class VOXELCORE_API FMeshPseudoNormals
+{
+public:
+	void Build(const TArray<FVector>& Vertices, const TArray<int>& Indices);
+
+	bool IsEmpty() const { return FaceNormals.IsEmpty(); }
+
+	//Pseudo-normal at ClosestPoint, which must lie on the triangle starting at Indices[FirstIndex].
+	//Picks the face, edge or vertex normal depending on where on the triangle the point is.
+	FVector GetNormal(int32 FirstIndex, const FVector& ClosestPoint) const;
+
+	//True when P is behind the surface at ClosestPoint
+	bool IsInside(const FVector& P, int32 FirstIndex, const FVector& ClosestPoint) const;
+
+private:
+	static uint64 EdgeKey(int32 A, int32 B)
+	{
+		return A < B ? (uint64(uint32(A)) << 32) | uint32(B) : (uint64(uint32(B)) << 32) | uint32(A);
+	}
+
+	//Render data splits vertices on UV seams, so corners are welded by position
+	TArray<int32> WeldedCorners;
+	TArray<FVector> Corners;
+	TArray<FVector> FaceNormals;
+	TArray<FVector> VertexNormals;
+	TMap<uint64, FVector> EdgeNormals;
+};
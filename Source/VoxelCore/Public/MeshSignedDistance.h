@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FTriangleBVH;
+class FMeshPseudoNormals;
+
+//Signed distance to a closed triangle soup, positive inside. What static meshes are voxelized with.
+//Only views its inputs, which have to outlive it. Copies are cheap, so every worker can take one.
+struct VOXELCORE_API FMeshSignedDistance
+{
+	TConstArrayView<FVector> Vertices;
+	//Three per triangle
+	TConstArrayView<int32> Indices;
+	//Optional, built over the same soup. Without it every query tests every triangle.
+	const FTriangleBVH* BVH = nullptr;
+	//Optional, built over the same soup. Needed for bPseudoNormalSign.
+	const FMeshPseudoNormals* PseudoNormals = nullptr;
+
+	//Distance from P to the closest triangle, FLT_MAX when there are none.
+	//OutTriangle is the index of the triangle's first entry in Indices.
+	float ClosestDistance(const FVector& P, int32* OutTriangle = nullptr, FVector* OutClosestPoint = nullptr) const;
+	//Number of triangles crossed by the segment
+	int32 CountSegmentHits(const FVector& Start, const FVector& End) const;
+	//Majority vote of ray crossing parity over 10 directions
+	bool IsInsideByRayVoting(const FVector& P) const;
+
+	//Signed by the pseudo-normal of the closest triangle when bPseudoNormalSign and PseudoNormals are set,
+	//by ray voting otherwise
+	float SignedDistance(const FVector& P, bool bPseudoNormalSign) const;
+};
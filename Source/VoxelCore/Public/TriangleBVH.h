@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Bounding volume hierarchy over a triangle soup, used to voxelize static meshes.
+//Triangles are split on the longest axis of their centroid bounds until a leaf holds a handful of them.
+class VOXELCORE_API FTriangleBVH
+{
+public:
+	void Build(const TArray<FVector>& Vertices, const TArray<int>& Indices);
+
+	bool IsEmpty() const { return Nodes.IsEmpty(); }
+	int32 NumTriangles() const { return TriangleIds.Num(); }
+
+	//Distance from P to the closest triangle, FLT_MAX when empty.
+	//OutTriangle is the index of the triangle's first entry in the Indices passed to Build.
+	float ClosestDistance(const FVector& P, int32* OutTriangle = nullptr, FVector* OutClosestPoint = nullptr) const;
+
+	//Number of triangles crossed by the segment, same result as testing every triangle
+	int32 CountSegmentHits(const FVector& Start, const FVector& End) const;
+
+	//Seconds spent in the last Build
+	double BuildSeconds = 0.0;
+
+private:
+	struct FNode
+	{
+		FBox Bounds;
+		//Leaf: first triangle in TriangleIds. Inner: index of the left child, the right child follows the left subtree.
+		int32 Start = 0;
+		//Triangles in a leaf, 0 for inner nodes
+		int32 Count = 0;
+		int32 RightChild = INDEX_NONE;
+	};
+
+	static constexpr int32 MaxLeafTriangles = 4;
+
+	int32 BuildNode(const TArray<FVector>& Centroids, const TArray<FBox>& TriangleBounds, int32 Start, int32 Count);
+	static bool SegmentHitsBox(const FBox& Box, const FVector& Start, const FVector& InvDir, const FVector& Dir);
+
+	TArray<FNode> Nodes;
+	//Triangle index (into Indices / 3) in leaf order
+	TArray<int32> TriangleIds;
+	//Corners of each triangle stored in leaf order, 3 per triangle
+	TArray<FVector> Corners;
+};
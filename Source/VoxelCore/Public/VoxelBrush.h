@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EVoxelBrushShape : uint8
+{
+	Sphere,
+	//Sphere swept from Start to End
+	Capsule,
+	Box,
+	//Base at Start, tip at End
+	Cone
+};
+
+enum class EVoxelBrushOp : uint8
+{
+	//Clamps the voxels inside the shape to HoleValue, what MakeHole has always done
+	Carve,
+	//Removes the shape, min(Voxel, -Shape)
+	Subtract,
+	//Adds the shape, max(Voxel, Shape)
+	Union
+};
+
+//An analytic shape combined into the voxels. Positions and sizes are in voxels, the shape's distance is positive
+//inside like the voxels and multiplied by DistanceScale before it is compared with them.
+struct VOXELCORE_API FVoxelBrush
+{
+	EVoxelBrushShape Shape = EVoxelBrushShape::Sphere;
+	EVoxelBrushOp Operation = EVoxelBrushOp::Carve;
+	//Sphere and box center, capsule start, cone base
+	FVector3f Start = FVector3f::ZeroVector;
+	//Capsule end, cone tip
+	FVector3f End = FVector3f::ZeroVector;
+	//Sphere and capsule radius, cone base radius
+	float Radius = 0.f;
+	//Box half size along its own axes
+	FVector3f Extent = FVector3f::ZeroVector;
+	FQuat4f Rotation = FQuat4f::Identity;
+	//Subtract and Union blend in over this many voxels with a smooth min instead of meeting at a crease
+	float Smoothing = 0.f;
+	//World units per voxel, what the stored distances are measured in
+	float DistanceScale = 1.f;
+	//What Carve writes
+	float HoleValue = 0.f;
+
+	static FVoxelBrush MakeSphere(const FVector3f& Center, float Radius);
+	static FVoxelBrush MakeCapsule(const FVector3f& Start, const FVector3f& End, float Radius);
+	static FVoxelBrush MakeBox(const FVector3f& Center, const FVector3f& Extent, const FQuat4f& Rotation = FQuat4f::Identity);
+	static FVoxelBrush MakeCone(const FVector3f& Base, const FVector3f& Tip, float Radius);
+
+	//Inclusive voxel range the brush is evaluated in, not clamped to any grid. Subtract and Union reach a couple of
+	//voxels past the shape so the values next to the new surface are right, further out no sign can change.
+	void GetBounds(FIntVector& OutMin, FIntVector& OutMax) const;
+
+	//Shape distance of P in voxels
+	float GetDistance(const FVector3f& P) const;
+	//Shape distances of Count voxels along X from RowStart, four lanes at a time.
+	//Out needs room for Count rounded up to a multiple of four.
+	void GetRowDistances(const FVector3f& RowStart, int32 Count, float* Out) const;
+	//Combines Count voxel values in place with their shape distances, padded like GetRowDistances
+	void CombineRow(const float* Distances, int32 Count, float* Values) const;
+	//Whether any voxel within Reach voxels of Center whose value is in [RangeMin, RangeMax] can change.
+	//Every shape distance is exact, so it can't differ by more than Reach from the one at Center.
+	bool MayChange(const FVector3f& Center, float Reach, float RangeMin, float RangeMax) const;
+
+	//Carve and Subtract, the edits that destroy
+	bool IsSubtractive() const { return Operation != EVoxelBrushOp::Union; }
+};
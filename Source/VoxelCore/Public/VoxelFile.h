@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Everything a .voxel file holds
+struct FVoxelFileData
+{
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	int32 SizeZ = 0;
+	float VoxelSize = 0.f;
+	TArray<float> Voxels;
+};
+
+//Reads and writes .voxel files.
+//v1 is three int32 sizes, the voxel size, a count and raw float voxels, with nothing to tell it apart from garbage.
+//v2 starts with a magic number and version. The voxels follow as fixed size blocks, each compressed on its
+//own so they can be packed and unpacked in parallel, and a CRC covers everything after the magic number.
+class VOXELCORE_API FVoxelFile
+{
+public:
+	static constexpr uint32 Magic = 0x4C584F56; // "VOXL"
+	static constexpr uint32 Version = 2;
+	static constexpr int32 BlockVoxels = 64 * 1024;
+
+	enum class EEncoding : uint8
+	{
+		Float32,
+		//Offset + Value * Scale, anything further than the quantize range from the offset is clamped
+		Int16
+	};
+
+	//QuantizeRange > 0 stores int16 distances clamped to Center +- QuantizeRange, 0 keeps full floats
+	static void Write(const FVoxelFileData& Data, float QuantizeCenter, float QuantizeRange, TArray<uint8>& Out);
+
+	//Reads v1 and v2 files. False when the data is truncated, corrupt or from another version.
+	static bool Read(TArrayView<const uint8> File, FVoxelFileData& Out, uint32* OutVersion = nullptr);
+
+	//Same as Read, straight from disk. v1 voxels are read directly into Out.Voxels, v2 only buffers the
+	//compressed blocks. Safe to call off the game thread.
+	static bool ReadFile(const TCHAR* Path, FVoxelFileData& Out, uint32* OutVersion = nullptr, int64* OutFileSize = nullptr);
+
+	//Size of the same voxels in the v1 layout, for comparing against
+	static int64 GetV1Size(int32 NumVoxels) { return V1HeaderSize + int64(NumVoxels) * sizeof(float); }
+
+private:
+	static constexpr int32 V1HeaderSize = sizeof(int32) * 4 + sizeof(float);
+
+	//Fills in the sizes and returns the voxel count, or 0 when the header is bad
+	static int32 ReadV1Header(TArrayView<const uint8> Header, FVoxelFileData& Out);
+	static bool ReadV1(TArrayView<const uint8> File, FVoxelFileData& Out);
+	static bool ReadV2(TArrayView<const uint8> File, FVoxelFileData& Out);
+	//CRC of a v2 file from after the magic to its end, skipping the CRC field at CrcOffset
+	static uint32 GetCrc(TArrayView<const uint8> File, int64 CrcOffset);
+};
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelBrush.h"
+
+class FVoxelStore;
+
+//One edit, in voxel coordinates of the grid so it doesn't depend on where the actor is.
+//DistanceScale and HoleValue aren't stored, they follow from the baseline's voxel size.
+struct FVoxelEdit
+{
+	uint32 Sequence = 0;
+	FVoxelBrush Brush;
+};
+
+//The bricks changed since the baseline .voxel file, as of edit Sequence
+struct FVoxelBrickSnapshot
+{
+	uint32 Sequence = 0;
+	FIntVector Dims = FIntVector::ZeroValue;
+	TArray<int32> Bricks;
+	//One value per uniform brick, BrickSize^3 per dense one, in the order of Bricks
+	TArray<uint8> bDense;
+	TArray<float> Values;
+};
+
+//Persists destruction on top of a baseline .voxel file.
+//The journal is a list of edits appended as they happen. The snapshot holds every brick changed since the
+//baseline and replaces the journal up to its sequence number, so loading copies bricks instead of replaying
+//every edit ever made. Everything here does file IO and is meant to run off the game thread.
+class VOXELCORE_API FVoxelJournal
+{
+public:
+	static FString GetJournalPath(const FString& BaselinePath) { return BaselinePath + TEXT(".journal"); }
+	static FString GetSnapshotPath(const FString& BaselinePath) { return BaselinePath + TEXT(".bricks"); }
+	//Where a new snapshot is written before it replaces the old one
+	static FString GetSnapshotTempPath(const FString& BaselinePath) { return GetSnapshotPath(BaselinePath) + TEXT(".tmp"); }
+
+	//Appends to the journal, starting a new one when there is none
+	static bool AppendEdits(const FString& BaselinePath, const FIntVector& Dims, TArrayView<const FVoxelEdit> Edits);
+	//Edits for a grid of Dims, nothing if the journal was written for another grid
+	static bool ReadEdits(const FString& BaselinePath, const FIntVector& Dims, TArray<FVoxelEdit>& Out);
+
+	//Writes the snapshot and drops the journal it makes redundant
+	static bool WriteSnapshot(const FString& BaselinePath, const FVoxelBrickSnapshot& Snapshot);
+	//Replaces the bricks of Into that Changes holds and adds the rest, so a snapshot can be kept up to date by
+	//copying only the bricks changed since the last one
+	static void MergeSnapshot(FVoxelBrickSnapshot& Into, const FVoxelBrickSnapshot& Changes);
+	//The newest intact snapshot, which is the .tmp when a crash interrupted WriteSnapshot swapping it in
+	static bool ReadSnapshot(const FString& BaselinePath, const FIntVector& Dims, FVoxelBrickSnapshot& Out);
+
+	//Forgets every edit, for when the baseline is rebaked
+	static void Delete(const FString& BaselinePath);
+
+	//Applies the snapshot and the journal after it to a store loaded from the baseline, replaying brushes with
+	//HoleValue and DistanceScale. Returns the last sequence number applied and fills OutChangedBricks with every
+	//brick that differs from the baseline. OutSnapshotSequence is the sequence the snapshot on disk was taken at.
+	static uint32 Restore(const FString& BaselinePath, FVoxelStore& Store, float HoleValue, float DistanceScale, TSet<int32>& OutChangedBricks, uint32& OutSnapshotSequence);
+
+private:
+	static constexpr uint32 JournalMagic = 0x4E524A56; // "VJRN"
+	static constexpr uint32 SnapshotMagic = 0x4B524256; // "VBRK"
+	//3 frames journal records with their length and CRC, 2 journals whole brushes, 1 only carved spheres
+	static constexpr uint32 Version = 3;
+
+	static bool ReadSnapshotFile(const FString& Path, const FIntVector& Dims, FVoxelBrickSnapshot& Out);
+};
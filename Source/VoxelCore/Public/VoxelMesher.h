@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Output of marching a chunk, uploaded as one mesh section
+struct FVoxelMeshBuffers
+{
+	TArray<FVector> Vertices;
+	TArray<int> Triangles;
+	TArray<FVector> Normals;
+	TArray<FColor> Colors;
+	TArray<FVector2D> UVs;
+
+	void Reset()
+	{
+		Vertices.Reset();
+		Triangles.Reset();
+		Normals.Reset();
+		Colors.Reset();
+		UVs.Reset();
+	}
+};
+
+//Read only window onto voxel values, either the whole grid or a copy of the voxels around a chunk.
+//Coordinates passed to Get are grid coordinates, Origin is the grid coordinate of Data[0].
+//A quantized copy sets QuantizedData instead of Data and Get returns its steps unscaled, the mesher moves the
+//surface level into steps rather than converting every voxel.
+struct FVoxelGridView
+{
+	const float* Data = nullptr;
+	const int16* QuantizedData = nullptr;
+	//World units per step of QuantizedData
+	float Quantum = 1.f;
+	FIntVector Origin = FIntVector::ZeroValue;
+	//Voxels along each axis
+	FIntVector Dims = FIntVector::ZeroValue;
+
+	//Optional, one byte per brick of BrickSize voxels (see FVoxelStore), in grid brick coordinates.
+	//Cells whose lowest corner is in a flagged brick have no surface and are skipped.
+	const uint8* EmptyBricks = nullptr;
+	FIntVector NumBricks = FIntVector::ZeroValue;
+	int32 BrickSize = 1;
+
+	int32 GetIndex(int X, int Y, int Z) const
+	{
+		return ((Z - Origin.Z) * Dims.Y + (Y - Origin.Y)) * Dims.X + (X - Origin.X);
+	}
+
+	float Get(int X, int Y, int Z) const
+	{
+		const int32 Index = GetIndex(X, Y, Z);
+		return QuantizedData ? float(QuantizedData[Index]) : Data[Index];
+	}
+
+	//Voxels from X onwards are contiguous up to the end of the row
+	const float* GetRow(int X, int Y, int Z) const
+	{
+		return Data + GetIndex(X, Y, Z);
+	}
+	const int16* GetQuantizedRow(int X, int Y, int Z) const
+	{
+		return QuantizedData + GetIndex(X, Y, Z);
+	}
+
+	//SurfaceLevel in the units Get returns
+	float ToViewUnits(float Value) const
+	{
+		return QuantizedData ? Value / Quantum : Value;
+	}
+
+	bool IsInEmptyBrick(int X, int Y, int Z) const
+	{
+		return EmptyBricks && EmptyBricks[((Z / BrickSize) * NumBricks.Y + Y / BrickSize) * NumBricks.X + X / BrickSize];
+	}
+
+	//Whether every cell in [CellMin, CellMax) is in an empty brick
+	bool IsBoxEmpty(const FIntVector& CellMin, const FIntVector& CellMax) const
+	{
+		if (!EmptyBricks)
+		{
+			return false;
+		}
+		for (int BZ = CellMin.Z / BrickSize; BZ <= (CellMax.Z - 1) / BrickSize; ++BZ)
+		{
+			for (int BY = CellMin.Y / BrickSize; BY <= (CellMax.Y - 1) / BrickSize; ++BY)
+			{
+				for (int BX = CellMin.X / BrickSize; BX <= (CellMax.X - 1) / BrickSize; ++BX)
+				{
+					if (!EmptyBricks[(BZ * NumBricks.Y + BY) * NumBricks.X + BX])
+					{
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+};
+
+//Everything marching needs from the actor, copied so meshing can run without it
+struct FVoxelMeshSettings
+{
+	float SurfaceLevel = -10.0f;
+	bool bInterpolation = true;
+	float VoxelSize = 20.f;
+	//Used for the UVs, the size of the source static mesh
+	float UVWidth = 1.f;
+	float UVHeight = 1.f;
+	bool bSharedVertices = false;
+	//Classifies whole voxel rows with SIMD compares before marching. Off gathers and compares the 8 corners of
+	//every cell, only kept to compare against (VoxelCore.Bench.Classify).
+	bool bRowClassification = true;
+	//Naive Surface Nets instead of marching cubes: one vertex per cell the surface crosses, at the average of its
+	//edge crossings, and a quad across every crossed voxel edge. Vertices are always shared.
+	bool bSurfaceNets = false;
+	//Largest distance in world units MeshJobs may move a surface when simplifying each job's mesh, 0 keeps every triangle
+	float SimplifyError = 0.f;
+	//Grid coordinate each axis really ends at when it is not a whole number of cells, as for a coarse LOD whose
+	//last cell is cut short by the end of the voxels. That cell's far corners sit here instead of a cell further
+	//on. 0 on an axis whose cells are all whole.
+	FVector CellEnd = FVector::ZeroVector;
+	//Winding, flipped when the surface level is negative
+	int TriangleOrder[3] = {0,1,2};
+};
+
+struct FEdgeVertexCache;
+
+//Marching cubes over a voxel view. Only reads its inputs, so any number of them can run at once.
+class VOXELCORE_API FVoxelMesher
+{
+public:
+	FVoxelMesher(const FVoxelMeshSettings& InSettings, const FVoxelGridView& InGrid)
+		: Settings(InSettings)
+		, Grid(InGrid)
+		, Level(InGrid.ToViewUnits(InSettings.SurfaceLevel))
+	{
+	}
+
+	//A block of cells to march and where to put the result
+	struct FJob
+	{
+		//Cell range, Max is exclusive
+		FIntVector CellMin;
+		FIntVector CellMax;
+		FVoxelMeshBuffers* Out = nullptr;
+	};
+
+	//Cuts every job into Z slabs, marches the slabs (on workers when bParallel) and stitches each job's slabs back
+	//together in order, so the result is the same with or without threads
+	void MeshJobs(TArrayView<const FJob> Jobs, bool bParallel) const;
+
+	//Marches the cells in [CellMin, CellMax), appending to Out
+	void MarchCells(const FIntVector& CellMin, const FIntVector& CellMax, FVoxelMeshBuffers& Out) const;
+
+	static constexpr int SlabDepth = 4;
+
+	//Cells below CellMin a job reads, the voxels copied for it have to start this far below
+	static int32 GetApron(const FVoxelMeshSettings& InSettings) { return InSettings.bSurfaceNets ? 1 : 0; }
+
+private:
+	//Sets one byte per voxel of plane Z in [CellMin, CellMax] to whether it is inside, a row at a time
+	void ClassifyPlane(const FIntVector& CellMin, const FIntVector& CellMax, int Z, TArray<uint8>& OutInside) const;
+	//The old path, gathers the corners of every cell and lets March compare them
+	void MarchCellsPerCell(const FIntVector& CellMin, const FIntVector& CellMax, FVoxelMeshBuffers& Out, FEdgeVertexCache* EdgeCache) const;
+	void March(int X, int Y, int Z, const float Cube[8], int VertexMask, FVoxelMeshBuffers& Out, FEdgeVertexCache* EdgeCache) const;
+	//Indexed output for March, reuses the vertex of every edge crossing already made by a neighbouring cell
+	void MarchShared(int X, int Y, int Z, int VertexMask, int EdgeMask, const FVector EdgeVertex[12], FVoxelMeshBuffers& Out, FEdgeVertexCache& EdgeCache) const;
+	//Surface Nets over [CellMin, CellMax), reading the cells one below CellMin as well
+	void SurfaceNetCells(const FIntVector& CellMin, const FIntVector& CellMax, FVoxelMeshBuffers& Out) const;
+	float GetInterpolationOffset(float V1, float V2) const;
+	//Length of a cell along an axis in grid units, only the last one can be short (Settings.CellEnd)
+	double GetCellLength(int Axis, int Cell) const;
+	//Where a point in grid coordinates ends up in the mesh, squeezing the short last cells
+	FVector GetVertexPosition(const FVector& GridPosition) const;
+
+	FVoxelMeshSettings Settings;
+	FVoxelGridView Grid;
+	//Settings.SurfaceLevel in the grid's units, what every voxel is compared against
+	float Level;
+};
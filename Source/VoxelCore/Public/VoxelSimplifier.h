@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVoxelMeshBuffers;
+
+//Quadric edge collapse (Garland & Heckbert) for marched chunks, mostly to merge the coplanar triangles of flat walls
+//and floors. An edge collapses into one of its ends, so no vertex ever moves.
+//Vertices on open edges, which is where a chunk meets its neighbours and the edge of the grid, are never removed,
+//so chunks simplified on their own still meet without cracks.
+class VOXELCORE_API FVoxelMeshSimplifier
+{
+public:
+	//Collapses edges while the sum of squared distances from every removed vertex's destination to the planes
+	//of the triangles it stood for stays under MaxError^2 (world units), so no plane moves further than MaxError.
+	//Per triangle meshes are welded for the collapses and split back into flat shaded triangles when bFlatNormals.
+	//Returns the number of triangles removed.
+	static int32 Simplify(FVoxelMeshBuffers& Mesh, float MaxError, bool bFlatNormals);
+
+private:
+	//Positions closer than this (world units) are welded
+	static constexpr double WeldTolerance = 0.001;
+};
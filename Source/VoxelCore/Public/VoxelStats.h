@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+//Per frame detail (uploads, cooks, nav refreshes) is Verbose, enable it with "Log LogVoxel Verbose".
+//Shipping builds compile out everything below Log so the formatting is never paid for.
+#if UE_BUILD_SHIPPING
+VOXELCORE_API DECLARE_LOG_CATEGORY_EXTERN(LogVoxel, Log, Log);
+#else
+VOXELCORE_API DECLARE_LOG_CATEGORY_EXTERN(LogVoxel, Log, All);
+#endif
+
+//"stat Voxel" in game, every cycle stat also shows up as a timing event in Insights
+DECLARE_STATS_GROUP(TEXT("Voxel"), STATGROUP_Voxel, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Voxelize"), STAT_VoxelVoxelize, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Carve"), STAT_VoxelCarve, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("March"), STAT_VoxelMarch, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Simplify"), STAT_VoxelSimplify, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mesh Upload"), STAT_VoxelMeshUpload, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision Cook"), STAT_VoxelCollisionCook, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Nav Dirty"), STAT_VoxelNavDirty, STATGROUP_Voxel, VOXELCORE_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Voxels Touched"), STAT_VoxelVoxelsTouched, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cells Marched"), STAT_VoxelCellsMarched, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Triangles Emitted"), STAT_VoxelTrianglesEmitted, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Triangles Simplified Away"), STAT_VoxelTrianglesSimplified, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Edits Applied"), STAT_VoxelEditsApplied, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Edit Queue Depth"), STAT_VoxelEditQueueDepth, STATGROUP_Voxel, VOXELCORE_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Last Edit Latency (ms)"), STAT_VoxelEditLatency, STATGROUP_Voxel, VOXELCORE_API);
+
+//Time from the input behind an edit to its mesh being on screen, in power of two millisecond buckets.
+//Game thread only. The game's "Voxel.EditLatency" command logs it, "Voxel.EditLatency reset" starts over.
+class VOXELCORE_API FVoxelLatencyHistogram
+{
+public:
+	//Bucket i holds latencies under 2^i ms, the last one everything above
+	static constexpr int32 NumBuckets = 10;
+
+	static FVoxelLatencyHistogram& GetEditLatency();
+
+	void Add(double Ms);
+	void Reset();
+	void Log() const;
+	//Approximate, the upper bound of the bucket the percentile falls in
+	double GetPercentile(double Percentile) const;
+
+private:
+	uint32 Buckets[NumBuckets] = {};
+	uint32 Count = 0;
+	double TotalMs = 0.0;
+	double MaxMs = 0.0;
+};
@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelBrush.h"
+
+//Inclusive range of voxel coordinates touched by an edit
+struct FVoxelRegion
+{
+	FIntVector Min = FIntVector(MAX_int32);
+	FIntVector Max = FIntVector(MIN_int32);
+
+	bool IsEmpty() const
+	{
+		return Min.X > Max.X || Min.Y > Max.Y || Min.Z > Max.Z;
+	}
+
+	void Add(int X, int Y, int Z)
+	{
+		Min = FIntVector(FMath::Min(Min.X, X), FMath::Min(Min.Y, Y), FMath::Min(Min.Z, Z));
+		Max = FIntVector(FMath::Max(Max.X, X), FMath::Max(Max.Y, Y), FMath::Max(Max.Z, Z));
+	}
+};
+
+//Lowest and highest value of a set of voxels
+struct FVoxelRange
+{
+	float Min = MAX_flt;
+	float Max = -MAX_flt;
+
+	void Add(float Value)
+	{
+		Min = FMath::Min(Min, Value);
+		Max = FMath::Max(Max, Value);
+	}
+
+	void Add(const FVoxelRange& Other)
+	{
+		Min = FMath::Min(Min, Other.Min);
+		Max = FMath::Max(Max, Other.Max);
+	}
+
+	//Whether there are voxels on both sides of Level
+	bool Crosses(float Level) const
+	{
+		return Min <= Level && Max > Level;
+	}
+};
+
+//Dense copy of a box of voxels, X rows first. A quantized store copies its int16 steps instead of floats.
+struct FVoxelBoxCopy
+{
+	TArray<float> Values;
+	TArray<int16> Steps;
+	//World units per step, 0 when the copy is floats
+	float Quantum = 0.f;
+
+	bool IsEmpty() const { return Values.IsEmpty() && Steps.IsEmpty(); }
+	void Empty()
+	{
+		Values.Empty();
+		Steps.Empty();
+	}
+};
+
+//Voxel grid stored as bricks of BrickSize^3 voxels.
+//A brick that is entirely on one side of the surface, along with the voxels right around it, is kept as a
+//single value. No cell touching it can make a triangle, so the exact distances there never matter.
+//Writing a different value into such a brick, or a value on the other side of the surface right next to it,
+//expands it back to one float per voxel.
+//Every brick also keeps the value range of the cells whose lowest corner is in it, and every SuperSize^3 bricks
+//the range of those, so meshing and edits can pass over whole regions without reading a voxel.
+//A quantized store keeps its expanded bricks as int16 steps of a fixed quantum instead of floats. Every value
+//going in is rounded to a step, so what is read back is always exactly what the ranges were built from.
+class VOXELCORE_API FVoxelStore
+{
+public:
+	static constexpr int32 BrickSize = 8;
+	//Bricks along each axis of a super brick
+	static constexpr int32 SuperSize = 4;
+	//Steps per voxel of distance for SetQuantum, +-128 voxels fit in an int16
+	static constexpr int32 StepsPerVoxel = 256;
+
+	//Every voxel set to Value
+	void Init(const FIntVector& InDims, float Value, float InSurfaceLevel);
+	//Takes dense voxels, X rows first, and collapses every brick that doesn't touch SurfaceLevel
+	void FromDense(const FIntVector& InDims, TArrayView<const float> Dense, float InSurfaceLevel);
+	void ToDense(TArray<float>& Out) const;
+
+	bool IsEmpty() const { return Bricks.IsEmpty(); }
+	//Voxels along each axis
+	const FIntVector& GetDims() const { return Dims; }
+	int32 Num() const { return Dims.X * Dims.Y * Dims.Z; }
+
+	float Get(int X, int Y, int Z) const
+	{
+		const FBrick& Brick = Bricks[GetBrickIndex(X / BrickSize, Y / BrickSize, Z / BrickSize)];
+		if (!Brick.Steps.IsEmpty())
+		{
+			return Brick.Steps[GetLocalIndex(X, Y, Z)] * Quantum;
+		}
+		return Brick.Values.IsEmpty() ? Brick.Value : Brick.Values[GetLocalIndex(X, Y, Z)];
+	}
+	void Set(int X, int Y, int Z, float Value);
+
+	//Keeps expanded bricks as int16 steps of InQuantum world units from now on, 0 goes back to floats.
+	//Every voxel is rounded to the nearest step and clamped to the int16 range. Cheapest before FromDense,
+	//a store that already has voxels is rebuilt.
+	void SetQuantum(float InQuantum);
+	float GetQuantum() const { return Quantum; }
+	bool IsQuantized() const { return Quantum > 0.f; }
+
+	//Copies the voxels in the inclusive range, X rows first
+	void CopyBox(const FIntVector& Min, const FIntVector& Max, TArray<float>& Out) const;
+	//Copies the voxels in the inclusive range for meshing, as steps when the store is quantized
+	void CopyBox(const FIntVector& Min, const FIntVector& Max, FVoxelBoxCopy& Out) const;
+	//Collapses the dense bricks in the inclusive brick range that no longer touch the surface
+	void Compact(const FIntVector& BrickMin, const FIntVector& BrickMax);
+
+	//Combines the brush into every voxel in its bounds and compacts around it. Returns the voxels that changed.
+	//HitStatus, when given, is flagged for the ones a subtractive brush changed. Bricks and super bricks whose
+	//value range the brush can't reach are skipped.
+	FVoxelRegion ApplyBrush(const FVoxelBrush& Brush, TBitArray<>* HitStatus = nullptr);
+	//Clamps every voxel closer than Radius to Center (both in voxels) to at most HoleValue, a Carve sphere brush
+	FVoxelRegion CarveSphere(const FVector& Center, float Radius, float HoleValue, TBitArray<>* HitStatus = nullptr);
+
+	//Brick contents for snapshots, OutValues is left empty for a uniform brick
+	void GetBrick(int32 BrickIndex, float& OutValue, TArray<float>& OutValues) const;
+	//Values is either empty or BrickSize^3 long
+	void SetBrick(int32 BrickIndex, float Value, TArrayView<const float> Values);
+	//Adds every brick an edit of Region may have changed, the ones it covers and the neighbours ApplyBrush compacts
+	void CollectBricks(const FVoxelRegion& Region, TSet<int32>& Out) const;
+	int32 GetBrickIndex(int BX, int BY, int BZ) const
+	{
+		return (BZ * NumBricks.Y + BY) * NumBricks.X + BX;
+	}
+
+	//One byte per brick, set where the brick is a single value
+	const TArray<uint8>& GetUniformMask() const { return UniformMask; }
+	//One byte per brick, set where no cell with its lowest corner in the brick has a surface
+	const TArray<uint8>& GetEmptyMask() const { return EmptyMask; }
+	const FIntVector& GetNumBricks() const { return NumBricks; }
+	//Whether any cell with its lowest corner in the inclusive voxel range can have a surface
+	bool MayContainSurface(const FIntVector& Min, const FIntVector& Max) const;
+
+	int32 NumDenseBricks() const;
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FBrick
+	{
+		//Used while the brick isn't expanded
+		float Value = 0.f;
+		//The expanded voxels, Steps in a quantized store and Values otherwise
+		TArray<float> Values;
+		TArray<int16> Steps;
+
+		bool IsExpanded() const { return !Values.IsEmpty() || !Steps.IsEmpty(); }
+	};
+
+	int16 ToSteps(float Value) const
+	{
+		return int16(FMath::Clamp(FMath::RoundToInt(Value / Quantum), -MAX_int16, MAX_int16));
+	}
+	//The value as the store will keep it
+	float Quantize(float Value) const
+	{
+		return IsQuantized() ? ToSteps(Value) * Quantum : Value;
+	}
+
+	static int32 GetLocalIndex(int X, int Y, int Z)
+	{
+		return ((Z % BrickSize) * BrickSize + (Y % BrickSize)) * BrickSize + (X % BrickSize);
+	}
+	//Whether the brick and a one voxel border around it are all on the same side of SurfaceLevel
+	template<typename GetterType>
+	bool IsBrickUniform(int BX, int BY, int BZ, GetterType&& GetVoxel) const;
+	void Collapse(int32 BrickIndex);
+	void Expand(int32 BrickIndex);
+
+	//Range of the brick's voxels and the one voxel border above it on each axis, the corners of its cells
+	FVoxelRange ComputeBrickRange(int BX, int BY, int BZ) const;
+	//Recomputes the bricks in the inclusive brick range exactly, along with the super bricks above them
+	void UpdateRanges(const FIntVector& BrickMin, const FIntVector& BrickMax);
+	//Widens the ranges that see voxel X, Y, Z to include Value
+	void WidenRanges(int X, int Y, int Z, float Value);
+	int32 GetSuperIndex(int BX, int BY, int BZ) const
+	{
+		return ((BZ / SuperSize) * NumSupers.Y + BY / SuperSize) * NumSupers.X + BX / SuperSize;
+	}
+
+	FIntVector Dims = FIntVector::ZeroValue;
+	FIntVector NumBricks = FIntVector::ZeroValue;
+	float SurfaceLevel = 0.f;
+	float Quantum = 0.f;
+	TArray<FBrick> Bricks;
+	TArray<uint8> UniformMask;
+
+	FIntVector NumSupers = FIntVector::ZeroValue;
+	TArray<FVoxelRange> BrickRanges;
+	TArray<FVoxelRange> SuperRanges;
+	TArray<uint8> EmptyMask;
+};
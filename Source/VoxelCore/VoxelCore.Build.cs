@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+//Voxel storage, marching cubes, mesh signed distances and the voxel file formats.
+//Only depends on Core so it can be profiled and exercised without UObjects or a world.
+public class VoxelCore : ModuleRules
+{
+	public VoxelCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}